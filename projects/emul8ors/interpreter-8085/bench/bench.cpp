@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+
+#include "block_cache.hpp"
+#include "execution_unit.hpp"
+#include "instruction_set.hpp"
+#include "memory_inspector.hpp"
+#include "processor.hpp"
+#include "processor_state.hpp"
+#include "program_loader.hpp"
+#include "system_memory.hpp"
+
+// Benchmarks of the loader, the decoder and the execution cores.
+// Micro-benchmarks time one operation in a tight loop and report ns per operation, macro-benchmarks run synthetic
+// workloads to completion in every dispatch mode and report emulated MIPS. Everything is written to a JSON file
+// so that the results of two builds can be compared by a script.
+//
+// i8085_bench [results file] [minimum seconds per micro-benchmark]
+
+namespace {
+
+// Stores are never optimised away, anything feeding one has to be computed
+volatile std::uint64_t sink = 0;
+
+template <typename Value>
+auto Keep(const Value value) noexcept -> void
+{
+    sink = static_cast<std::uint64_t>(value);
+}
+
+// Discards whatever is written to it, the formatting still happens
+class NullBuffer : public std::streambuf {
+protected:
+    auto overflow(const int c) -> int override { return c; }
+    auto xsputn(const char * /*s*/, const std::streamsize count) -> std::streamsize override { return count; }
+};
+
+struct MicroResult {
+    std::string   name;
+    std::uint64_t operations     = 0; // In the fastest sample
+    double        nsPerOperation = 0.0;
+};
+
+struct OpcodeResult {
+    std::uint8_t opcode           = 0x00;
+    double       nsPerInstruction = 0.0;
+};
+
+struct MacroResult {
+    std::string   workload;
+    std::string   dispatchMode;
+    std::uint64_t instructions     = 0;
+    std::uint64_t cycles           = 0;
+    double        seconds          = 0.0; // Fastest run
+    double        mips             = 0.0;
+    double        nsPerInstruction = 0.0;
+};
+
+template <typename Function>
+auto Seconds(Function function) -> double
+{
+    const auto                          start   = std::chrono::steady_clock::now();
+    function();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Calls function, which performs operationsPerCall operations, in batches doubled until one takes a fifth of
+// minSeconds, then reports the fastest of five batches of that size
+template <typename Function>
+auto Measure(std::string name, const double minSeconds, const std::uint64_t operationsPerCall, Function function)
+    -> MicroResult
+{
+    constexpr int samples = 5;
+    const auto    batch   = [&](const std::uint64_t calls) {
+        return Seconds([&] {
+            for (std::uint64_t call = 0; call < calls; call++) {
+                function();
+            }
+        });
+    };
+    std::uint64_t calls = 1;
+    while (batch(calls) < minSeconds / samples && calls < (std::uint64_t { 1 } << 40)) {
+        calls *= 2;
+    }
+    double best = std::numeric_limits<double>::max();
+    for (int sample = 0; sample < samples; sample++) {
+        best = std::min(best, batch(calls));
+    }
+    const std::uint64_t operations = calls * operationsPerCall;
+    return { std::move(name), operations, best * 1e9 / static_cast<double>(operations) };
+}
+
+// Writes a program in the .program syntax, keeping track of addresses so that branches can target them
+class ProgramWriter {
+public: // Functions/Methods
+    explicit ProgramWriter(const std::uint16_t codeAddress) : address_(codeAddress)
+    {
+        // The loader wants a data section in the data range even when there is no data
+        Data(0x8000, {});
+        code_ = fmt::format("code_begin\n{:#06x}\n", codeAddress);
+    }
+
+    auto Data(const std::uint16_t address, const std::span<const std::uint8_t> bytes) -> void
+    {
+        data_ = fmt::format("data_begin\n{:#06x}\n{:#06x}\n", address, bytes.size());
+        for (const std::uint8_t byte : bytes) {
+            data_ += fmt::format("{:#04x}\n", byte);
+        }
+        data_ += "data_end\n";
+    }
+
+    [[nodiscard]] auto Here() const noexcept -> std::uint16_t { return address_; }
+
+    auto Emit(const std::string_view mnemonic) -> void { Append(mnemonic, ""); }
+
+    auto EmitByte(const std::string_view mnemonic, const std::uint8_t operand) -> void
+    {
+        Append(mnemonic, fmt::format(",{:#04x}", operand));
+    }
+
+    // Word operands are written low byte first, as they are encoded
+    auto EmitWord(const std::string_view mnemonic, const std::uint16_t operand) -> void
+    {
+        Append(mnemonic, fmt::format(",{:#04x},{:#04x}", operand & 0xFF, operand >> 8));
+    }
+
+    // The program ends with the HLT the syntax requires
+    [[nodiscard]] auto Finish() -> std::string
+    {
+        Emit("HLT");
+        return data_ + code_ + "code_end\n";
+    }
+
+private: // Functions/Methods
+    auto Append(const std::string_view mnemonic, const std::string &operands) -> void
+    {
+        code_ += fmt::format("{}{}\n", mnemonic, operands);
+        address_ = static_cast<std::uint16_t>(
+            address_ + Length(intel_8085::FindOpcode(mnemonic).value_or(intel_8085::opcodes::NOP)));
+    }
+
+    [[nodiscard]] static auto Length(const intel_8085::opcodes opcode) noexcept -> std::uint8_t
+    {
+        return intel_8085::instructionLength[static_cast<std::uint8_t>(opcode)];
+    }
+
+public:  // Data Members
+private: // Data Members
+    std::uint16_t address_;
+    std::string   data_;
+    std::string   code_;
+};
+
+struct Workload {
+    std::string                                             name;
+    std::string                                             text;
+    std::function<bool(const intel_8085::ProcessorState &)> validate;
+};
+
+// Nested DCR/JNZ delay loops, the bread and butter of 8085 timing code
+auto DelayWorkload() -> Workload
+{
+    ProgramWriter writer(0x1000);
+    writer.EmitByte("MVI_D", 0x40);
+    const std::uint16_t outer = writer.Here();
+    writer.EmitByte("MVI_B", 0xFF);
+    const std::uint16_t middle = writer.Here();
+    writer.EmitByte("MVI_C", 0xFF);
+    const std::uint16_t inner = writer.Here();
+    writer.Emit("DCR_C");
+    writer.EmitWord("JNZ", inner);
+    writer.Emit("DCR_B");
+    writer.EmitWord("JNZ", middle);
+    writer.Emit("DCR_D");
+    writer.EmitWord("JNZ", outer);
+    return { "delay_loop", writer.Finish(), [](const intel_8085::ProcessorState &state) {
+                const auto &r = state.registers;
+                return state.halted && r.Get(intel_8085::RegisterFile::b) == 0
+                    && r.Get(intel_8085::RegisterFile::c) == 0 && r.Get(intel_8085::RegisterFile::d) == 0;
+            } };
+}
+
+// Copies a 4 KiB block byte by byte, 64 times over
+auto MemcpyWorkload() -> Workload
+{
+    constexpr std::uint16_t counter = 0x8000;
+    constexpr std::uint16_t source  = 0x8001;
+    constexpr std::uint16_t target  = 0xA000;
+    constexpr std::uint16_t size    = 0x1000;
+
+    std::vector<std::uint8_t> data(1 + size);
+    data[0] = 64;
+    for (std::size_t index = 1; index < data.size(); index++) {
+        data[index] = static_cast<std::uint8_t>(index * 7 + (index >> 8));
+    }
+    ProgramWriter writer(0x1000);
+    writer.Data(counter, data);
+    const std::uint16_t outer = writer.Here();
+    writer.EmitWord("LXI_H", source);
+    writer.EmitWord("LXI_D", target);
+    writer.EmitWord("LXI_B", size);
+    const std::uint16_t inner = writer.Here();
+    writer.Emit("MOV_A_M");
+    writer.Emit("STAX_D");
+    writer.Emit("INX_H");
+    writer.Emit("INX_D");
+    writer.Emit("DCX_B");
+    writer.Emit("MOV_A_B");
+    writer.Emit("ORA_C");
+    writer.EmitWord("JNZ", inner);
+    writer.EmitWord("LDA", counter);
+    writer.Emit("DCR_A");
+    writer.EmitWord("STA", counter);
+    writer.EmitWord("JNZ", outer);
+    return { "memcpy", writer.Finish(), [](const intel_8085::ProcessorState &state) {
+                for (std::uint16_t index = 0; index < size; index++) {
+                    if (state.memory.Read(static_cast<std::uint16_t>(target + index))
+                        != state.memory.Read(static_cast<std::uint16_t>(source + index))) {
+                        return false;
+                    }
+                }
+                return state.halted;
+            } };
+}
+
+// Adds a 16 digit packed BCD number into an accumulator with ADC/DAA, 255 * 100 times
+auto BcdWorkload() -> Workload
+{
+    constexpr std::uint16_t counter     = 0x8000;
+    constexpr std::uint16_t accumulator = 0x8010;
+    constexpr std::uint16_t addend      = 0x8020;
+    constexpr std::uint8_t  digitPairs  = 8;
+    constexpr std::uint64_t repeats     = 255 * 100;
+    // Little endian BCD of 1234567890123457
+    constexpr std::array<std::uint8_t, digitPairs> addendBytes = { 0x57, 0x34, 0x12, 0x90, 0x78, 0x56, 0x34, 0x12 };
+
+    std::vector<std::uint8_t> data(addend + digitPairs - counter);
+    data[0] = 100;
+    std::copy(addendBytes.begin(), addendBytes.end(), data.begin() + (addend - counter));
+    ProgramWriter writer(0x1000);
+    writer.Data(counter, data);
+    writer.EmitByte("MVI_C", 0xFF);
+    const std::uint16_t outer = writer.Here();
+    writer.EmitWord("LXI_H", accumulator);
+    writer.EmitWord("LXI_D", addend);
+    writer.EmitByte("MVI_B", digitPairs);
+    writer.Emit("ORA_A");
+    const std::uint16_t inner = writer.Here();
+    writer.Emit("LDAX_D");
+    writer.Emit("ADC_M");
+    writer.Emit("DAA");
+    writer.Emit("MOV_M_A");
+    writer.Emit("INX_H");
+    writer.Emit("INX_D");
+    writer.Emit("DCR_B");
+    writer.EmitWord("JNZ", inner);
+    writer.Emit("DCR_C");
+    writer.EmitWord("JNZ", outer);
+    writer.EmitByte("MVI_C", 0xFF);
+    writer.EmitWord("LDA", counter);
+    writer.Emit("DCR_A");
+    writer.EmitWord("STA", counter);
+    writer.EmitWord("JNZ", outer);
+
+    // 1234567890123457 * 25500 modulo 10^16, in BCD, multiplied by doubling so as not to overflow
+    constexpr std::uint64_t modulus = 10000000000000000ULL;
+    constexpr std::uint64_t term    = 1234567890123457ULL;
+    std::uint64_t           value   = 0;
+    for (std::uint64_t bit = std::uint64_t { 1 } << 15; bit != 0; bit >>= 1) {
+        value = value * 2 % modulus;
+        if (repeats & bit) {
+            value = (value + term) % modulus;
+        }
+    }
+    std::array<std::uint8_t, digitPairs> expected {};
+    for (std::uint8_t &pair : expected) {
+        pair = static_cast<std::uint8_t>(value % 10 | (value / 10 % 10) << 4);
+        value /= 100;
+    }
+    return { "bcd_add", writer.Finish(), [expected](const intel_8085::ProcessorState &state) {
+                for (std::uint8_t index = 0; index < digitPairs; index++) {
+                    if (state.memory.Read(static_cast<std::uint16_t>(accumulator + index)) != expected[index]) {
+                        return false;
+                    }
+                }
+                return state.halted;
+            } };
+}
+
+// Bubble sorts a fresh copy of 200 bytes, 20 times over
+auto SortWorkload() -> Workload
+{
+    constexpr std::uint16_t counter = 0x8000;
+    constexpr std::uint16_t source  = 0x8001;
+    constexpr std::uint16_t work    = 0x9000;
+    constexpr std::uint8_t  size    = 200;
+
+    std::vector<std::uint8_t> data(1 + size);
+    data[0]            = 20;
+    std::uint32_t seed = 0x8085;
+    for (std::size_t index = 1; index < data.size(); index++) {
+        seed        = seed * 1103515245 + 12345;
+        data[index] = static_cast<std::uint8_t>(seed >> 16);
+    }
+    ProgramWriter writer(0x1000);
+    writer.Data(counter, data);
+    const std::uint16_t outer = writer.Here();
+    writer.EmitWord("LXI_H", source);
+    writer.EmitWord("LXI_D", work);
+    writer.EmitByte("MVI_B", size);
+    const std::uint16_t copy = writer.Here();
+    writer.Emit("MOV_A_M");
+    writer.Emit("STAX_D");
+    writer.Emit("INX_H");
+    writer.Emit("INX_D");
+    writer.Emit("DCR_B");
+    writer.EmitWord("JNZ", copy);
+    writer.EmitByte("MVI_B", size - 1);
+    const std::uint16_t pass = writer.Here();
+    writer.EmitWord("LXI_H", work);
+    writer.Emit("MOV_C_B");
+    const std::uint16_t compare = writer.Here();
+    writer.Emit("MOV_A_M");
+    writer.Emit("INX_H");
+    writer.Emit("CMP_M");
+    // Past the two branches and the 5 byte swap
+    const auto skip = static_cast<std::uint16_t>(writer.Here() + 3 + 3 + 5);
+    writer.EmitWord("JC", skip);
+    writer.EmitWord("JZ", skip);
+    writer.Emit("MOV_D_M");
+    writer.Emit("MOV_M_A");
+    writer.Emit("DCX_H");
+    writer.Emit("MOV_M_D");
+    writer.Emit("INX_H");
+    writer.Emit("DCR_C");
+    writer.EmitWord("JNZ", compare);
+    writer.Emit("DCR_B");
+    writer.EmitWord("JNZ", pass);
+    writer.EmitWord("LDA", counter);
+    writer.Emit("DCR_A");
+    writer.EmitWord("STA", counter);
+    writer.EmitWord("JNZ", outer);
+    return { "bubble_sort", writer.Finish(), [](const intel_8085::ProcessorState &state) {
+                for (std::uint16_t index = 1; index < size; index++) {
+                    if (state.memory.Read(static_cast<std::uint16_t>(work + index - 1))
+                        > state.memory.Read(static_cast<std::uint16_t>(work + index))) {
+                        return false;
+                    }
+                }
+                return state.halted;
+            } };
+}
+
+// A long program of assorted instructions for the loader, it is only parsed and never run
+auto LoaderProgram() -> std::string
+{
+    constexpr std::array<std::string_view, 8> implied   = { "MOV_A_B", "ADD_C", "INX_H", "DCR_D",
+        "XRA_A", "RAL", "PUSH_B", "CMP_M" };
+    constexpr std::array<std::string_view, 4> immediate = { "MVI_B", "ADI", "CPI", "ORI" };
+    constexpr std::array<std::string_view, 4> address   = { "LXI_H", "STA", "JNZ", "CALL" };
+
+    std::vector<std::uint8_t> data(0x400);
+    for (std::size_t index = 0; index < data.size(); index++) {
+        data[index] = static_cast<std::uint8_t>(index);
+    }
+    ProgramWriter writer(0x1000);
+    writer.Data(0x8000, data);
+    for (std::size_t index = 0; index < 8000; index++) {
+        switch (index % 3) {
+        case 0:
+            writer.Emit(implied[index % implied.size()]);
+            break;
+        case 1:
+            writer.EmitByte(immediate[index % immediate.size()], static_cast<std::uint8_t>(index));
+            break;
+        default:
+            writer.EmitWord(address[index % address.size()], static_cast<std::uint16_t>(0x1000 + index));
+            break;
+        }
+    }
+    return writer.Finish();
+}
+
+[[nodiscard]] auto WriteFile(const std::filesystem::path &filename, const std::string &text) -> bool
+{
+    std::ofstream file(filename, std::ios::trunc);
+    file << text;
+    if (!file) {
+        spdlog::error("Could not write {}", filename.string());
+        return false;
+    }
+    return true;
+}
+
+auto RunMicroBenchmarks(const std::filesystem::path &directory, const double minSeconds)
+    -> std::vector<MicroResult>
+{
+    std::vector<MicroResult> results;
+
+    const std::filesystem::path loaderFile = directory / "loader.program";
+    if (WriteFile(loaderFile, LoaderProgram())) {
+        results.push_back(Measure("program_loader.load", minSeconds, 1, [&] {
+            intel_8085::SystemMemory memory;
+            std::uint16_t            entryPoint = 0x0000;
+            Keep(intel_8085::ProgramLoader::Load(memory, loaderFile.string(), entryPoint));
+        }));
+    }
+
+    results.push_back(Measure("mnemonic.find_opcode", minSeconds, intel_8085::mnemonics.size(), [] {
+        for (const auto &mnemonic : intel_8085::mnemonics) {
+            Keep(intel_8085::FindOpcode(mnemonic.name).value_or(intel_8085::opcodes::NOP));
+        }
+    }));
+
+    // Per byte dumped
+    {
+        intel_8085::SystemMemory memory;
+        for (std::uint32_t address = 0x8000; address < 0x9000; address++) {
+            memory.Write(static_cast<std::uint16_t>(address), static_cast<std::uint8_t>(address * 13));
+        }
+        NullBuffer   buffer;
+        std::ostream stream(&buffer);
+        results.push_back(Measure("system_memory.dump_memory_content", minSeconds, 0x1000,
+            [&] { memory.DumpMemoryContent(0x8000, 0x8FFF, stream); }));
+
+        intel_8085::MemoryExporter exporter;
+        results.push_back(Measure("memory_exporter.hex", minSeconds, 0x1000,
+            [&] { Keep(exporter.Write(stream, memory, { 0x8000, 0x8FFF }, intel_8085::ExportFormat::Hex)); }));
+        results.push_back(Measure("memory_exporter.intel_hex", minSeconds, 0x1000,
+            [&] { Keep(exporter.Write(stream, memory, { 0x8000, 0x8FFF }, intel_8085::ExportFormat::IntelHex)); }));
+    }
+
+    // Per byte compared, two images loaded apart from each other so that no page is shared, differing in 3 places
+    {
+        intel_8085::SystemMemory left;
+        intel_8085::SystemMemory right;
+        for (std::uint32_t address = 0; address < 0x10000; address++) {
+            left.Write(static_cast<std::uint16_t>(address), static_cast<std::uint8_t>(address * 13));
+            right.Write(static_cast<std::uint16_t>(address), static_cast<std::uint8_t>(address * 13));
+        }
+        constexpr std::array<std::uint16_t, 3> changed = { 0x0100, 0x8000, 0x8001 };
+        for (const std::uint16_t address : changed) {
+            right.Write(address, 0xFF);
+        }
+        std::vector<intel_8085::MemoryRange> ranges;
+        results.push_back(Measure("memory_inspector.diff", minSeconds, 0x10000, [&] {
+            intel_8085::MemoryInspector::Diff(left, right, ranges);
+            Keep(ranges.size());
+        }));
+    }
+
+    // Per instruction decoded, 16 KiB of straight-line code broken into blocks by a JMP every 16 instructions
+    {
+        intel_8085::ProcessorState state;
+        std::uint32_t              seed         = 0x8085;
+        std::uint16_t              address      = 0x1000;
+        std::uint64_t              instructions = 0;
+        while (address < 0x5000) {
+            if (instructions % 16 == 15) {
+                const auto next = static_cast<std::uint16_t>(address + 3);
+                state.memory.Write(address++, static_cast<std::uint8_t>(intel_8085::opcodes::JMP));
+                state.memory.Write(address++, static_cast<std::uint8_t>(next));
+                state.memory.Write(address++, static_cast<std::uint8_t>(next >> 8));
+            } else {
+                // MOV, ALU and the like, all single byte, but never HLT
+                seed                = seed * 1103515245 + 12345;
+                const auto opcode   = static_cast<std::uint8_t>(0x40 + (seed >> 16) % 0x80);
+                const auto replaced = opcode == static_cast<std::uint8_t>(intel_8085::opcodes::HLT);
+                state.memory.Write(address++, replaced ? std::uint8_t { 0x00 } : opcode);
+            }
+            instructions++;
+        }
+        const std::uint16_t           end = address;
+        intel_8085::BlockCache        cache;
+        intel_8085::BlockCache::HandlerTable handlers {};
+        for (std::uint32_t opcode = 0; opcode < handlers.size(); opcode++) {
+            handlers[opcode] = intel_8085::ExecutionUnit::GetHandler(static_cast<std::uint8_t>(opcode));
+        }
+        const auto superinstructions = intel_8085::ExecutionUnit::GetSuperinstructions();
+        results.push_back(Measure("block_cache.decode", minSeconds, instructions, [&] {
+            cache.Flush(state.memory);
+            for (std::uint16_t pc = 0x1000; pc < end;) {
+                state.registers.SetPc(pc);
+                pc = static_cast<std::uint16_t>(cache.Lookup(state, handlers, superinstructions).endAddress + 1);
+            }
+        }));
+    }
+    return results;
+}
+
+// Cost of a single instruction stepped through the handler table, including resetting PC and SP around it.
+// Operands point at 0x2000, so memory accesses and branches stay clear of the instruction itself.
+auto RunOpcodeBenchmarks(const double minSeconds) -> std::vector<OpcodeResult>
+{
+    std::vector<OpcodeResult> results;
+    for (std::uint32_t code = 0; code < 0x100; code++) {
+        const auto opcode = static_cast<std::uint8_t>(code);
+        if (!intel_8085::IsValidOpcode(opcode)) {
+            continue;
+        }
+        intel_8085::ProcessorState state;
+        state.memory.Write(0x1000, opcode);
+        state.memory.Write(0x1001, 0x00);
+        state.memory.Write(0x1002, 0x20);
+        state.registers.SetPair<0b10>(0x2000);
+        const MicroResult result = Measure(std::string(intel_8085::instructionMnemonic[opcode]), minSeconds, 1, [&] {
+            state.registers.SetPc(0x1000);
+            state.registers.SetSp(0xF000);
+            intel_8085::ExecutionUnit::Step(state);
+        });
+        Keep(state.cycles);
+        results.push_back({ opcode, result.nsPerOperation });
+    }
+    return results;
+}
+
+auto RunMacroBenchmarks(const std::filesystem::path &directory, const int runs) -> std::vector<MacroResult>
+{
+    std::vector<MacroResult> results;
+    for (const Workload &workload : { DelayWorkload(), MemcpyWorkload(), BcdWorkload(), SortWorkload() }) {
+        const std::filesystem::path filename = directory / (workload.name + ".program");
+        intel_8085::Processor       loader;
+        if (!WriteFile(filename, workload.text) || !loader.LoadProgram(filename.string())) {
+            spdlog::error("Could not load the {} workload", workload.name);
+            continue;
+        }
+        for (const std::string_view name : { "table", "switch", "threaded", "cached", "jit" }) {
+            const auto dispatchMode = intel_8085::ParseDispatchMode(name);
+            if (!dispatchMode.has_value()) {
+                continue; // Not built into this binary
+            }
+            MacroResult result { workload.name, std::string(name), 0, 0, std::numeric_limits<double>::max(), 0.0,
+                0.0 };
+            for (int run = 0; run < runs; run++) {
+                // A fresh processor every run, so that decoding and translating the code is part of the cost
+                intel_8085::Processor processor(loader.GetState());
+                processor.SetDispatchMode(dispatchMode.value());
+                result.seconds = std::min(result.seconds, Seconds([&] { result.instructions = processor.Run(); }));
+                result.cycles  = processor.GetCycles() - loader.GetCycles();
+                if (!workload.validate(processor.GetState())) {
+                    spdlog::error("The {} workload computed a wrong result in {} mode", workload.name, name);
+                    return {};
+                }
+            }
+            result.mips             = static_cast<double>(result.instructions) / result.seconds / 1e6;
+            result.nsPerInstruction = result.seconds * 1e9 / static_cast<double>(result.instructions);
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+auto WriteJson(std::ostream &outStream, const std::vector<MicroResult> &micro,
+    const std::vector<OpcodeResult> &opcodeResults, const std::vector<MacroResult> &macro) -> void
+{
+    outStream << "{\n  \"schema\": 1,\n";
+    outStream << fmt::format("  \"timestamp\": {},\n", std::time(nullptr));
+    outStream << fmt::format("  \"build\": {{ \"computed_goto\": {}, \"jit\": {} }},\n",
+        static_cast<bool>(INTERPRETER_8085_HAS_COMPUTED_GOTO), static_cast<bool>(INTERPRETER_8085_HAS_JIT));
+
+    outStream << "  \"micro\": [\n";
+    for (std::size_t index = 0; index < micro.size(); index++) {
+        outStream << fmt::format("    {{ \"name\": \"{}\", \"operations\": {}, \"ns_per_op\": {:.3f} }}{}\n",
+            micro[index].name, micro[index].operations, micro[index].nsPerOperation,
+            index + 1 < micro.size() ? "," : "");
+    }
+    outStream << "  ],\n  \"opcodes\": [\n";
+    for (std::size_t index = 0; index < opcodeResults.size(); index++) {
+        const OpcodeResult &result = opcodeResults[index];
+        outStream << fmt::format(
+            "    {{ \"opcode\": {}, \"mnemonic\": \"{}\", \"cycles\": {}, \"ns_per_instruction\": {:.3f} }}{}\n",
+            result.opcode, intel_8085::instructionMnemonic[result.opcode],
+            intel_8085::instructionCycles[result.opcode], result.nsPerInstruction,
+            index + 1 < opcodeResults.size() ? "," : "");
+    }
+    outStream << "  ],\n  \"macro\": [\n";
+    for (std::size_t index = 0; index < macro.size(); index++) {
+        const MacroResult &result = macro[index];
+        outStream << fmt::format("    {{ \"workload\": \"{}\", \"dispatch_mode\": \"{}\", \"instructions\": {}, "
+                                 "\"cycles\": {}, \"seconds\": {:.6f}, \"mips\": {:.3f}, "
+                                 "\"ns_per_instruction\": {:.3f} }}{}\n",
+            result.workload, result.dispatchMode, result.instructions, result.cycles, result.seconds, result.mips,
+            result.nsPerInstruction, index + 1 < macro.size() ? "," : "");
+    }
+    outStream << "  ]\n}\n";
+}
+
+[[nodiscard]] auto ParseSeconds(const std::string_view argument, double &seconds) -> bool
+{
+    try {
+        std::size_t used = 0;
+        seconds          = std::stod(std::string(argument), &used);
+        if (used == argument.size() && seconds > 0.0) {
+            return true;
+        }
+    } catch (const std::exception &) {
+    }
+    spdlog::error("Expected a positive number of seconds and received {}", argument);
+    return false;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int
+{
+    if (argc > 3) {
+        spdlog::error("Usage: {} [results file] [minimum seconds per micro-benchmark]", argv[0]);
+        return 1;
+    }
+    const std::string resultsFile = argc > 1 ? argv[1] : "bench.json";
+    double            minSeconds  = 0.2;
+    if (argc > 2 && !ParseSeconds(argv[2], minSeconds)) {
+        return 1;
+    }
+
+    // The loader logs every program it parses
+    spdlog::set_level(spdlog::level::warn);
+    std::error_code             error;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "i8085_bench";
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        spdlog::error("Could not create {}: {}", directory.string(), error.message());
+        return 1;
+    }
+
+    const auto micro = RunMicroBenchmarks(directory, minSeconds);
+    fmt::print("{:<36} {:>14}\n", "Micro-benchmark", "ns/op");
+    for (const MicroResult &result : micro) {
+        fmt::print("{:<36} {:>14.3f}\n", result.name, result.nsPerOperation);
+    }
+
+    const auto opcodeResults = RunOpcodeBenchmarks(minSeconds / 10);
+    const auto slowest       = std::max_element(opcodeResults.begin(), opcodeResults.end(),
+        [](const OpcodeResult &left, const OpcodeResult &right) {
+            return left.nsPerInstruction < right.nsPerInstruction;
+        });
+    double     total         = 0.0;
+    for (const OpcodeResult &result : opcodeResults) {
+        total += result.nsPerInstruction;
+    }
+    if (!opcodeResults.empty()) {
+        fmt::print("\nStepped {} opcodes: {:.3f} ns on average, slowest {} at {:.3f} ns\n", opcodeResults.size(),
+            total / static_cast<double>(opcodeResults.size()), intel_8085::instructionMnemonic[slowest->opcode],
+            slowest->nsPerInstruction);
+    }
+
+    const auto macro = RunMacroBenchmarks(directory, 3);
+    if (macro.empty()) {
+        return 1;
+    }
+    fmt::print("\n{:<14} {:<10} {:>12} {:>14} {:>10} {:>10}\n", "Workload", "Dispatch", "Instructions", "T-states",
+        "MIPS", "ns/instr");
+    for (const MacroResult &result : macro) {
+        fmt::print("{:<14} {:<10} {:>12} {:>14} {:>10.2f} {:>10.3f}\n", result.workload, result.dispatchMode,
+            result.instructions, result.cycles, result.mips, result.nsPerInstruction);
+    }
+
+    std::ofstream file(resultsFile, std::ios::trunc);
+    WriteJson(file, micro, opcodeResults, macro);
+    if (!file) {
+        spdlog::error("Could not write the results to {}", resultsFile);
+        return 1;
+    }
+    fmt::print("\nResults written to {}\n", resultsFile);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef INTERPRETER_8085_BATCH_RUNNER_HPP
+#define INTERPRETER_8085_BATCH_RUNNER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "processor.hpp"
+#include "program.hpp"
+#include "program_loader.hpp"
+#include "system_memory.hpp"
+#include "thread_pool.hpp"
+
+namespace intel_8085 {
+
+// A program run against one input, the input is written over the program's own data section.
+// The job starts from state instead of from the program being loaded into a fresh processor when state is set,
+// e.g. one restored from a save state.
+struct BatchJob {
+    std::shared_ptr<const Program>        program;
+    std::shared_ptr<const ProcessorState> state;
+    DataSection                           input;
+    std::uint64_t                         cycleBudget = std::numeric_limits<std::uint64_t>::max();
+};
+
+// Final state of a job
+struct BatchResult {
+    std::uint64_t               cycles       = 0;
+    std::uint64_t               instructions = 0;
+    std::uint64_t               memoryDigest = 0;
+    std::uint16_t               pc           = 0;
+    std::uint16_t               sp           = 0;
+    std::array<std::uint8_t, 7> registers    = {}; // B, C, D, E, H, L, A
+    std::uint8_t                flags        = 0;
+    bool                        loaded       = false; // The program failed verification if not set
+    bool                        halted       = false;
+};
+
+// Runs batches of jobs on all cores.
+// Every worker thread keeps its own Processor along with the memory image of the last program it loaded,
+// so consecutive jobs of the same program only restore memory, and blocks decoded (or compiled) for the
+// program survive from one job to the next.
+class BatchRunner {
+public: // Functions/Methods
+    explicit BatchRunner(const std::size_t threadCount = std::max(1U, std::thread::hardware_concurrency()),
+        const DispatchMode dispatchMode = defaultDispatchMode)
+        : pool_(threadCount)
+    {
+        for (std::size_t index = 0; index < pool_.GetThreadCount(); index++) {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->processor.SetDispatchMode(dispatchMode);
+        }
+    }
+
+    [[nodiscard]] auto Run(const std::vector<BatchJob> &jobs) -> std::vector<BatchResult>
+    {
+        // Copying a memory marks its pages as shared, mark them once here so that the workers only read the states
+        const ProcessorState *previous = nullptr;
+        for (const BatchJob &job : jobs) {
+            if (job.state != nullptr && job.state.get() != previous) {
+                previous = job.state.get();
+                previous->memory.Share();
+            }
+        }
+
+        std::vector<BatchResult> results(jobs.size());
+        pool_.ForEach(jobs.size(), [&](const std::size_t worker, const std::size_t job) {
+            results[job] = RunJob(*workers_[worker], jobs[job]);
+        });
+        return results;
+    }
+
+    [[nodiscard]] auto GetThreadCount() const noexcept -> std::size_t { return pool_.GetThreadCount(); }
+
+private: // Functions/Methods
+    struct Worker {
+        Processor      processor;
+        ProcessorState initial;
+        // Held on to, so that a new program can not show up at the address of the cached one
+        std::shared_ptr<const Program> program;
+    };
+
+    [[nodiscard]] static auto RunJob(Worker &worker, const BatchJob &job) noexcept -> BatchResult
+    {
+        BatchResult result;
+        if (job.state == nullptr && worker.program != job.program) {
+            worker.program = nullptr;
+            worker.initial = ProcessorState {};
+            if (job.program == nullptr || !ProgramLoader::LoadProgram(worker.initial.memory, *job.program)) {
+                return result;
+            }
+            worker.program = job.program;
+            worker.initial.registers.SetPc(job.program->codeSection.startingAddress);
+        }
+
+        Processor &processor = worker.processor;
+        processor.Reset(job.state != nullptr ? *job.state : worker.initial);
+        ProgramLoader::LoadDataSection(processor.GetMemory(), job.input);
+        result.instructions = processor.Run(job.cycleBudget);
+
+        const ProcessorState &state = processor.GetState();
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            result.registers[code] = state.registers.Get(code);
+        }
+        result.registers[6] = state.registers.GetAccumulator();
+        result.flags        = state.status.GetFlags();
+        result.pc           = state.registers.GetPc();
+        result.sp           = state.registers.GetSp();
+        result.cycles       = state.cycles;
+        result.memoryDigest = state.memory.Digest();
+        result.loaded       = true;
+        result.halted       = state.halted;
+        return result;
+    }
+
+public:  // Data Members
+private: // Data Members
+    ThreadPool                           pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace intel_8085
+
+#endif
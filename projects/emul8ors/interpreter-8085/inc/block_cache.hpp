@@ -0,0 +1,345 @@
+#ifndef INTERPRETER_8085_BLOCK_CACHE_HPP
+#define INTERPRETER_8085_BLOCK_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "instruction_set.hpp"
+#include "processor_state.hpp"
+#include "system_memory.hpp"
+
+namespace intel_8085 {
+
+// Handlers receive the state with the PC already advanced past the instruction,
+// along with the (up to) 2 bytes following the opcode
+using OpcodeHandler = auto (*)(ProcessorState &, std::uint16_t) noexcept -> void;
+
+// Block translated to host code by the JitCompiler
+struct JitContext;
+using NativeBlock = auto (*)(JitContext *) noexcept -> void;
+
+// An instruction with its handler and operands resolved at decode time, or several of them run by the handler of
+// a Superinstruction
+struct MicroOp {
+    OpcodeHandler handler      = nullptr;
+    std::uint16_t operand      = 0x0000;
+    std::uint16_t nextPc       = 0x0000;
+    std::uint8_t  opcode       = 0x00; // Of the first instruction
+    std::uint8_t  cycles       = 0;
+    std::uint8_t  instructions = 1;
+};
+
+// A sequence of straight-line instructions run by a single handler, which executes each of them in turn. At most one
+// of them may take operand bytes, which the handler receives, and only the last may write to memory or transfer
+// control, so that running them as one micro-op is indistinguishable from running them one by one.
+struct Superinstruction {
+    std::array<std::uint8_t, 3> opcodes = {};
+    std::uint8_t                length  = 0;
+    OpcodeHandler               handler = nullptr;
+};
+
+// Blocks which do nothing but count a register down to zero, jumping back to their own start until it gets there
+enum class DelayLoop : std::uint8_t {
+    None,
+    Decrement,     // DCR r / JNZ, counting down register r
+    PairDecrement, // DCX rp / MOV A,r / ORA r / JNZ, counting down register pair rp, A and ORA take its two halves
+};
+
+// A straight-line run of code, only the last micro-op may transfer control elsewhere
+struct DecodedBlock {
+    std::uint16_t        startAddress = 0x0000;
+    std::uint16_t        endAddress   = 0x0000; // Address of the last byte decoded
+    std::uint64_t        cycles       = 0;      // Sum of the micro-op cycles
+    std::vector<MicroOp> microOps     = {};
+    std::vector<MicroOp> fusedOps     = {};      // microOps with superinstructions fused, empty if none matched
+    std::uint32_t        executions   = 0;       // Counted only while the JIT is enabled
+    NativeBlock          native       = nullptr;
+    DelayLoop            delayLoop    = DelayLoop::None;
+    std::uint8_t         loopCounter  = 0; // Register code or register pair code counted down by a delay loop
+};
+
+// Caches decoded blocks by their starting address.
+// Every page holding a decoded block is marked as a Code page in SystemMemory, a write into such a page
+// sets its bit in the dirty page bitmap and Invalidate() drops every block overlapping the dirty pages.
+// Blocks end before any address holding a breakpoint, so that breakpoints only ever sit at the start of a block.
+// Code on device pages is never cached, as a device may change it without a write going through memory. Blocks end
+// before it and callers run it an instruction at a time, see IsCacheable().
+// Decoding also matches the micro-ops against the superinstructions given, left to right and longest first.
+class BlockCache {
+public: // Functions/Methods
+    using HandlerTable = std::array<OpcodeHandler, 0x100>;
+
+    // Returns the block starting at PC, decoding it on a miss
+    [[nodiscard]] auto Lookup(ProcessorState &state, const HandlerTable &handlers,
+        const std::span<const Superinstruction> superinstructions) noexcept -> DecodedBlock &
+    {
+        return Lookup(state.memory, state.registers.GetPc(), handlers, superinstructions);
+    }
+
+    // Returns the block starting at address, decoding it on a miss, e.g. to decode code ahead of running it
+    [[nodiscard]] auto Lookup(SystemMemory &memory, const std::uint16_t address, const HandlerTable &handlers,
+        const std::span<const Superinstruction> superinstructions) noexcept -> DecodedBlock &
+    {
+        if (const auto &index = blockIndex_[address >> 8]; index != nullptr) {
+            if (const std::uint32_t blockId = (*index)[address & 0xFF]; blockId != noBlock) {
+                return blocks_[blockId];
+            }
+        }
+        return Decode(memory, address, handlers, superinstructions);
+    }
+
+    // False if the instruction at address may reach into a device page, Lookup() must not be called for it
+    [[nodiscard]] static auto IsCacheable(const SystemMemory &memory, const std::uint16_t address) noexcept -> bool
+    {
+        const auto attributes
+            = static_cast<std::uint8_t>(memory.GetPageAttributes(static_cast<std::uint8_t>(address >> 8))
+                | memory.GetPageAttributes(static_cast<std::uint8_t>((address + 2) >> 8)));
+        return (attributes & static_cast<std::uint8_t>(PageAttribute::Device)) == 0;
+    }
+
+    // Drops the blocks overlapping pages written to since the last call
+    auto Invalidate(SystemMemory &memory) noexcept -> void
+    {
+        const auto dirtyPages = memory.TakeDirtyPages();
+        for (std::size_t page = 0; page < dirtyPages.size(); page++) {
+            if (dirtyPages.test(page)) {
+                InvalidatePage(memory, static_cast<std::uint8_t>(page));
+            }
+        }
+        CompactIfStale(memory);
+    }
+
+    // Drops every block, e.g. after a new program has been copied into memory
+    auto Flush(SystemMemory &memory) noexcept -> void
+    {
+        Clear(memory);
+        pageInvalidations_.fill(0);
+    }
+
+    // Forgets the native code of every block, e.g. when the JIT has run out of space
+    auto DropNativeCode() noexcept -> void
+    {
+        for (DecodedBlock &block : blocks_) {
+            block.native = nullptr;
+        }
+    }
+
+    // True if the pages of the block keep getting written to, such code is not worth translating
+    [[nodiscard]] auto IsSelfModifying(const DecodedBlock &block) const noexcept -> bool
+    {
+        return pageInvalidations_[block.startAddress >> 8] >= maxPageInvalidations
+            || pageInvalidations_[block.endAddress >> 8] >= maxPageInvalidations;
+    }
+
+    [[nodiscard]] auto GetBlockCount() const noexcept -> std::size_t { return blocks_.size() - staleBlocks_; }
+
+    // Setting a breakpoint drops the blocks on its page, so that the one running through it is split there. Clearing
+    // one also drops those on the page before, so that a block which ended right before it can grow past it again.
+    auto SetBreakpoint(SystemMemory &memory, const std::uint16_t address) noexcept -> void
+    {
+        if (!breakpoints_.test(address)) {
+            breakpoints_.set(address);
+            breakpointCount_++;
+            DropPageBlocks(memory, static_cast<std::uint8_t>(address >> 8));
+            CompactIfStale(memory);
+        }
+    }
+
+    auto ClearBreakpoint(SystemMemory &memory, const std::uint16_t address) noexcept -> void
+    {
+        if (breakpoints_.test(address)) {
+            breakpoints_.reset(address);
+            breakpointCount_--;
+            DropPageBlocks(memory, static_cast<std::uint8_t>(address >> 8));
+            DropPageBlocks(memory, static_cast<std::uint8_t>((address - 1) >> 8));
+            CompactIfStale(memory);
+        }
+    }
+
+    [[nodiscard]] auto HasBreakpoint(const std::uint16_t address) const noexcept -> bool
+    {
+        return breakpoints_.test(address);
+    }
+
+    [[nodiscard]] auto HasBreakpoints() const noexcept -> bool { return breakpointCount_ != 0; }
+
+private: // Functions/Methods
+    auto Clear(SystemMemory &memory) noexcept -> void
+    {
+        for (std::size_t page = 0; page < blockIndex_.size(); page++) {
+            memory.ClearPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Code);
+            blockIndex_[page].reset();
+            pageBlocks_[page].clear();
+        }
+        (void)memory.TakeDirtyPages();
+        blocks_.clear();
+        staleBlocks_ = 0;
+    }
+
+    [[nodiscard]] auto Decode(SystemMemory &memory, const std::uint16_t startAddress, const HandlerTable &handlers,
+        const std::span<const Superinstruction> superinstructions) noexcept -> DecodedBlock &
+    {
+        DecodedBlock block;
+        block.startAddress    = startAddress;
+        std::uint16_t address = startAddress;
+        while (block.microOps.size() < maxBlockLength) {
+            const std::uint8_t  opcode  = memory.Fetch(address);
+            const auto          nextPc  = static_cast<std::uint16_t>(address + instructionLength[opcode]);
+            const std::uint16_t operand = memory.FetchOperand(address, instructionLength[opcode]);
+
+            block.microOps.push_back({ handlers[opcode], operand, nextPc, opcode, instructionCycles[opcode] });
+            block.cycles += instructionCycles[opcode];
+            block.endAddress = static_cast<std::uint16_t>(nextPc - 1);
+
+            // Do not let a block wrap around the end of memory
+            if (EndsBasicBlock(opcode) || nextPc < address || (breakpointCount_ != 0 && breakpoints_.test(nextPc))
+                || !IsCacheable(memory, nextPc)) {
+                break;
+            }
+            address = nextPc;
+        }
+        ClassifyDelayLoop(block);
+        Fuse(block, superinstructions);
+
+        const auto blockId = static_cast<std::uint32_t>(blocks_.size());
+        for (auto page = static_cast<std::uint8_t>(block.startAddress >> 8);; page++) {
+            memory.SetPageAttribute(page, PageAttribute::Code);
+            pageBlocks_[page].push_back(blockId);
+            if (page == block.endAddress >> 8) {
+                break;
+            }
+        }
+        auto &index = blockIndex_[startAddress >> 8];
+        if (index == nullptr) {
+            index = std::make_unique<std::array<std::uint32_t, 0x100>>();
+            index->fill(noBlock);
+        }
+        (*index)[startAddress & 0xFF] = blockId;
+        blocks_.push_back(std::move(block));
+        return blocks_.back();
+    }
+
+    static auto ClassifyDelayLoop(DecodedBlock &block) noexcept -> void
+    {
+        const std::vector<MicroOp> &ops = block.microOps;
+        if (ops.back().opcode != static_cast<std::uint8_t>(opcodes::JNZ) || ops.back().operand != block.startAddress) {
+            return;
+        }
+        const std::uint8_t first = ops.front().opcode;
+        if (ops.size() == 2 && (first & 0xC7) == 0x05 && DestinationField(first) != 0b110) {
+            block.delayLoop   = DelayLoop::Decrement;
+            block.loopCounter = DestinationField(first);
+        } else if (ops.size() == 4 && (first & 0xCF) == 0x0B && RegisterPairField(first) != 0b11) {
+            // Either half may go into A, the other one is ORed in
+            const auto high = static_cast<std::uint8_t>(RegisterPairField(first) * 2);
+            const auto move = static_cast<std::uint8_t>(ops[1].opcode ^ 0x78);
+            const auto ora  = static_cast<std::uint8_t>(ops[2].opcode ^ 0xB0);
+            if ((move == high && ora == high + 1) || (move == high + 1 && ora == high)) {
+                block.delayLoop   = DelayLoop::PairDecrement;
+                block.loopCounter = RegisterPairField(first);
+            }
+        }
+    }
+
+    static auto Fuse(DecodedBlock &block, const std::span<const Superinstruction> superinstructions) noexcept -> void
+    {
+        const std::vector<MicroOp> &ops = block.microOps;
+        std::vector<MicroOp>        fused;
+        for (std::size_t index = 0; index < ops.size();) {
+            const Superinstruction *match = nullptr;
+            for (const Superinstruction &candidate : superinstructions) {
+                if (candidate.length <= ops.size() - index && (match == nullptr || candidate.length > match->length)
+                    && std::equal(candidate.opcodes.begin(), candidate.opcodes.begin() + candidate.length,
+                        ops.begin() + static_cast<std::ptrdiff_t>(index),
+                        [](const std::uint8_t opcode, const MicroOp &microOp) { return opcode == microOp.opcode; })) {
+                    match = &candidate;
+                }
+            }
+            if (match == nullptr) {
+                fused.push_back(ops[index++]);
+                continue;
+            }
+
+            MicroOp superOp { match->handler, 0x0000, ops[index + match->length - 1].nextPc, ops[index].opcode, 0,
+                match->length };
+            for (std::size_t part = index; part < index + match->length; part++) {
+                superOp.cycles = static_cast<std::uint8_t>(superOp.cycles + ops[part].cycles);
+                if (instructionLength[ops[part].opcode] > 1) {
+                    superOp.operand = ops[part].operand;
+                }
+            }
+            fused.push_back(superOp);
+            index += match->length;
+        }
+        if (fused.size() < ops.size()) {
+            block.fusedOps = std::move(fused);
+        }
+    }
+
+    // Dropping a page's blocks because it was written to counts towards the page being taken for self-modifying code
+    auto InvalidatePage(SystemMemory &memory, const std::uint8_t page) noexcept -> void
+    {
+        DropPageBlocks(memory, page);
+        if (pageInvalidations_[page] < maxPageInvalidations) {
+            pageInvalidations_[page]++;
+        }
+    }
+
+    auto DropPageBlocks(SystemMemory &memory, const std::uint8_t page) noexcept -> void
+    {
+        for (const std::uint32_t blockId : pageBlocks_[page]) {
+            DecodedBlock &block = blocks_[blockId];
+            auto         &index = blockIndex_[block.startAddress >> 8];
+            // A block spanning several pages might have been dropped through another page already
+            if (index != nullptr && (*index)[block.startAddress & 0xFF] == blockId) {
+                (*index)[block.startAddress & 0xFF] = noBlock;
+                block.microOps                       = {};
+                block.fusedOps                       = {};
+                block.native                         = nullptr;
+                staleBlocks_++;
+            }
+        }
+        pageBlocks_[page].clear();
+        memory.ClearPageAttribute(page, PageAttribute::Code);
+    }
+
+    // Starts over once dropped blocks make up too much of the cache
+    auto CompactIfStale(SystemMemory &memory) noexcept -> void
+    {
+        if (staleBlocks_ > maxStaleBlocks) {
+            Clear(memory);
+        }
+    }
+
+public: // Data Members
+    static constexpr std::size_t maxBlockLength = 64;
+
+private: // Data Members
+    static constexpr std::uint32_t noBlock              = 0xFFFFFFFF;
+    static constexpr std::size_t   maxStaleBlocks       = 0x1000;
+    static constexpr std::uint8_t  maxPageInvalidations = 4;
+
+    std::vector<DecodedBlock> blocks_;
+    std::size_t               staleBlocks_ = 0;
+
+    // Block starting at each address, allocated for pages which contain code only
+    std::array<std::unique_ptr<std::array<std::uint32_t, 0x100>>, 0x100> blockIndex_;
+
+    // Blocks overlapping each page
+    std::array<std::vector<std::uint32_t>, 0x100> pageBlocks_;
+
+    // Times the blocks of each page have been invalidated by writes, saturating
+    std::array<std::uint8_t, 0x100> pageInvalidations_ = {};
+
+    std::bitset<0x10000> breakpoints_;
+    std::size_t          breakpointCount_ = 0;
+};
+
+} // namespace intel_8085
+
+#endif
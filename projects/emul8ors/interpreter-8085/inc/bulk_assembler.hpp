@@ -0,0 +1,175 @@
+#ifndef INTERPRETER_8085_BULK_ASSEMBLER_HPP
+#define INTERPRETER_8085_BULK_ASSEMBLER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+
+#include "log_capture.hpp"
+#include "program_image.hpp"
+#include "program_loader.hpp"
+#include "thread_pool.hpp"
+
+namespace intel_8085 {
+
+enum class ImageFormat : std::uint8_t { Image, IntelHex };
+
+// Outcome of assembling one program
+struct AssemblyResult {
+    std::filesystem::path    source;
+    std::filesystem::path    output;
+    std::vector<std::string> errors;
+    std::size_t              size    = 0; // Bytes written
+    std::uint64_t            digest  = 0; // FNV-1a of the bytes written
+    bool                     success = false;
+};
+
+// Assembles every .program file under a directory into a mirrored tree of program images on all cores, and writes
+// a manifest.csv of the outcomes to the root of the output tree.
+// What a program logs while it is assembled is collected into its result rather than printed, so the errors of
+// thousands of files do not interleave.
+class BulkAssembler {
+public: // Functions/Methods
+    explicit BulkAssembler(ThreadPool &pool, const ImageFormat format = ImageFormat::Image) noexcept
+        : pool_(pool), format_(format)
+    {
+    }
+
+    // Results are ordered by source path. An error scanning or creating the trees is returned as a single failed
+    // result against the directory involved.
+    [[nodiscard]] auto Run(const std::filesystem::path &sourceRoot, const std::filesystem::path &outputRoot)
+        -> std::vector<AssemblyResult>
+    {
+        std::vector<AssemblyResult> results;
+        std::error_code             error;
+        for (auto entry = std::filesystem::recursive_directory_iterator(sourceRoot, error);
+             !error && entry != std::filesystem::recursive_directory_iterator(); entry.increment(error)) {
+            if (entry->is_regular_file(error) && entry->path().extension() == ".program") {
+                AssemblyResult &result = results.emplace_back();
+                result.source          = entry->path();
+                result.output          = outputRoot / entry->path().lexically_relative(sourceRoot);
+                result.output.replace_extension(format_ == ImageFormat::IntelHex ? ".hex" : ".img");
+            }
+        }
+        if (error) {
+            return { Failure(sourceRoot, fmt::format("Could not scan the directory: {}", error.message())) };
+        }
+        std::sort(results.begin(), results.end(),
+            [](const AssemblyResult &left, const AssemblyResult &right) { return left.source < right.source; });
+
+        // Directories are created up front, the workers then only ever write their own files
+        std::filesystem::create_directories(outputRoot, error);
+        for (const AssemblyResult &result : results) {
+            if (!error) {
+                std::filesystem::create_directories(result.output.parent_path(), error);
+            }
+        }
+        if (error) {
+            return { Failure(outputRoot, fmt::format("Could not create the directory: {}", error.message())) };
+        }
+
+        LogCapture::Install();
+        pool_.ForEach(results.size(), [&](const std::size_t, const std::size_t job) { Assemble(results[job]); });
+        if (!WriteManifest(outputRoot / "manifest.csv", results)) {
+            results.push_back(Failure(outputRoot / "manifest.csv", "Could not write the manifest"));
+        }
+        return results;
+    }
+
+private: // Functions/Methods
+    auto Assemble(AssemblyResult &result) const noexcept -> void
+    {
+        LogCapture capture;
+        const auto program = ProgramLoader::Parse(result.source.string());
+        if (program.has_value() && !ProgramLoader::VerifyProgram(program.value())) {
+            spdlog::error("Invalid program, its sections are out of the address ranges they are loaded into");
+        } else if (program.has_value()) {
+            if (format_ == ImageFormat::IntelHex) {
+                const std::string text = ProgramImage::EncodeIntelHex(program.value());
+                result.success         = Write(result, std::as_bytes(std::span(text)));
+            } else {
+                const std::vector<std::uint8_t> bytes = ProgramImage::EncodeImage(program.value());
+                result.success                        = Write(result, std::as_bytes(std::span(bytes)));
+            }
+        }
+        result.errors = capture.TakeMessages();
+        if (!result.success && result.errors.empty()) {
+            result.errors.emplace_back("Invalid program");
+        }
+    }
+
+    [[nodiscard]] static auto Write(AssemblyResult &result, const std::span<const std::byte> bytes) noexcept -> bool
+    {
+        std::ofstream file(result.output, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            spdlog::error("Could not write {}", result.output.string());
+            return false;
+        }
+        result.size   = bytes.size();
+        result.digest = 0xCBF29CE484222325ULL;
+        for (const std::byte byte : bytes) {
+            result.digest = (result.digest ^ static_cast<std::uint8_t>(byte)) * 0x100000001B3ULL;
+        }
+        return true;
+    }
+
+    // One line per program: source,output,status,size,digest,errors
+    [[nodiscard]] static auto WriteManifest(
+        const std::filesystem::path &filename, const std::vector<AssemblyResult> &results) noexcept -> bool
+    {
+        std::string text = "source,output,status,size,digest,errors\n";
+        for (const AssemblyResult &result : results) {
+            std::string errors;
+            for (const std::string &message : result.errors) {
+                errors += errors.empty() ? message : "; " + message;
+            }
+            text += fmt::format("{},{},{},{},{:016x},{}\n", CsvField(result.source.string()),
+                CsvField(result.output.string()), result.success ? "ok" : "failed", result.size, result.digest,
+                CsvField(errors));
+        }
+        std::ofstream file(filename, std::ios::trunc);
+        file << text;
+        return static_cast<bool>(file);
+    }
+
+    // Quotes a field holding a separator or a quote
+    [[nodiscard]] static auto CsvField(const std::string_view field) noexcept -> std::string
+    {
+        if (field.find_first_of(",\"\n") == std::string_view::npos) {
+            return std::string(field);
+        }
+        std::string quoted = "\"";
+        for (const char c : field) {
+            quoted += c == '"' ? "\"\"" : std::string(1, c);
+        }
+        return quoted + "\"";
+    }
+
+    [[nodiscard]] static auto Failure(const std::filesystem::path &path, std::string message) -> AssemblyResult
+    {
+        AssemblyResult result;
+        result.source = path;
+        result.errors.push_back(std::move(message));
+        return result;
+    }
+
+public:  // Data Members
+private: // Data Members
+    ThreadPool       &pool_;
+    const ImageFormat format_;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,368 @@
+#ifndef INTERPRETER_8085_CONTROL_FLOW_GRAPH_HPP
+#define INTERPRETER_8085_CONTROL_FLOW_GRAPH_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "instruction_set.hpp"
+#include "system_memory.hpp"
+
+namespace intel_8085 {
+
+// What the static disassembly took a byte of memory for
+enum class ByteKind : std::uint8_t {
+    Data,    // Never reached by the control flow, or not code the disassembly could follow
+    Opcode,  // First byte of an instruction
+    Operand, // One of the bytes following an opcode
+};
+
+// A straight-line run of code found by the static disassembly, only its last instruction may transfer control
+struct BasicBlock {
+    std::uint16_t              startAddress = 0x0000;
+    std::uint16_t              endAddress   = 0x0000; // Address of the last byte
+    std::vector<std::uint16_t> successors   = {};     // Start addresses of the blocks control may go to next
+    bool                       loopHead     = false;  // Target of a backward edge, i.e. where a loop starts over
+};
+
+// Control-flow graph recovered from a memory image without running it.
+// Disassembly starts at the entry points given and follows every path the instructions can take, by the opcode
+// length table: jumps, calls and RSTs lead to their targets, and every instruction but JMP, RET, PCHL and HLT on
+// to the next one. Calls are assumed to return. Targets only known at run time, i.e. those of PCHL, are not followed,
+// nor is code on device pages or code overlapping the bytes of instructions decoded already. Bytes never reached are
+// taken for data.
+// Blocks start at the entry points, at branch targets and after every instruction which ends a block of the
+// BlockCache, so the blocks of both start at the same addresses.
+class ControlFlowGraph {
+public: // Functions/Methods
+    [[nodiscard]] static auto Build(const SystemMemory &memory, const std::span<const std::uint16_t> entryPoints)
+        -> ControlFlowGraph
+    {
+        ControlFlowGraph graph;
+        graph.Walk(memory, entryPoints);
+        graph.BuildBlocks(memory);
+        graph.FindLoopHeads(entryPoints);
+        return graph;
+    }
+
+    // The entry point along with the RST and interrupt vectors holding anything but zeros, as memory no program
+    // was loaded into is all zeros
+    [[nodiscard]] static auto DefaultEntryPoints(const SystemMemory &memory, const std::uint16_t entryPoint)
+        -> std::vector<std::uint16_t>
+    {
+        constexpr std::array<std::uint16_t, 12> vectors { 0x00, 0x08, 0x10, 0x18, 0x20, 0x24, 0x28, 0x2C, 0x30, 0x34,
+            0x38, 0x3C };
+        std::vector<std::uint16_t>              entryPoints { entryPoint };
+        for (const std::uint16_t vector : vectors) {
+            if (vector != entryPoint && memory.GetPage(0x00)[vector] != 0x00) {
+                entryPoints.push_back(vector);
+            }
+        }
+        return entryPoints;
+    }
+
+    // Ordered by start address
+    [[nodiscard]] auto GetBlocks() const noexcept -> const std::vector<BasicBlock> & { return blocks_; }
+
+    [[nodiscard]] auto GetByteKind(const std::uint16_t address) const noexcept -> ByteKind { return kinds_[address]; }
+
+    // Assembly-like listing of the whole address space, e.g.
+    //   L1000:
+    //   1000  21 00 80  LXI_H     0x8000
+    //   1003  C2 00 10  JNZ       L1000
+    //   1006  DB 00 11 22 33 44 55 66 77
+    // with a label at every block start, and runs of zero data bytes too long to be anything but unused memory left
+    // out
+    auto WriteListing(std::ostream &outStream, const SystemMemory &memory) const -> void
+    {
+        std::uint32_t address = 0;
+        while (address < 0x10000) {
+            if (kinds_[address] == ByteKind::Opcode) {
+                if (blockStarts_.test(address)) {
+                    outStream << fmt::format("\nL{:04X}:\n", address);
+                }
+                outStream << FormatInstruction(memory, static_cast<std::uint16_t>(address)) << '\n';
+                address += instructionLength[ReadByte(memory, address)];
+                continue;
+            }
+
+            std::uint32_t end = address;
+            while (end < 0x10000 && kinds_[end] != ByteKind::Opcode && ReadByte(memory, end) == 0x00) {
+                end++;
+            }
+            if (end - address >= minSkippedZeros) {
+                outStream << fmt::format("; {:04X} - {:04X} zeros\n", address, end - 1);
+                address = end;
+                continue;
+            }
+            std::string row = fmt::format("{:04X}  DB", address);
+            for (std::uint32_t column = 0;
+                 column < dataRowLength && address < 0x10000 && kinds_[address] != ByteKind::Opcode; column++) {
+                row += fmt::format(" {:02X}", ReadByte(memory, address++));
+            }
+            outStream << row << '\n';
+        }
+    }
+
+    // Graphviz DOT of the blocks with their disassembly, calls drawn dashed and loop heads bold
+    auto WriteGraph(std::ostream &outStream, const SystemMemory &memory) const -> void
+    {
+        outStream << "digraph cfg {\n    node [shape=box, fontname=\"monospace\"];\n";
+        for (const BasicBlock &block : blocks_) {
+            std::string label;
+            for (std::uint32_t address = block.startAddress; address <= block.endAddress;
+                 address += instructionLength[ReadByte(memory, address)]) {
+                label += FormatInstruction(memory, static_cast<std::uint16_t>(address)) + "\\l";
+            }
+            outStream << fmt::format("    L{:04X} [label=\"L{:04X}:\\l{}\"{}];\n", block.startAddress,
+                block.startAddress, label, block.loopHead ? ", style=bold" : "");
+
+            const std::uint8_t last = ReadByte(memory, LastInstruction(memory, block));
+            for (const std::uint16_t successor : block.successors) {
+                const bool call = IsCall(last) && successor != static_cast<std::uint16_t>(block.endAddress + 1);
+                outStream << fmt::format("    L{:04X} -> L{:04X}{};\n", block.startAddress, successor,
+                    call ? " [style=dashed]" : "");
+            }
+        }
+        outStream << "}\n";
+    }
+
+private: // Functions/Methods
+    ControlFlowGraph() : kinds_(0x10000, ByteKind::Data) { }
+
+    // Reads around devices, so that disassembling has no side effects
+    [[nodiscard]] static auto ReadByte(const SystemMemory &memory, const std::uint32_t address) noexcept
+        -> std::uint8_t
+    {
+        return memory.GetPage(static_cast<std::uint8_t>(address >> 8))[address & 0xFF];
+    }
+
+    [[nodiscard]] static auto ReadWord(const SystemMemory &memory, const std::uint32_t address) noexcept
+        -> std::uint16_t
+    {
+        return static_cast<std::uint16_t>(ReadByte(memory, (address + 1) & 0xFFFF)
+            | ReadByte(memory, (address + 2) & 0xFFFF) << 8);
+    }
+
+    // JMP, Jcc, CALL and Ccc
+    [[nodiscard]] static constexpr auto HasTargetOperand(const std::uint8_t opcode) noexcept -> bool
+    {
+        return opcode == static_cast<std::uint8_t>(opcodes::JMP) || opcode == static_cast<std::uint8_t>(opcodes::CALL)
+            || (OpcodeGroup(opcode) == 0b11 && (SourceField(opcode) == 0b010 || SourceField(opcode) == 0b100));
+    }
+
+    [[nodiscard]] static constexpr auto FallsThrough(const std::uint8_t opcode) noexcept -> bool
+    {
+        return IsValidOpcode(opcode) && opcode != static_cast<std::uint8_t>(opcodes::JMP)
+            && opcode != static_cast<std::uint8_t>(opcodes::RET) && opcode != static_cast<std::uint8_t>(opcodes::PCHL)
+            && opcode != static_cast<std::uint8_t>(opcodes::HLT);
+    }
+
+    // Address control goes to when the instruction branches, none for those not branching or to unknown targets
+    [[nodiscard]] static auto GetTarget(const SystemMemory &memory, const std::uint16_t address) noexcept
+        -> std::uint32_t
+    {
+        const std::uint8_t opcode = ReadByte(memory, address);
+        if (HasTargetOperand(opcode)) {
+            return ReadWord(memory, address);
+        }
+        if (OpcodeGroup(opcode) == 0b11 && SourceField(opcode) == 0b111) {
+            return opcode & 0x38; // RST n calls 8 * n
+        }
+        return noTarget;
+    }
+
+    // Decodes every instruction reachable from the entry points, marking block starts on the way
+    auto Walk(const SystemMemory &memory, const std::span<const std::uint16_t> entryPoints) -> void
+    {
+        std::vector<std::uint16_t> pending(entryPoints.begin(), entryPoints.end());
+        for (const std::uint16_t entryPoint : entryPoints) {
+            blockStarts_.set(entryPoint);
+        }
+        while (!pending.empty()) {
+            std::uint32_t address = pending.back();
+            pending.pop_back();
+            while (address < 0x10000 && kinds_[address] == ByteKind::Data) {
+                const std::uint8_t opcode = ReadByte(memory, address);
+                const std::uint8_t length = instructionLength[opcode];
+                if (!IsValidOpcode(opcode) || !IsDecodable(memory, address, length)) {
+                    break;
+                }
+                kinds_[address] = ByteKind::Opcode;
+                for (std::uint32_t operand = address + 1; operand < address + length; operand++) {
+                    kinds_[operand] = ByteKind::Operand;
+                }
+
+                if (const std::uint32_t target = GetTarget(memory, static_cast<std::uint16_t>(address));
+                    target != noTarget) {
+                    blockStarts_.set(target);
+                    pending.push_back(static_cast<std::uint16_t>(target));
+                }
+                if (!FallsThrough(opcode)) {
+                    break;
+                }
+                address += length;
+                if (EndsBasicBlock(opcode) && address < 0x10000) {
+                    blockStarts_.set(address);
+                }
+            }
+        }
+    }
+
+    // The instruction must not wrap around the end of memory, lie on a device page or overlap decoded bytes
+    [[nodiscard]] auto IsDecodable(const SystemMemory &memory, const std::uint32_t address,
+        const std::uint8_t length) const noexcept -> bool
+    {
+        constexpr auto device = static_cast<std::uint8_t>(PageAttribute::Device);
+        for (std::uint32_t byte = address; byte < address + length; byte++) {
+            if (byte >= 0x10000 || kinds_[byte] != ByteKind::Data
+                || (memory.GetPageAttributes(static_cast<std::uint8_t>(byte >> 8)) & device)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Groups the decoded instructions into blocks, each running up to the next block start or instruction ending
+    // a block
+    auto BuildBlocks(const SystemMemory &memory) -> void
+    {
+        std::uint32_t address = 0;
+        while (address < 0x10000) {
+            if (kinds_[address] != ByteKind::Opcode) {
+                address++;
+                continue;
+            }
+            BasicBlock block;
+            block.startAddress = static_cast<std::uint16_t>(address);
+            while (true) {
+                const std::uint8_t  opcode = ReadByte(memory, address);
+                const std::uint32_t next   = address + instructionLength[opcode];
+                block.endAddress           = static_cast<std::uint16_t>(next - 1);
+                if (EndsBasicBlock(opcode) || next >= 0x10000 || kinds_[next] != ByteKind::Opcode
+                    || blockStarts_.test(next)) {
+                    AddSuccessors(memory, block, static_cast<std::uint16_t>(address), next);
+                    address = next;
+                    break;
+                }
+                address = next;
+            }
+            blocks_.push_back(std::move(block));
+        }
+    }
+
+    auto AddSuccessors(const SystemMemory &memory, BasicBlock &block, const std::uint16_t last,
+        const std::uint32_t next) const -> void
+    {
+        const std::uint32_t target = GetTarget(memory, last);
+        if (target != noTarget && kinds_[target] == ByteKind::Opcode) {
+            block.successors.push_back(static_cast<std::uint16_t>(target));
+        }
+        if (FallsThrough(ReadByte(memory, last)) && next < 0x10000 && kinds_[next] == ByteKind::Opcode
+            && next != target) {
+            block.successors.push_back(static_cast<std::uint16_t>(next));
+        }
+    }
+
+    // Depth-first from the entry points, an edge back to a block still on the path closes a loop
+    auto FindLoopHeads(const std::span<const std::uint16_t> entryPoints) -> void
+    {
+        constexpr std::uint8_t    unvisited = 0;
+        constexpr std::uint8_t    onPath    = 1;
+        constexpr std::uint8_t    finished  = 2;
+        std::vector<std::uint8_t> states(blocks_.size(), unvisited);
+        // Block and the index of the next successor to visit
+        std::vector<std::pair<std::size_t, std::size_t>> path;
+
+        for (const std::uint16_t entryPoint : entryPoints) {
+            const std::size_t entry = FindBlock(entryPoint);
+            if (entry == blocks_.size() || states[entry] != unvisited) {
+                continue;
+            }
+            states[entry] = onPath;
+            path.emplace_back(entry, 0);
+            while (!path.empty()) {
+                auto &[block, successor] = path.back();
+                if (successor == blocks_[block].successors.size()) {
+                    states[block] = finished;
+                    path.pop_back();
+                    continue;
+                }
+                const std::size_t next = FindBlock(blocks_[block].successors[successor++]);
+                if (next == blocks_.size()) {
+                    continue;
+                }
+                if (states[next] == onPath) {
+                    blocks_[next].loopHead = true;
+                } else if (states[next] == unvisited) {
+                    states[next] = onPath;
+                    path.emplace_back(next, 0);
+                }
+            }
+        }
+    }
+
+    // Index of the block starting at address, the block count if there is none
+    [[nodiscard]] auto FindBlock(const std::uint16_t address) const noexcept -> std::size_t
+    {
+        const auto block = std::lower_bound(blocks_.begin(), blocks_.end(), address,
+            [](const BasicBlock &candidate, const std::uint16_t start) { return candidate.startAddress < start; });
+        return block != blocks_.end() && block->startAddress == address
+            ? static_cast<std::size_t>(block - blocks_.begin())
+            : blocks_.size();
+    }
+
+    [[nodiscard]] static auto LastInstruction(const SystemMemory &memory, const BasicBlock &block) noexcept
+        -> std::uint16_t
+    {
+        std::uint32_t address = block.startAddress;
+        while (address + instructionLength[ReadByte(memory, address)] <= block.endAddress) {
+            address += instructionLength[ReadByte(memory, address)];
+        }
+        return static_cast<std::uint16_t>(address);
+    }
+
+    // Laid out like the instructions of an execution trace, branch targets by their labels
+    [[nodiscard]] auto FormatInstruction(const SystemMemory &memory, const std::uint16_t address) const -> std::string
+    {
+        const std::uint8_t opcode = ReadByte(memory, address);
+        const std::uint8_t length = instructionLength[opcode];
+        std::string        bytes  = fmt::format("{:02X}", opcode);
+        for (std::uint32_t index = 1; index < length; index++) {
+            bytes += fmt::format(" {:02X}", ReadByte(memory, (address + index) & 0xFFFF));
+        }
+        std::string operand;
+        if (HasTargetOperand(opcode) && blockStarts_.test(ReadWord(memory, address))) {
+            operand = fmt::format("L{:04X}", ReadWord(memory, address));
+        } else if (length == 3) {
+            operand = fmt::format("0x{:04X}", ReadWord(memory, address));
+        } else if (length == 2) {
+            operand = fmt::format("0x{:02X}", ReadByte(memory, (address + 1) & 0xFFFF));
+        }
+        std::string line = fmt::format("{:04X}  {:<8}  {:<9} {}", address, bytes, instructionMnemonic[opcode], operand);
+        line.erase(line.find_last_not_of(' ') + 1);
+        return line;
+    }
+
+public:  // Data Members
+private: // Data Members
+    static constexpr std::uint32_t noTarget        = 0x10000;
+    static constexpr std::uint32_t minSkippedZeros = 16;
+    static constexpr std::uint32_t dataRowLength   = 8;
+
+    std::vector<ByteKind>   kinds_;
+    std::bitset<0x10000>    blockStarts_;
+    std::vector<BasicBlock> blocks_;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef INTERPRETER_8085_DEVICE_BUS_HPP
+#define INTERPRETER_8085_DEVICE_BUS_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+
+namespace intel_8085 {
+
+// A peripheral on the system bus. Port devices see ports relative to the first port they are mapped at, memory
+// mapped devices see addresses relative to the start of their region. Port accesses carry the T-state count at the
+// end of the IN or OUT instruction, so that devices can derive their timing from it.
+// Out() and a memory mapped Write() may raise interrupts or schedule events, every dispatch mode ends the run right
+// after the instruction. In() may too, Read() must not: loads are not checked for stop requests.
+class Device {
+public: // Functions/Methods
+    Device() noexcept                          = default;
+    Device(const Device &)                     = delete;
+    auto operator=(const Device &) -> Device & = delete;
+    virtual ~Device()                          = default;
+
+    [[nodiscard]] virtual auto In(std::uint8_t /*port*/, std::uint64_t /*cycle*/) noexcept -> std::uint8_t
+    {
+        return 0xFF;
+    }
+
+    virtual auto Out(std::uint8_t /*port*/, std::uint8_t /*value*/, std::uint64_t /*cycle*/) noexcept -> void { }
+
+    [[nodiscard]] virtual auto Read(std::uint16_t /*offset*/) noexcept -> std::uint8_t { return 0xFF; }
+
+    virtual auto Write(std::uint16_t /*offset*/, std::uint8_t /*value*/) noexcept -> void { }
+};
+
+// Routes the 256 I/O ports and the 256 memory pages to devices. Neither table owns its devices.
+// Ports without a device keep the latch behaviour of the processor state, pages without a device stay plain RAM.
+// SystemMemory only looks a page up here once PageAttribute::Device marks it, so RAM accesses never reach the bus.
+class DeviceBus {
+public: // Functions/Methods
+    // Maps count ports starting at first, fails if any of them is taken or the range runs past port 0xFF
+    [[nodiscard]] auto MapPorts(Device &device, const std::uint8_t first, const std::size_t count) noexcept -> bool
+    {
+        return Map(ports_, device, first, count, "port");
+    }
+
+    // Maps pageCount pages of 256 bytes starting at firstPage, the region starts at address firstPage << 8.
+    // Regions must be mapped before the bus is attached to a memory.
+    [[nodiscard]] auto MapRegion(Device &device, const std::uint8_t firstPage, const std::size_t pageCount) noexcept
+        -> bool
+    {
+        return Map(pages_, device, firstPage, pageCount, "page");
+    }
+
+    [[nodiscard]] auto IsPageMapped(const std::uint8_t page) const noexcept -> bool
+    {
+        return pages_[page].device != nullptr;
+    }
+
+    // Unmapped ports read back the value last written to them
+    [[nodiscard]] auto In(const std::uint8_t port, const std::uint8_t latch, const std::uint64_t cycle) const noexcept
+        -> std::uint8_t
+    {
+        const Mapping &mapping = ports_[port];
+        if (mapping.device == nullptr) {
+            return latch;
+        }
+        return mapping.device->In(static_cast<std::uint8_t>(port - mapping.first), cycle);
+    }
+
+    auto Out(const std::uint8_t port, const std::uint8_t value, const std::uint64_t cycle) const noexcept -> void
+    {
+        const Mapping &mapping = ports_[port];
+        if (mapping.device != nullptr) {
+            mapping.device->Out(static_cast<std::uint8_t>(port - mapping.first), value, cycle);
+        }
+    }
+
+    [[nodiscard]] auto Read(const std::uint16_t address) const noexcept -> std::uint8_t
+    {
+        const Mapping &mapping = pages_[address >> 8];
+        return mapping.device->Read(static_cast<std::uint16_t>(address - (mapping.first << 8)));
+    }
+
+    auto Write(const std::uint16_t address, const std::uint8_t value) const noexcept -> void
+    {
+        const Mapping &mapping = pages_[address >> 8];
+        mapping.device->Write(static_cast<std::uint16_t>(address - (mapping.first << 8)), value);
+    }
+
+private: // Functions/Methods
+    struct Mapping {
+        Device      *device = nullptr;
+        std::uint8_t first  = 0;
+    };
+
+    [[nodiscard]] static auto Map(std::array<Mapping, 0x100> &table, Device &device, const std::uint8_t first,
+        const std::size_t count, const char *kind) noexcept -> bool
+    {
+        if (count == 0 || first + count > table.size()) {
+            spdlog::error("Cannot map {} {}s from {:#04x}", count, kind, first);
+            return false;
+        }
+        for (std::size_t index = first; index < first + count; index++) {
+            if (table[index].device != nullptr) {
+                spdlog::error("The {} {:#04x} is already mapped", kind, index);
+                return false;
+            }
+        }
+        for (std::size_t index = first; index < first + count; index++) {
+            table[index] = { &device, first };
+        }
+        return true;
+    }
+
+public:  // Data Members
+private: // Data Members
+    std::array<Mapping, 0x100> ports_ {};
+    std::array<Mapping, 0x100> pages_ {};
+};
+
+} // namespace intel_8085
+
+#endif
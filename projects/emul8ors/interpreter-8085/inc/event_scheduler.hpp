@@ -0,0 +1,77 @@
+#ifndef INTERPRETER_8085_EVENT_SCHEDULER_HPP
+#define INTERPRETER_8085_EVENT_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "processor_state.hpp"
+
+namespace intel_8085 {
+
+// Callbacks due at a T-state count, kept in a min-heap ordered by cycle and then by the order they were scheduled in.
+// The processor runs uninterrupted up to the earliest of them, so devices are never polled between instructions.
+// A callback runs at the first instruction boundary at or past its cycle and receives the cycle it was due at, which
+// keeps periodic events from drifting.
+class EventScheduler {
+public: // Functions/Methods
+    using Callback = std::function<void(std::uint64_t cycle)>;
+
+    explicit EventScheduler(ProcessorState &state) noexcept : state_(state) { }
+
+    // Scheduling ahead of every other event, e.g. from a device while the processor runs, ends the current run so
+    // that the new event is not missed
+    auto Schedule(const std::uint64_t cycle, Callback callback) noexcept -> void
+    {
+        if (cycle < GetNextCycle()) {
+            state_.stopRequested = true;
+        }
+        events_.push_back({ cycle, sequence_++, std::move(callback) });
+        std::push_heap(events_.begin(), events_.end(), Later);
+    }
+
+    [[nodiscard]] auto GetNextCycle() const noexcept -> std::uint64_t
+    {
+        return events_.empty() ? std::numeric_limits<std::uint64_t>::max() : events_.front().cycle;
+    }
+
+    [[nodiscard]] auto IsEmpty() const noexcept -> bool { return events_.empty(); }
+
+    // Runs the callbacks due by cycle earliest first, including those they schedule themselves for no later than it
+    auto RunDue(const std::uint64_t cycle) noexcept -> void
+    {
+        while (!events_.empty() && events_.front().cycle <= cycle) {
+            std::pop_heap(events_.begin(), events_.end(), Later);
+            Event event = std::move(events_.back());
+            events_.pop_back();
+            event.callback(event.cycle);
+        }
+    }
+
+    auto Clear() noexcept -> void { events_.clear(); }
+
+private: // Functions/Methods
+    struct Event {
+        std::uint64_t cycle;
+        std::uint64_t sequence;
+        Callback      callback;
+    };
+
+    [[nodiscard]] static auto Later(const Event &left, const Event &right) noexcept -> bool
+    {
+        return left.cycle != right.cycle ? left.cycle > right.cycle : left.sequence > right.sequence;
+    }
+
+public:  // Data Members
+private: // Data Members
+    ProcessorState    &state_;
+    std::vector<Event> events_;
+    std::uint64_t      sequence_ = 0;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef INTERPRETER_8085_EXECUTION_HISTORY_HPP
+#define INTERPRETER_8085_EXECUTION_HISTORY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "processor_state.hpp"
+#include "write_journal.hpp"
+
+namespace intel_8085 {
+
+// Recent past of a processor for reverse execution: a checkpoint of the state every interval T-states, taken at the
+// first instruction boundary past it, and the journal of the memory writes since each checkpoint. Going back
+// restores the newest checkpoint before the point wanted and replays from there, the journal tells which instruction
+// last wrote an address without replaying anything.
+// Checkpoints are copies of the state sharing its memory pages copy-on-write, so one costs a page table copy and
+// the pages written to until the next. Once maxCheckpoints are kept the oldest is dropped and its journal buffer
+// reused for the next segment. No instruction writes more than one byte per 6 T-states, which bounds the journal
+// of a segment to interval / 6 entries of 8 bytes.
+class ExecutionHistory {
+public: // Functions/Methods
+    explicit ExecutionHistory(ProcessorState &state) noexcept : state_(state), journal_(state.cycles) { }
+
+    ExecutionHistory(const ExecutionHistory &)                     = delete;
+    auto operator=(const ExecutionHistory &) -> ExecutionHistory & = delete;
+
+    ~ExecutionHistory() { state_.memory.AttachJournal(nullptr); }
+
+    // Starts recording from the current state, forgetting anything recorded before
+    auto Enable(const std::uint64_t interval, const std::size_t maxCheckpoints) noexcept -> void
+    {
+        interval_       = std::clamp<std::uint64_t>(interval, 1, maxInterval);
+        maxCheckpoints_ = std::max<std::size_t>(maxCheckpoints, 1);
+        enabled_        = true;
+        state_.memory.AttachJournal(&journal_);
+        Restart();
+    }
+
+    auto Disable() noexcept -> void
+    {
+        state_.memory.AttachJournal(nullptr);
+        segments_.clear();
+        enabled_        = false;
+        nextCheckpoint_ = std::numeric_limits<std::uint64_t>::max();
+    }
+
+    [[nodiscard]] auto IsEnabled() const noexcept -> bool { return enabled_; }
+
+    // Forgets everything before the current state, e.g. after a program was loaded
+    auto Restart() noexcept -> void
+    {
+        if (enabled_) {
+            segments_.clear();
+            Checkpoint();
+        }
+    }
+
+    // Runs have to stop at the returned cycle count for Update() to take the checkpoint on time
+    [[nodiscard]] auto GetNextCheckpoint() const noexcept -> std::uint64_t { return nextCheckpoint_; }
+
+    // Called at instruction boundaries, takes a checkpoint once the interval passed
+    auto Update() noexcept -> void
+    {
+        if (state_.cycles >= nextCheckpoint_) {
+            Checkpoint();
+        }
+    }
+
+    // Newest checkpoint taken before cycle, nullptr if the history does not reach back that far
+    [[nodiscard]] auto FindCheckpoint(const std::uint64_t cycle) const noexcept -> const ProcessorState *
+    {
+        for (auto segment = segments_.rbegin(); segment != segments_.rend(); ++segment) {
+            if (segment->checkpoint.cycles < cycle) {
+                return &segment->checkpoint;
+            }
+        }
+        return nullptr;
+    }
+
+    // Called once the state was reset to one of the checkpoints, drops everything recorded after it and starts
+    // recording again from there
+    auto Truncate() noexcept -> void
+    {
+        while (segments_.size() > 1 && segments_.back().checkpoint.cycles > state_.cycles) {
+            spare_ = std::move(segments_[segments_.size() - 2].entries);
+            segments_.pop_back();
+        }
+        spare_          = journal_.Cut(std::move(spare_));
+        nextCheckpoint_ = state_.cycles + interval_;
+    }
+
+    // T-state count at the last recorded write to address, which falls within the instruction that made it
+    [[nodiscard]] auto FindLastWrite(const std::uint16_t address) const noexcept -> std::optional<std::uint64_t>
+    {
+        if (const auto cycle = FindLastWrite(journal_.GetEntries(), journal_.GetBase(), address)) {
+            return cycle;
+        }
+        // The newest segment is the one journaled right now
+        for (std::size_t index = segments_.size(); index-- > 1;) {
+            const Segment &segment = segments_[index - 1];
+            if (const auto cycle = FindLastWrite(segment.entries, segment.checkpoint.cycles, address)) {
+                return cycle;
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto GetCheckpointCount() const noexcept -> std::size_t { return segments_.size(); }
+
+private: // Functions/Methods
+    // A checkpoint along with the writes journaled until the next one, the newest segment's are in journal_
+    struct Segment {
+        ProcessorState            checkpoint;
+        std::vector<JournalEntry> entries;
+    };
+
+    auto Checkpoint() noexcept -> void
+    {
+        if (segments_.size() == maxCheckpoints_) {
+            spare_ = std::move(segments_.front().entries);
+            segments_.pop_front();
+        }
+        std::vector<JournalEntry> ended = journal_.Cut(std::move(spare_));
+        if (!segments_.empty()) {
+            segments_.back().entries = std::move(ended);
+        } else {
+            spare_ = std::move(ended);
+        }
+        segments_.push_back({ state_, {} });
+        nextCheckpoint_ = state_.cycles + interval_;
+    }
+
+    [[nodiscard]] static auto FindLastWrite(const std::vector<JournalEntry> &entries, const std::uint64_t base,
+        const std::uint16_t address) noexcept -> std::optional<std::uint64_t>
+    {
+        const auto entry = std::find_if(entries.rbegin(), entries.rend(),
+            [address](const JournalEntry &candidate) { return candidate.address == address; });
+        if (entry == entries.rend()) {
+            return std::nullopt;
+        }
+        return base + entry->cycleDelta;
+    }
+
+public:  // Data Members
+    static constexpr std::uint64_t defaultInterval       = 1 << 20;
+    static constexpr std::size_t   defaultMaxCheckpoints = 16;
+
+private: // Data Members
+    // Keeps the cycle deltas of the journal within 32 bits, with room for the instruction crossing the interval
+    static constexpr std::uint64_t maxInterval = std::uint64_t { 1 } << 31;
+
+    ProcessorState           &state_;
+    WriteJournal              journal_;
+    std::deque<Segment>       segments_;
+    std::vector<JournalEntry> spare_;
+    std::uint64_t             interval_       = defaultInterval;
+    std::size_t               maxCheckpoints_ = defaultMaxCheckpoints;
+    std::uint64_t             nextCheckpoint_ = std::numeric_limits<std::uint64_t>::max();
+    bool                      enabled_        = false;
+};
+
+} // namespace intel_8085
+
+#endif
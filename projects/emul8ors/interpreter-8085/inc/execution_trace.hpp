@@ -0,0 +1,512 @@
+#ifndef INTERPRETER_8085_EXECUTION_TRACE_HPP
+#define INTERPRETER_8085_EXECUTION_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+#include "zlib.h"
+
+#include "instruction_set.hpp"
+#include "little_endian.hpp"
+#include "processor_state.hpp"
+#include "register_file.hpp"
+#include "spsc_ring.hpp"
+
+namespace intel_8085 {
+
+// One executed instruction, with the machine state it left behind
+struct TraceRecord {
+    std::uint64_t               cycle     = 0; // T-states elapsed once the instruction completed
+    std::uint16_t               pc        = 0; // Address of the instruction
+    std::uint16_t               sp        = 0;
+    std::uint16_t               operand   = 0; // The bytes following the opcode, little endian
+    std::uint8_t                opcode    = 0;
+    std::uint8_t                flags     = 0;
+    std::array<std::uint8_t, 7> registers = {}; // B, C, D, E, H, L, A
+    bool                        interrupt = false; // An interrupt was accepted right before the instruction
+};
+static_assert(sizeof(TraceRecord) == 24);
+
+// Delta encoding of consecutive trace records, each record is encoded against the one before it and against the
+// instruction last executed at the same address:
+//   changes      - byte, which of the optional fields below are present and whether an interrupt was accepted
+//                  right before the instruction
+//   pc           - u16, only if it is not where the previous instruction falls through to
+//   opcode       - byte, only if the instruction differs from the one last executed at pc, so in effect once per
+//                  address unless the code modifies itself
+//   operand      - the instruction's 0 to 2 operand bytes, along with the opcode
+//   sp           - u16, only if changed
+//   flags        - byte, only if changed
+//   registers    - byte mask of the changed registers (bit 0 - B ... bit 6 - A) followed by each of them,
+//                  only if any changed
+//   cycle delta  - LEB128, only if the instruction did not take the T-states listed for its opcode, i.e. a taken
+//                  conditional branch or an instruction preceded by accepting an interrupt
+// A typical record takes 1 to 4 bytes before the zlib stream compresses it further.
+class TraceCodec {
+public: // Functions/Methods
+    static constexpr std::size_t maxEncodedSize = 1 + 2 + 1 + 2 + 2 + 1 + 1 + 7 + 10;
+
+    TraceCodec() : code_(0x10000, noInstruction) {}
+
+    // Writes the record at the start of bytes and returns its size
+    [[nodiscard]] auto Encode(const TraceRecord &record, const std::span<std::uint8_t, maxEncodedSize> bytes) noexcept
+        -> std::size_t
+    {
+        // Worked on as copies, which the byte stores below cannot alias
+        const TraceRecord current     = record;
+        const TraceRecord previous    = previous_;
+        const auto        next        = static_cast<std::uint16_t>(previous.pc + instructionLength[previous.opcode]);
+        const auto        delta       = current.cycle - previous.cycle;
+        const auto        instruction = Instruction(current.opcode, current.operand);
+        const bool        newCode     = code_[current.pc] != instruction;
+        previous_                     = record;
+        code_[current.pc]             = instruction;
+
+        std::uint8_t registerChanges = 0;
+        for (std::size_t index = 0; index < current.registers.size(); index++) {
+            registerChanges = static_cast<std::uint8_t>(
+                registerChanges | (current.registers[index] != previous.registers[index]) << index);
+        }
+        const auto changes = static_cast<std::uint8_t>((current.pc != next ? pcChanged : 0)
+            | (newCode ? codeChanged : 0) | (current.sp != previous.sp ? spChanged : 0)
+            | (current.flags != previous.flags ? flagsChanged : 0) | (registerChanges != 0 ? registersChanged : 0)
+            | (delta != instructionCycles[current.opcode] ? cyclesChanged : 0)
+            | (current.interrupt ? interruptEntry : 0));
+
+        std::size_t size = 0;
+        bytes[size++]    = changes;
+        if (changes & pcChanged) {
+            bytes[size++] = static_cast<std::uint8_t>(current.pc);
+            bytes[size++] = static_cast<std::uint8_t>(current.pc >> 8);
+        }
+        if (changes & codeChanged) {
+            // Both operand bytes are always written, only the instruction's own are kept
+            bytes[size++]   = current.opcode;
+            bytes[size]     = static_cast<std::uint8_t>(current.operand);
+            bytes[size + 1] = static_cast<std::uint8_t>(current.operand >> 8);
+            size += instructionLength[current.opcode] - 1U;
+        }
+        if (changes & spChanged) {
+            bytes[size++] = static_cast<std::uint8_t>(current.sp);
+            bytes[size++] = static_cast<std::uint8_t>(current.sp >> 8);
+        }
+        if (changes & flagsChanged) {
+            bytes[size++] = current.flags;
+        }
+        if (changes & registersChanged) {
+            bytes[size++] = registerChanges;
+            for (std::size_t index = 0; index < current.registers.size(); index++) {
+                bytes[size] = current.registers[index];
+                size += (registerChanges >> index) & 1U;
+            }
+        }
+        if (changes & cyclesChanged) {
+            for (std::uint64_t remaining = delta;; remaining >>= 7) {
+                if (remaining < 0x80) {
+                    bytes[size++] = static_cast<std::uint8_t>(remaining);
+                    break;
+                }
+                bytes[size++] = static_cast<std::uint8_t>(remaining | 0x80);
+            }
+        }
+        return size;
+    }
+
+    // Decodes the record at offset and advances offset past it, false if the bytes end in the middle of it.
+    // Operand bytes beyond the instruction's own decode as zero.
+    [[nodiscard]] auto Decode(const std::span<const std::uint8_t> bytes, std::size_t &offset, TraceRecord &record)
+        noexcept -> bool
+    {
+        std::size_t position = offset;
+        const auto  next     = [&]() -> int { return position < bytes.size() ? bytes[position++] : -1; };
+        const auto  word     = [&]() -> int {
+            const int low  = next();
+            const int high = next();
+            return low < 0 || high < 0 ? -1 : (high << 8 | low);
+        };
+
+        const auto fallThrough = static_cast<std::uint16_t>(previous_.pc + instructionLength[previous_.opcode]);
+        const int  changes     = next();
+        const int  pc          = (changes >= 0 && (changes & pcChanged)) ? word() : fallThrough;
+        record                 = previous_;
+        if (changes < 0 || pc < 0) {
+            return false;
+        }
+        record.pc                 = static_cast<std::uint16_t>(pc);
+        std::uint32_t instruction = code_[record.pc];
+        if (changes & codeChanged) {
+            const int opcode = next();
+            if (opcode < 0) {
+                return false;
+            }
+            int operand = 0;
+            for (std::uint8_t index = 1; index < instructionLength[static_cast<std::uint8_t>(opcode)]; index++) {
+                const int byte = next();
+                if (byte < 0) {
+                    return false;
+                }
+                operand |= byte << (8 * (index - 1));
+            }
+            instruction = Instruction(static_cast<std::uint8_t>(opcode), static_cast<std::uint16_t>(operand));
+        } else if (instruction == noInstruction) {
+            return false;
+        }
+        record.opcode    = static_cast<std::uint8_t>(instruction);
+        record.operand   = static_cast<std::uint16_t>(instruction >> 8);
+        record.interrupt = (changes & interruptEntry) != 0;
+        if (changes & spChanged) {
+            const int sp = word();
+            if (sp < 0) {
+                return false;
+            }
+            record.sp = static_cast<std::uint16_t>(sp);
+        }
+        if (changes & flagsChanged) {
+            const int flags = next();
+            if (flags < 0) {
+                return false;
+            }
+            record.flags = static_cast<std::uint8_t>(flags);
+        }
+        if (changes & registersChanged) {
+            const int registerChanges = next();
+            if (registerChanges < 0) {
+                return false;
+            }
+            for (std::size_t index = 0; index < record.registers.size(); index++) {
+                if (registerChanges & (1 << index)) {
+                    const int value = next();
+                    if (value < 0) {
+                        return false;
+                    }
+                    record.registers[index] = static_cast<std::uint8_t>(value);
+                }
+            }
+        }
+        std::uint64_t delta = instructionCycles[record.opcode];
+        if (changes & cyclesChanged) {
+            delta = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const int byte = next();
+                if (byte < 0 || shift > 63) {
+                    return false;
+                }
+                delta |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+        }
+        record.cycle     = previous_.cycle + delta;
+        previous_        = record;
+        code_[record.pc] = instruction;
+        offset           = position;
+        return true;
+    }
+
+private: // Functions/Methods
+    // Opcode in the low byte, the instruction's own operand bytes above it
+    [[nodiscard]] static auto Instruction(const std::uint8_t opcode, const std::uint16_t operand) noexcept
+        -> std::uint32_t
+    {
+        static constexpr std::array<std::uint32_t, 4> operandMask = { 0x0000, 0x0000, 0x00FF, 0xFFFF };
+        return opcode | (operand & operandMask[instructionLength[opcode]]) << 8;
+    }
+
+public:  // Data Members
+private: // Data Members
+    static constexpr std::uint8_t  pcChanged        = 0x01;
+    static constexpr std::uint8_t  spChanged        = 0x02;
+    static constexpr std::uint8_t  flagsChanged     = 0x04;
+    static constexpr std::uint8_t  registersChanged = 0x08;
+    static constexpr std::uint8_t  cyclesChanged    = 0x10;
+    static constexpr std::uint8_t  codeChanged      = 0x20;
+    static constexpr std::uint8_t  interruptEntry   = 0x40;
+    static constexpr std::uint32_t noInstruction    = 0xFFFFFFFF;
+
+    TraceRecord                previous_;
+    std::vector<std::uint32_t> code_; // Instruction last executed at each address
+};
+
+// Layout of a trace file: a 32 byte header (magic, version, record count) followed by the zlib stream of the
+// delta encoded records
+struct TraceFile {
+    static constexpr std::array<char, 8> magic             = { 'i', '8', '0', '8', '5', 't', 'r', 'c' };
+    static constexpr std::uint32_t       version           = 1;
+    static constexpr std::size_t         versionOffset     = 0x08;
+    static constexpr std::size_t         recordCountOffset = 0x10;
+    static constexpr std::size_t         headerSize        = 0x20;
+};
+
+// Records every instruction a Processor executes into a trace file, plugged in as the Processor's Profiler.
+// The executing thread only copies a fixed size record into a lock-free ring. A background thread drains the
+// ring in batches, delta encodes and deflates the records and writes them out, so the cost of encoding,
+// compression and I/O stays off the executing thread unless the writer falls a whole ring behind.
+class ExecutionTracer {
+public: // Functions/Methods
+    static constexpr bool enabled = true;
+
+    ExecutionTracer() = default;
+
+    ExecutionTracer(const ExecutionTracer &)                     = delete;
+    auto operator=(const ExecutionTracer &) -> ExecutionTracer & = delete;
+
+    ~ExecutionTracer() { (void)Close(); }
+
+    // Starts tracing into a new file, nothing is recorded until then
+    [[nodiscard]] auto Open(const std::string &filename) noexcept -> bool
+    {
+        if (!Close()) {
+            return false;
+        }
+        file_.open(filename, std::ios::binary | std::ios::trunc);
+        std::array<std::uint8_t, TraceFile::headerSize> header {};
+        std::memcpy(header.data(), TraceFile::magic.data(), TraceFile::magic.size());
+        StoreLittleEndian<std::uint32_t>(header, TraceFile::versionOffset, TraceFile::version);
+        file_.write(reinterpret_cast<const char *>(header.data()), header.size());
+        if (!file_ || deflateInit(&stream_, Z_BEST_SPEED) != Z_OK) {
+            spdlog::error("Could not open the trace file {}", filename);
+            file_.close();
+            return false;
+        }
+        filename_    = filename;
+        recordCount_ = 0;
+        failed_      = false;
+        stopping_.store(false, std::memory_order_relaxed);
+        ring_   = std::make_unique<Ring>();
+        writer_ = std::thread([this] { WriterLoop(); });
+        return true;
+    }
+
+    // Flushes everything recorded and completes the file, returns false if any of it could not be written
+    [[nodiscard]] auto Close() noexcept -> bool
+    {
+        if (ring_ == nullptr) {
+            return true;
+        }
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+        ring_ = nullptr;
+
+        std::array<std::uint8_t, 8> count {};
+        StoreLittleEndian<std::uint64_t>(count, 0, recordCount_);
+        file_.seekp(TraceFile::recordCountOffset);
+        file_.write(reinterpret_cast<const char *>(count.data()), count.size());
+        file_.close();
+        if (failed_ || !file_) {
+            spdlog::error("Could not write the trace file {}", filename_);
+            return false;
+        }
+        return true;
+    }
+
+    auto Record(const std::uint16_t pc, const std::uint8_t opcode, const std::uint16_t operand,
+        const std::uint32_t /*cycles*/, const std::uint16_t /*sp*/, const ProcessorState &state) noexcept -> void
+    {
+        if (ring_ == nullptr) {
+            return;
+        }
+        TraceRecord record;
+        record.cycle   = state.cycles;
+        record.pc      = pc;
+        record.sp      = state.registers.GetSp();
+        record.operand = operand;
+        record.opcode  = opcode;
+        record.flags   = state.status.GetFlags();
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            record.registers[code] = state.registers.Get(code);
+        }
+        record.registers[6] = state.registers.GetAccumulator();
+        record.interrupt    = std::exchange(interruptPending_, false);
+        ring_->Push(record);
+    }
+
+    // Marks the next record as the first instruction of the interrupt service routine
+    auto Interrupt(const std::uint16_t /*returnAddress*/, const std::uint16_t /*vector*/,
+        const std::uint32_t /*cycles*/) noexcept -> void
+    {
+        interruptPending_ = ring_ != nullptr;
+    }
+
+private: // Functions/Methods
+    auto WriterLoop() noexcept -> void
+    {
+        std::vector<TraceRecord>  batch(batchSize);
+        std::vector<std::uint8_t> encoded(flushSize + batchSize * TraceCodec::maxEncodedSize);
+        std::size_t               size = 0;
+        TraceCodec                codec;
+        while (true) {
+            // Checked before draining, everything pushed before Close() is seen by the drain that follows
+            const bool        stopping = stopping_.load(std::memory_order_acquire);
+            const std::size_t count    = ring_->Pop(batch);
+            for (std::size_t index = 0; index < count; index++) {
+                const auto free = std::span(encoded).subspan(size);
+                size += codec.Encode(batch[index], free.first<TraceCodec::maxEncodedSize>());
+            }
+            recordCount_ += count;
+            if (size >= flushSize || (stopping && count == 0)) {
+                Deflate(std::span(encoded).first(size), stopping && count == 0);
+                size = 0;
+            }
+            if (count == 0) {
+                if (stopping) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        deflateEnd(&stream_);
+    }
+
+    auto Deflate(const std::span<std::uint8_t> input, const bool finish) noexcept -> void
+    {
+        std::array<std::uint8_t, 0x10000> output {};
+        stream_.next_in  = input.data();
+        stream_.avail_in = static_cast<uInt>(input.size());
+        int result       = Z_OK;
+        do {
+            stream_.next_out  = output.data();
+            stream_.avail_out = static_cast<uInt>(output.size());
+            result            = deflate(&stream_, finish ? Z_FINISH : Z_NO_FLUSH);
+            file_.write(reinterpret_cast<const char *>(output.data()),
+                static_cast<std::streamsize>(output.size() - stream_.avail_out));
+        } while (stream_.avail_out == 0 || (finish && result == Z_OK));
+        if (!file_ || result == Z_STREAM_ERROR) {
+            failed_ = true;
+        }
+    }
+
+public:  // Data Members
+private: // Data Members
+    using Ring = SpscRing<TraceRecord, 0x10000>;
+
+    static constexpr std::size_t batchSize = 0x1000;
+    static constexpr std::size_t flushSize = 0x40000;
+
+    std::unique_ptr<Ring> ring_;
+    std::thread           writer_;
+    std::atomic<bool>     stopping_ { false };
+    bool                  interruptPending_ = false;
+
+    // Owned by the writer thread while tracing
+    std::ofstream file_;
+    z_stream      stream_ {};
+    std::uint64_t recordCount_ = 0;
+    bool          failed_      = false;
+    std::string   filename_;
+};
+
+// Reads a trace file back one record at a time, inflating it in chunks
+class TraceReader {
+public: // Functions/Methods
+    TraceReader() = default;
+
+    TraceReader(const TraceReader &)                     = delete;
+    auto operator=(const TraceReader &) -> TraceReader & = delete;
+
+    ~TraceReader()
+    {
+        if (streamOpen_) {
+            inflateEnd(&stream_);
+        }
+    }
+
+    [[nodiscard]] auto Open(const std::string &filename) noexcept -> bool
+    {
+        file_.open(filename, std::ios::binary);
+        std::array<std::uint8_t, TraceFile::headerSize> header {};
+        if (!file_.read(reinterpret_cast<char *>(header.data()), header.size())
+            || std::memcmp(header.data(), TraceFile::magic.data(), TraceFile::magic.size()) != 0
+            || LoadLittleEndian<std::uint32_t>(header, TraceFile::versionOffset) != TraceFile::version) {
+            spdlog::error("{} is not a valid trace file", filename);
+            return false;
+        }
+        recordCount_ = LoadLittleEndian<std::uint64_t>(header, TraceFile::recordCountOffset);
+        streamOpen_  = inflateInit(&stream_) == Z_OK;
+        return streamOpen_;
+    }
+
+    // Record count from the header, zero if tracing did not complete
+    [[nodiscard]] auto GetRecordCount() const noexcept -> std::uint64_t { return recordCount_; }
+
+    // False at the end of the trace, or where it is truncated or corrupt
+    [[nodiscard]] auto Next(TraceRecord &record) noexcept -> bool
+    {
+        if (decoded_.size() - position_ < TraceCodec::maxEncodedSize && !streamEnd_) {
+            Fill();
+        }
+        return position_ < decoded_.size() && codec_.Decode(decoded_, position_, record);
+    }
+
+    // e.g. "      1234  1005  CD 10 10  CALL      A=00 B=03 C=00 D=10 E=00 H=00 L=00 F=44 SP=EFFE", followed by
+    // "  <interrupt>" on the first instruction of an interrupt service routine
+    [[nodiscard]] static auto Format(const TraceRecord &record) -> std::string
+    {
+        std::string bytes = fmt::format("{:02X}", record.opcode);
+        for (std::uint8_t index = 1; index < instructionLength[record.opcode]; index++) {
+            bytes += fmt::format(" {:02X}", static_cast<std::uint8_t>(record.operand >> (8 * (index - 1))));
+        }
+        const auto &r = record.registers;
+        return fmt::format("{:>12}  {:04X}  {:<8}  {:<9} A={:02X} B={:02X} C={:02X} D={:02X} E={:02X} H={:02X} "
+                           "L={:02X} F={:02X} SP={:04X}{}",
+            record.cycle, record.pc, bytes, instructionMnemonic[record.opcode], r[6], r[0], r[1], r[2], r[3], r[4],
+            r[5], record.flags, record.sp, record.interrupt ? "  <interrupt>" : "");
+    }
+
+private: // Functions/Methods
+    auto Fill() noexcept -> void
+    {
+        decoded_.erase(decoded_.begin(), decoded_.begin() + static_cast<std::ptrdiff_t>(position_));
+        position_ = 0;
+        while (decoded_.size() < chunkSize && !streamEnd_) {
+            if (stream_.avail_in == 0) {
+                file_.read(reinterpret_cast<char *>(input_.data()), static_cast<std::streamsize>(input_.size()));
+                if (file_.gcount() == 0) {
+                    streamEnd_ = true;
+                    break;
+                }
+                stream_.next_in  = input_.data();
+                stream_.avail_in = static_cast<uInt>(file_.gcount());
+            }
+            const std::size_t used = decoded_.size();
+            decoded_.resize(used + chunkSize);
+            stream_.next_out  = decoded_.data() + used;
+            stream_.avail_out = static_cast<uInt>(chunkSize);
+            const int result  = inflate(&stream_, Z_NO_FLUSH);
+            decoded_.resize(used + chunkSize - stream_.avail_out);
+            if (result != Z_OK) {
+                streamEnd_ = true;
+            }
+        }
+    }
+
+public:  // Data Members
+private: // Data Members
+    static constexpr std::size_t chunkSize = 0x10000;
+
+    std::ifstream                     file_;
+    z_stream                          stream_ {};
+    bool                              streamOpen_ = false;
+    bool                              streamEnd_  = false;
+    std::array<std::uint8_t, 0x10000> input_ {};
+    std::vector<std::uint8_t>         decoded_;
+    std::size_t                       position_    = 0;
+    std::uint64_t                     recordCount_ = 0;
+    TraceCodec                        codec_;
+};
+
+} // namespace intel_8085
+
+#endif
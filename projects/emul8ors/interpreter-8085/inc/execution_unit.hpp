@@ -1,15 +1,924 @@
 #ifndef INTERPRETER_8085_EXECUTION_UNIT_HPP
 #define INTERPRETER_8085_EXECUTION_UNIT_HPP
 
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
 #include "spdlog/spdlog.h"
 
+#include "block_cache.hpp"
+#include "control_flow_graph.hpp"
+#include "instruction_set.hpp"
+#include "jit_compiler.hpp"
+#include "processor_state.hpp"
+
+// Direct-threaded dispatch relies on the labels-as-values extension of GCC and Clang
+#if defined(__GNUC__) && !defined(INTERPRETER_8085_NO_COMPUTED_GOTO)
+#define INTERPRETER_8085_HAS_COMPUTED_GOTO 1
+#else
+#define INTERPRETER_8085_HAS_COMPUTED_GOTO 0
+#endif
+
+// Expands X(hi, lo) for every opcode 0x00 - 0xFF, hi and lo being its hex digits
+#define INTERPRETER_8085_OPCODES_16(X, hi)                                                                             \
+    X(hi, 0) X(hi, 1) X(hi, 2) X(hi, 3) X(hi, 4) X(hi, 5) X(hi, 6) X(hi, 7) X(hi, 8) X(hi, 9) X(hi, A) X(hi, B)        \
+        X(hi, C) X(hi, D) X(hi, E) X(hi, F)
+#define INTERPRETER_8085_OPCODES_256(X)                                                                                \
+    INTERPRETER_8085_OPCODES_16(X, 0) INTERPRETER_8085_OPCODES_16(X, 1) INTERPRETER_8085_OPCODES_16(X, 2)              \
+    INTERPRETER_8085_OPCODES_16(X, 3) INTERPRETER_8085_OPCODES_16(X, 4) INTERPRETER_8085_OPCODES_16(X, 5)              \
+    INTERPRETER_8085_OPCODES_16(X, 6) INTERPRETER_8085_OPCODES_16(X, 7) INTERPRETER_8085_OPCODES_16(X, 8)              \
+    INTERPRETER_8085_OPCODES_16(X, 9) INTERPRETER_8085_OPCODES_16(X, A) INTERPRETER_8085_OPCODES_16(X, B)              \
+    INTERPRETER_8085_OPCODES_16(X, C) INTERPRETER_8085_OPCODES_16(X, D) INTERPRETER_8085_OPCODES_16(X, E)              \
+    INTERPRETER_8085_OPCODES_16(X, F)
+
 namespace intel_8085 {
 
+// Table   - indirect call through the handler table from a central loop
+// Switch  - portable switch over all opcodes with the handlers inlined into the cases
+// Threaded - every handler jumps straight to the next opcode's handler (GCC/Clang only)
+// Cached  - runs pre-decoded basic blocks from the BlockCache, common instruction sequences fused into one handler
+// Jit     - like Cached, hot blocks are translated to x86-64 code (x86-64 Linux only)
+enum class DispatchMode : std::uint8_t { Table, Switch, Threaded, Cached, Jit };
+
+constexpr DispatchMode defaultDispatchMode = DispatchMode::Cached;
+
+// Why the last run ended early, if it was for the debugger
+enum class DebugStop : std::uint8_t { None, Breakpoint, Watchpoint };
+
+[[nodiscard]] constexpr auto ParseDispatchMode(const std::string_view name) noexcept -> std::optional<DispatchMode>
+{
+    if (name == "table") {
+        return DispatchMode::Table;
+    }
+    if (name == "switch") {
+        return DispatchMode::Switch;
+    }
+    if (name == "threaded" && INTERPRETER_8085_HAS_COMPUTED_GOTO) {
+        return DispatchMode::Threaded;
+    }
+    if (name == "cached") {
+        return DispatchMode::Cached;
+    }
+    if (name == "jit" && INTERPRETER_8085_HAS_JIT) {
+        return DispatchMode::Jit;
+    }
+    return std::nullopt;
+}
+
+// Fetches, decodes and executes instructions on a ProcessorState.
+// Every opcode is handled by an instantiation of Execute<Opcode>, which picks the operation from the
+// bit groups described in doc/InstructionDecodeLogic.md at compile time. The 256 instantiations make up
+// the dispatch table, so decoding at runtime is a single indexed jump in every DispatchMode.
 class ExecutionUnit {
-public:  // Functions/Methods
+public: // Functions/Methods
+    using Handler = OpcodeHandler;
+
+    // Step()
+    static auto Step(ProcessorState &state) noexcept -> void
+    {
+        std::uint16_t operand = 0;
+        (void)Step(state, operand);
+    }
+
+    // Returns the opcode executed and its operand as fetched, before the instruction could overwrite it
+    static auto Step(ProcessorState &state, std::uint16_t &operand) noexcept -> std::uint8_t
+    {
+        const std::uint8_t opcode = Fetch(state, operand);
+        handlers_[opcode](state, operand);
+        return opcode;
+    }
+
+    // Run()
+    // Executes until HLT, a stop request or until the cycle budget is used up, returns the number of instructions
+    // executed. Accepting interrupts is up to the caller.
+    auto Run(ProcessorState &state, std::uint64_t cycleBudget = std::numeric_limits<std::uint64_t>::max()) noexcept
+        -> std::uint64_t
+    {
+        const std::uint64_t endCycle = CycleLimit(state, cycleBudget);
+        state.stopRequested          = state.halted;
+        if (blockCache_.HasBreakpoints() || state.memory.HasWatchpoints()) [[unlikely]] {
+            return RunDebug(state, endCycle);
+        }
+        switch (dispatchMode_) {
+        case DispatchMode::Switch:
+            return RunSwitch(state, endCycle);
+        case DispatchMode::Threaded:
+            return RunThreaded(state, endCycle);
+        case DispatchMode::Cached:
+            return RunCached<false>(state, endCycle);
+        case DispatchMode::Jit:
+            return RunCached<INTERPRETER_8085_HAS_JIT>(state, endCycle);
+        default:
+            return RunTable(state, endCycle);
+        }
+    }
+
+    [[nodiscard]] auto GetDispatchMode() const noexcept -> DispatchMode { return dispatchMode_; }
+
+    auto SetDispatchMode(const DispatchMode dispatchMode) noexcept -> void
+    {
+        if (dispatchMode == DispatchMode::Threaded && !INTERPRETER_8085_HAS_COMPUTED_GOTO) {
+            dispatchMode_ = DispatchMode::Switch;
+        } else if (dispatchMode == DispatchMode::Jit && !INTERPRETER_8085_HAS_JIT) {
+            dispatchMode_ = DispatchMode::Cached;
+        } else {
+            dispatchMode_ = dispatchMode;
+        }
+    }
+
+    // Must be called whenever memory is written to behind the ExecutionUnit's back, e.g. by the ProgramLoader
+    auto FlushCaches(SystemMemory &memory) noexcept -> void { blockCache_.Flush(memory); }
+
+    // Decodes every block of the graph ahead of the first run in the Cached and Jit modes, and in Jit mode translates
+    // the loop heads right away rather than after they warmed up. Other modes do not keep decoded blocks.
+    auto Prebuild(ProcessorState &state, const ControlFlowGraph &graph) noexcept -> void
+    {
+        if (dispatchMode_ != DispatchMode::Cached && dispatchMode_ != DispatchMode::Jit) {
+            return;
+        }
+        if (state.memory.HasDirtyCode()) {
+            blockCache_.Invalidate(state.memory);
+        }
+        for (const BasicBlock &basicBlock : graph.GetBlocks()) {
+            if (!BlockCache::IsCacheable(state.memory, basicBlock.startAddress)) {
+                continue;
+            }
+            DecodedBlock &block = blockCache_.Lookup(state.memory, basicBlock.startAddress, handlers_,
+                superinstructions_);
+#if INTERPRETER_8085_HAS_JIT
+            if (dispatchMode_ == DispatchMode::Jit && basicBlock.loopHead && block.native == nullptr
+                && block.executions < JitCompiler::threshold && !blockCache_.IsSelfModifying(block)) {
+                Translate(block);
+                // Counted as warmed up, so that a block the JIT could not translate is not tried again
+                block.executions = JitCompiler::threshold;
+            }
+#else
+            (void)block;
+#endif
+        }
+    }
+
+    [[nodiscard]] static auto GetHandler(const std::uint8_t opcode) noexcept -> Handler { return handlers_[opcode]; }
+
+    [[nodiscard]] static auto GetSuperinstructions() noexcept -> std::span<const Superinstruction>
+    {
+        return superinstructions_;
+    }
+
+    // Breakpoints
+    // Run() stops before executing the instruction at a breakpoint, except at the address given to the last
+    // StepOverBreakpoint(), so that a run can continue from the breakpoint it stopped at
+    auto SetBreakpoint(SystemMemory &memory, const std::uint16_t address) noexcept -> void
+    {
+        blockCache_.SetBreakpoint(memory, address);
+    }
+
+    auto ClearBreakpoint(SystemMemory &memory, const std::uint16_t address) noexcept -> void
+    {
+        blockCache_.ClearBreakpoint(memory, address);
+    }
+
+    [[nodiscard]] auto HasBreakpoint(const std::uint16_t address) const noexcept -> bool
+    {
+        return blockCache_.HasBreakpoint(address);
+    }
+
+    // Applies until the next block boundary, i.e. to the first instruction of the next run only
+    auto StepOverBreakpoint(const std::uint16_t address) noexcept -> void { stepOver_ = address; }
+
+    [[nodiscard]] auto GetDebugStop() const noexcept -> DebugStop { return debugStop_; }
+
+    auto ClearDebugStop() noexcept -> void { debugStop_ = DebugStop::None; }
+
 private: // Functions/Methods
+    [[nodiscard]] static auto CycleLimit(const ProcessorState &state, const std::uint64_t cycleBudget) noexcept
+        -> std::uint64_t
+    {
+        constexpr std::uint64_t maxCycle = std::numeric_limits<std::uint64_t>::max();
+        return cycleBudget > maxCycle - state.cycles ? maxCycle : state.cycles + cycleBudget;
+    }
+
+    // Reads the instruction at PC, advances PC past it and accounts its cycles
+    [[nodiscard]] static auto Fetch(ProcessorState &state, std::uint16_t &operand) noexcept -> std::uint8_t
+    {
+        const std::uint16_t pc     = state.registers.GetPc();
+        const std::uint8_t  opcode = state.memory.Fetch(pc);
+        operand                    = state.memory.FetchOperand(pc, instructionLength[opcode]);
+        state.registers.SetPc(static_cast<std::uint16_t>(pc + instructionLength[opcode]));
+        state.cycles += instructionCycles[opcode];
+        return opcode;
+    }
+
+    // Only HLT, the illegal opcodes, those which may make an interrupt deliverable and stores, which may reach a
+    // device raising an interrupt or scheduling an event, request a stop. The check is compiled out for every other
+    // handler.
+    [[nodiscard]] static constexpr auto CanStop(const std::uint8_t opcode) noexcept -> bool
+    {
+        return opcode == static_cast<std::uint8_t>(opcodes::HLT) || !IsValidOpcode(opcode)
+            || opcode == static_cast<std::uint8_t>(opcodes::EI) || opcode == static_cast<std::uint8_t>(opcodes::SIM)
+            || opcode == static_cast<std::uint8_t>(opcodes::IN) || opcode == static_cast<std::uint8_t>(opcodes::OUT)
+            || WritesMemory(opcode);
+    }
+
+    static auto RunTable(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+        std::uint64_t executed = 0;
+        while (!state.stopRequested && state.cycles < endCycle) {
+            Step(state);
+            executed++;
+        }
+        return executed;
+    }
+
+    static auto RunSwitch(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+        std::uint64_t executed = 0;
+        while (!state.stopRequested && state.cycles < endCycle) {
+            std::uint16_t operand = 0;
+            switch (Fetch(state, operand)) {
+#define INTERPRETER_8085_SWITCH_CASE(hi, lo)                                                                           \
+    case 0x##hi##lo:                                                                                                   \
+        Execute<0x##hi##lo>(state, operand);                                                                           \
+        break;
+                INTERPRETER_8085_OPCODES_256(INTERPRETER_8085_SWITCH_CASE)
+#undef INTERPRETER_8085_SWITCH_CASE
+            }
+            executed++;
+        }
+        return executed;
+    }
+
+    template <bool UseJit>
+    auto RunCached(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+        std::uint64_t executed = 0;
+        while (!state.stopRequested && state.cycles < endCycle) {
+            if (state.memory.HasDirtyCode()) {
+                blockCache_.Invalidate(state.memory);
+            }
+            if (!BlockCache::IsCacheable(state.memory, state.registers.GetPc())) [[unlikely]] {
+                Step(state);
+                executed++;
+                continue;
+            }
+            DecodedBlock &block = blockCache_.Lookup(state, handlers_, superinstructions_);
+            if (block.delayLoop != DelayLoop::None) {
+                executed += SkipDelayLoop(state, block, endCycle);
+            }
+#if INTERPRETER_8085_HAS_JIT
+            if constexpr (UseJit) {
+                if (block.native == nullptr && ++block.executions == JitCompiler::threshold
+                    && !blockCache_.IsSelfModifying(block)) {
+                    Translate(block);
+                }
+                // Native code checks the budget only when it loops, so the whole block has to fit
+                if (block.native != nullptr && state.cycles + block.cycles < endCycle) {
+                    jitContext_.Load(state, endCycle);
+                    block.native(&jitContext_);
+                    jitContext_.Store(state);
+                    executed += jitContext_.executed;
+                    continue;
+                }
+            }
+#endif
+            // Budget checks are only needed for the block which crosses the end of the budget, every other block runs
+            // its superinstructions
+            if (state.cycles + block.cycles < endCycle) {
+                for (const MicroOp &microOp : block.fusedOps.empty() ? block.microOps : block.fusedOps) {
+                    state.registers.SetPc(microOp.nextPc);
+                    state.cycles += microOp.cycles;
+                    microOp.handler(state, microOp.operand);
+                    executed += microOp.instructions;
+                    // Stop if the block overwrote code, possibly its own remaining micro-ops, or wrote to a device
+                    // which requested a stop. Stores are always the last instruction of a superinstruction.
+                    if (state.memory.HasDirtyCode() || state.stopRequested) {
+                        break;
+                    }
+                }
+                continue;
+            }
+            for (const MicroOp &microOp : block.microOps) {
+                state.registers.SetPc(microOp.nextPc);
+                state.cycles += microOp.cycles;
+                microOp.handler(state, microOp.operand);
+                executed++;
+                if (state.memory.HasDirtyCode() || state.stopRequested || state.cycles >= endCycle) {
+                    break;
+                }
+            }
+        }
+        return executed;
+    }
+
+    // Runs the blocks like Cached while any breakpoint or watchpoint is armed, whatever the dispatch mode. Native code
+    // and delay loop skipping are left out, both would run past a watched access. Breakpoints only need checking at
+    // block boundaries, as the BlockCache ends blocks before them, watchpoints are checked after every instruction.
+    auto RunDebug(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+        std::uint64_t executed = 0;
+        while (!state.stopRequested && state.cycles < endCycle) {
+            if (state.memory.HasDirtyCode()) {
+                blockCache_.Invalidate(state.memory);
+            }
+            const std::uint16_t pc = state.registers.GetPc();
+            if (blockCache_.HasBreakpoint(pc) && pc != stepOver_) {
+                debugStop_ = DebugStop::Breakpoint;
+                break;
+            }
+            // e.g. the stack writes when an interrupt was accepted
+            if (state.memory.HasWatchHit()) {
+                debugStop_ = DebugStop::Watchpoint;
+                break;
+            }
+            stepOver_ = noAddress;
+
+            if (!BlockCache::IsCacheable(state.memory, pc)) [[unlikely]] {
+                Step(state);
+                executed++;
+                if (state.memory.HasWatchHit()) {
+                    debugStop_ = DebugStop::Watchpoint;
+                    break;
+                }
+                continue;
+            }
+            DecodedBlock &block = blockCache_.Lookup(state, handlers_, superinstructions_);
+            for (const MicroOp &microOp : block.microOps) {
+                state.registers.SetPc(microOp.nextPc);
+                state.cycles += microOp.cycles;
+                microOp.handler(state, microOp.operand);
+                executed++;
+                if (state.memory.HasWatchHit()) {
+                    debugStop_ = DebugStop::Watchpoint;
+                    return executed;
+                }
+                if (state.memory.HasDirtyCode() || state.stopRequested || state.cycles >= endCycle) {
+                    break;
+                }
+            }
+        }
+        return executed;
+    }
+
+    // Accounts all but the last of the iterations left to a delay loop at once, as many as fit into the budget.
+    // The iteration left over runs through the micro-ops, so that A and the flags come out exactly as if every
+    // iteration had: the skipped ones only leave the counter and the cycle count behind, the rest is overwritten.
+    // Returns the number of instructions skipped.
+    static auto SkipDelayLoop(ProcessorState &state, const DecodedBlock &block, const std::uint64_t endCycle) noexcept
+        -> std::uint64_t
+    {
+        constexpr auto jnz             = static_cast<std::uint8_t>(opcodes::JNZ);
+        const auto     iterationCycles = block.cycles + instructionCyclesTaken[jnz] - instructionCycles[jnz];
+        const auto     high            = static_cast<std::uint8_t>(block.loopCounter * 2);
+
+        std::uint32_t counter = 0;
+        if (block.delayLoop == DelayLoop::Decrement) {
+            counter = state.registers.Get(block.loopCounter);
+            counter = counter == 0 ? 0x100 : counter;
+        } else {
+            counter = static_cast<std::uint32_t>(
+                state.registers.Get(high) << 8 | state.registers.Get(static_cast<std::uint8_t>(high + 1)));
+            counter = counter == 0 ? 0x10000 : counter;
+        }
+        const std::uint64_t iterations = std::min<std::uint64_t>(counter, (endCycle - state.cycles) / iterationCycles);
+        if (iterations < 2) {
+            return 0;
+        }
+
+        const auto skipped = static_cast<std::uint32_t>(iterations - 1);
+        counter -= skipped;
+        if (block.delayLoop == DelayLoop::Decrement) {
+            state.registers.Set(block.loopCounter, static_cast<std::uint8_t>(counter));
+        } else {
+            state.registers.Set(high, static_cast<std::uint8_t>(counter >> 8));
+            state.registers.Set(static_cast<std::uint8_t>(high + 1), static_cast<std::uint8_t>(counter));
+        }
+        state.cycles += skipped * iterationCycles;
+        return skipped * block.microOps.size();
+    }
+
+#if INTERPRETER_8085_HAS_JIT
+    auto Translate(DecodedBlock &block) noexcept -> void
+    {
+        if (jitCompiler_.IsFull()) {
+            blockCache_.DropNativeCode();
+            jitCompiler_.Reset();
+        }
+        block.native = jitCompiler_.Compile(block);
+    }
+#endif
+
+#if INTERPRETER_8085_HAS_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    static auto RunThreaded(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+#define INTERPRETER_8085_LABEL_ADDRESS(hi, lo) &&opcode_##hi##lo,
+        static const void *const labels[0x100] = { INTERPRETER_8085_OPCODES_256(INTERPRETER_8085_LABEL_ADDRESS) };
+#undef INTERPRETER_8085_LABEL_ADDRESS
+
+        std::uint64_t executed = 0;
+        std::uint16_t operand  = 0;
+
+#define INTERPRETER_8085_DISPATCH()                                                                                    \
+    do {                                                                                                               \
+        if (state.cycles >= endCycle) {                                                                                \
+            return executed;                                                                                           \
+        }                                                                                                              \
+        executed++;                                                                                                    \
+        goto *labels[Fetch(state, operand)];                                                                           \
+    } while (false)
+
+#define INTERPRETER_8085_THREADED_HANDLER(hi, lo)                                                                      \
+    opcode_##hi##lo : Execute<0x##hi##lo>(state, operand);                                                             \
+    if (CanStop(0x##hi##lo) && state.stopRequested) {                                                                  \
+        return executed;                                                                                               \
+    }                                                                                                                  \
+    INTERPRETER_8085_DISPATCH();
+
+        if (state.stopRequested) {
+            return executed;
+        }
+        INTERPRETER_8085_DISPATCH();
+        INTERPRETER_8085_OPCODES_256(INTERPRETER_8085_THREADED_HANDLER)
+
+#undef INTERPRETER_8085_THREADED_HANDLER
+#undef INTERPRETER_8085_DISPATCH
+    }
+#pragma GCC diagnostic pop
+#else
+    static auto RunThreaded(ProcessorState &state, const std::uint64_t endCycle) noexcept -> std::uint64_t
+    {
+        return RunSwitch(state, endCycle);
+    }
+#endif
+
+    template <std::size_t... Opcodes>
+    [[nodiscard]] static constexpr auto MakeHandlerTable(std::index_sequence<Opcodes...>) noexcept
+        -> std::array<Handler, sizeof...(Opcodes)>
+    {
+        return { &Execute<static_cast<std::uint8_t>(Opcodes)>... };
+    }
+
+    template <std::uint8_t... Opcodes>
+    static auto ExecuteFused(ProcessorState &state, const std::uint16_t operand) noexcept -> void
+    {
+        (Execute<Opcodes>(state, operand), ...);
+    }
+
+    template <opcodes... Opcodes>
+    [[nodiscard]] static constexpr auto Fuse() noexcept -> Superinstruction
+    {
+        static_assert(((instructionLength[static_cast<std::uint8_t>(Opcodes)] > 1 ? 1 : 0) + ...) <= 1,
+            "Only one instruction of a superinstruction may take operand bytes");
+        return { { static_cast<std::uint8_t>(Opcodes)... }, sizeof...(Opcodes),
+            &ExecuteFused<static_cast<std::uint8_t>(Opcodes)...> };
+    }
+
+    template <std::uint8_t Opcode>
+    static auto Execute(ProcessorState &state, const std::uint16_t operand) noexcept -> void
+    {
+        constexpr std::uint8_t high3 = DestinationField(Opcode);
+        constexpr std::uint8_t low3  = SourceField(Opcode);
+        constexpr std::uint8_t pair  = RegisterPairField(Opcode);
+
+        if constexpr (!IsValidOpcode(Opcode)) {
+            Illegal(state, Opcode);
+        } else if constexpr (OpcodeGroup(Opcode) == 0b01) {
+            if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::HLT)) {
+                state.halted        = true;
+                state.stopRequested = true;
+            } else {
+                Mov<high3, low3>(state);
+            }
+        } else if constexpr (OpcodeGroup(Opcode) == 0b10) {
+            Alu<high3>(state, GetOperand<low3>(state));
+        } else if constexpr (OpcodeGroup(Opcode) == 0b00) {
+            ExecuteGroup00<Opcode, high3, low3, pair>(state, operand);
+        } else {
+            ExecuteGroup11<Opcode, high3, low3, pair>(state, operand);
+        }
+    }
+
+    template <std::uint8_t Opcode, std::uint8_t High3, std::uint8_t Low3, std::uint8_t Pair>
+    static auto ExecuteGroup00(ProcessorState &state, const std::uint16_t operand) noexcept -> void
+    {
+        if constexpr (Low3 == 0b100) {
+            Increment<High3>(state);
+        } else if constexpr (Low3 == 0b101) {
+            Decrement<High3>(state);
+        } else if constexpr (Low3 == 0b110) {
+            SetOperand<High3>(state, static_cast<std::uint8_t>(operand));
+        } else if constexpr (Low3 == 0b111) {
+            Accumulator<High3>(state);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::NOP)) {
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::RIM)) {
+            // Serial input data (bit 7) always reads 0
+            state.registers.SetAccumulator(static_cast<std::uint8_t>((state.interruptRequests & 0x07) << 4
+                | (state.interruptsEnabled ? 0x08 : 0x00) | state.interruptMask));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::SIM)) {
+            // Bit 3 enables setting the masks, bit 4 resets RST 7.5, serial output (bits 6 and 7) goes nowhere
+            const std::uint8_t control = state.registers.GetAccumulator();
+            if (control & 0x08) {
+                state.interruptMask = control & 0x07;
+            }
+            if (control & 0x10) {
+                state.interruptRequests &= static_cast<std::uint8_t>(~static_cast<std::uint8_t>(InterruptLine::Rst75));
+            }
+            if (state.interruptRequests != 0) {
+                state.stopRequested = true;
+            }
+        } else if constexpr ((Opcode & 0x0F) == 0x01) { // LXI
+            SetPair<Pair>(state, operand);
+        } else if constexpr ((Opcode & 0x0F) == 0x09) { // DAD
+            const std::uint32_t sum = std::uint32_t { GetPair<0b10>(state) } + GetPair<Pair>(state);
+            SetPair<0b10>(state, static_cast<std::uint16_t>(sum));
+            SetFlag(state.status, StatusRegister::carryFlag, sum > 0xFFFF);
+        } else if constexpr ((Opcode & 0x0F) == 0x03) { // INX
+            SetPair<Pair>(state, static_cast<std::uint16_t>(GetPair<Pair>(state) + 1));
+        } else if constexpr ((Opcode & 0x0F) == 0x0B) { // DCX
+            SetPair<Pair>(state, static_cast<std::uint16_t>(GetPair<Pair>(state) - 1));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::STAX_B)
+            || Opcode == static_cast<std::uint8_t>(opcodes::STAX_D)) {
+            state.memory.Write(GetPair<Pair>(state), state.registers.GetAccumulator());
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::LDAX_B)
+            || Opcode == static_cast<std::uint8_t>(opcodes::LDAX_D)) {
+            state.registers.SetAccumulator(state.memory.Read(GetPair<Pair>(state)));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::SHLD)) {
+            WriteWord(state, operand, GetPair<0b10>(state));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::LHLD)) {
+            SetPair<0b10>(state, ReadWord(state, operand));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::STA)) {
+            state.memory.Write(operand, state.registers.GetAccumulator());
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::LDA)) {
+            state.registers.SetAccumulator(state.memory.Read(operand));
+        } else {
+            static_assert(Opcode != Opcode, "Unhandled opcode in 00 group");
+        }
+    }
+
+    template <std::uint8_t Opcode, std::uint8_t High3, std::uint8_t Low3, std::uint8_t Pair>
+    static auto ExecuteGroup11(ProcessorState &state, const std::uint16_t operand) noexcept -> void
+    {
+        if constexpr (Low3 == 0b000) { // Rcc
+            if (CheckCondition<High3>(state.status)) {
+                TakeBranch<Opcode>(state);
+                state.registers.SetPc(Pop(state));
+            }
+        } else if constexpr (Low3 == 0b010) { // Jcc
+            if (CheckCondition<High3>(state.status)) {
+                TakeBranch<Opcode>(state);
+                state.registers.SetPc(operand);
+            }
+        } else if constexpr (Low3 == 0b100) { // Ccc
+            if (CheckCondition<High3>(state.status)) {
+                TakeBranch<Opcode>(state);
+                Call(state, operand);
+            }
+        } else if constexpr (Low3 == 0b110) { // ALU immediate
+            Alu<High3>(state, static_cast<std::uint8_t>(operand));
+        } else if constexpr (Low3 == 0b111) { // RST
+            Call(state, High3 * 0x08);
+        } else if constexpr (Low3 == 0b001 && (High3 & 0b001) == 0) {
+            SetStackPair<Pair>(state, Pop(state));
+        } else if constexpr (Low3 == 0b101 && (High3 & 0b001) == 0) {
+            Push(state, GetStackPair<Pair>(state));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::RET)) {
+            state.registers.SetPc(Pop(state));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::PCHL)) {
+            state.registers.SetPc(GetPair<0b10>(state));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::SPHL)) {
+            state.registers.SetSp(GetPair<0b10>(state));
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::CALL)) {
+            Call(state, operand);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::JMP)) {
+            state.registers.SetPc(operand);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::OUT)) {
+            // The latch is kept for mapped ports as well, so that save states hold the last value written
+            const auto port   = static_cast<std::uint8_t>(operand);
+            state.ports[port] = state.registers.GetAccumulator();
+            if (const DeviceBus *bus = state.memory.GetBus(); bus != nullptr) {
+                bus->Out(port, state.ports[port], state.cycles);
+            }
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::IN)) {
+            const auto       port = static_cast<std::uint8_t>(operand);
+            const DeviceBus *bus  = state.memory.GetBus();
+            state.registers.SetAccumulator(bus != nullptr ? bus->In(port, state.ports[port], state.cycles)
+                                                          : state.ports[port]);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::XTHL)) {
+            const std::uint16_t top = ReadWord(state, state.registers.GetSp());
+            WriteWord(state, state.registers.GetSp(), GetPair<0b10>(state));
+            SetPair<0b10>(state, top);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::XCHG)) {
+            const std::uint16_t de = GetPair<0b01>(state);
+            SetPair<0b01>(state, GetPair<0b10>(state));
+            SetPair<0b10>(state, de);
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::DI)) {
+            state.interruptsEnabled = false;
+        } else if constexpr (Opcode == static_cast<std::uint8_t>(opcodes::EI)) {
+            state.interruptsEnabled = true;
+            if (state.interruptRequests != 0) {
+                state.interruptsDeferred = true;
+                state.stopRequested      = true;
+            }
+        } else {
+            static_assert(Opcode != Opcode, "Unhandled opcode in 11 group");
+        }
+    }
+
+    static auto Illegal(ProcessorState &state, const std::uint8_t opcode) noexcept -> void
+    {
+        spdlog::error("Illegal opcode {:#04x} at address {:#06x}, halting", opcode,
+            static_cast<std::uint16_t>(state.registers.GetPc() - 1));
+        state.halted        = true;
+        state.stopRequested = true;
+    }
+
+    // Register operands: 000 - B, 001 - C, 010 - D, 011 - E, 100 - H, 101 - L, 110 - M, 111 - A
+    template <std::uint8_t Code>
+    [[nodiscard]] static auto GetOperand(ProcessorState &state) noexcept -> std::uint8_t
+    {
+        if constexpr (Code == 0b110) {
+            return state.memory.Read(GetPair<0b10>(state));
+        } else {
+            return state.registers.Get<Code>();
+        }
+    }
+
+    template <std::uint8_t Code>
+    static auto SetOperand(ProcessorState &state, const std::uint8_t value) noexcept -> void
+    {
+        if constexpr (Code == 0b110) {
+            state.memory.Write(GetPair<0b10>(state), value);
+        } else {
+            state.registers.Set<Code>(value);
+        }
+    }
+
+    // Register pairs: 00 - BC, 01 - DE, 10 - HL, 11 - SP
+    template <std::uint8_t Pair>
+    [[nodiscard]] static auto GetPair(const ProcessorState &state) noexcept -> std::uint16_t
+    {
+        if constexpr (Pair == 0b11) {
+            return state.registers.GetSp();
+        } else {
+            return state.registers.GetPair<Pair>();
+        }
+    }
+
+    template <std::uint8_t Pair>
+    static auto SetPair(ProcessorState &state, const std::uint16_t value) noexcept -> void
+    {
+        if constexpr (Pair == 0b11) {
+            state.registers.SetSp(value);
+        } else {
+            state.registers.SetPair<Pair>(value);
+        }
+    }
+
+    // PUSH/POP operate on PSW (A and flags) in place of SP
+    template <std::uint8_t Pair>
+    [[nodiscard]] static auto GetStackPair(const ProcessorState &state) noexcept -> std::uint16_t
+    {
+        if constexpr (Pair == 0b11) {
+            return MakeWord(state.registers.GetAccumulator(), state.status.GetFlags());
+        } else {
+            return GetPair<Pair>(state);
+        }
+    }
+
+    template <std::uint8_t Pair>
+    static auto SetStackPair(ProcessorState &state, const std::uint16_t value) noexcept -> void
+    {
+        if constexpr (Pair == 0b11) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>(value >> 8));
+            state.status.SetFlags(static_cast<std::uint8_t>(value));
+        } else {
+            SetPair<Pair>(state, value);
+        }
+    }
+
+    [[nodiscard]] static constexpr auto MakeWord(const std::uint8_t high, const std::uint8_t low) noexcept
+        -> std::uint16_t
+    {
+        return static_cast<std::uint16_t>((high << 8) | low);
+    }
+
+    [[nodiscard]] static auto ReadWord(const ProcessorState &state, const std::uint16_t address) noexcept
+        -> std::uint16_t
+    {
+        return MakeWord(state.memory.Read(static_cast<std::uint16_t>(address + 1)), state.memory.Read(address));
+    }
+
+    static auto WriteWord(ProcessorState &state, const std::uint16_t address, const std::uint16_t value) noexcept
+        -> void
+    {
+        state.memory.Write(address, static_cast<std::uint8_t>(value));
+        state.memory.Write(static_cast<std::uint16_t>(address + 1), static_cast<std::uint8_t>(value >> 8));
+    }
+
+    static auto Push(ProcessorState &state, const std::uint16_t value) noexcept -> void
+    {
+        const auto sp = static_cast<std::uint16_t>(state.registers.GetSp() - 2);
+        WriteWord(state, sp, value);
+        state.registers.SetSp(sp);
+    }
+
+    [[nodiscard]] static auto Pop(ProcessorState &state) noexcept -> std::uint16_t
+    {
+        const std::uint16_t sp = state.registers.GetSp();
+        state.registers.SetSp(static_cast<std::uint16_t>(sp + 2));
+        return ReadWord(state, sp);
+    }
+
+    // Fetch accounts conditional instructions as not taken, a taken one costs the difference on top
+    template <std::uint8_t Opcode>
+    static auto TakeBranch(ProcessorState &state) noexcept -> void
+    {
+        constexpr auto extra = static_cast<std::uint8_t>(instructionCyclesTaken[Opcode] - instructionCycles[Opcode]);
+        state.cycles += extra;
+    }
+
+    static auto Call(ProcessorState &state, const std::uint16_t address) noexcept -> void
+    {
+        Push(state, state.registers.GetPc());
+        state.registers.SetPc(address);
+    }
+
+    // Conditions: 000 - NZ, 001 - Z, 010 - NC, 011 - C, 100 - PO, 101 - PE, 110 - P, 111 - M
+    template <std::uint8_t Condition>
+    [[nodiscard]] static auto CheckCondition(const StatusRegister &status) noexcept -> bool
+    {
+        if constexpr (Condition == 0b000) {
+            return !status.GetZeroBit();
+        } else if constexpr (Condition == 0b001) {
+            return status.GetZeroBit();
+        } else if constexpr (Condition == 0b010) {
+            return !status.GetCarryBit();
+        } else if constexpr (Condition == 0b011) {
+            return status.GetCarryBit();
+        } else if constexpr (Condition == 0b100) {
+            return !status.GetParityBit();
+        } else if constexpr (Condition == 0b101) {
+            return status.GetParityBit();
+        } else if constexpr (Condition == 0b110) {
+            return !status.GetSignBit();
+        } else {
+            return status.GetSignBit();
+        }
+    }
+
+    static auto SetFlag(StatusRegister &status, const std::uint8_t flag, const bool value) noexcept -> void
+    {
+        status.SetFlags(static_cast<std::uint8_t>(value ? status.GetFlags() | flag : status.GetFlags() & ~flag));
+    }
+
+    template <std::uint8_t Destination, std::uint8_t Source>
+    static auto Mov(ProcessorState &state) noexcept -> void
+    {
+        SetOperand<Destination>(state, GetOperand<Source>(state));
+    }
+
+    // Operations: 000 - ADD, 001 - ADC, 010 - SUB, 011 - SBB, 100 - ANA, 101 - XRA, 110 - ORA, 111 - CMP
+    template <std::uint8_t Operation>
+    static auto Alu(ProcessorState &state, const std::uint8_t value) noexcept -> void
+    {
+        const std::uint8_t accumulator = state.registers.GetAccumulator();
+        if constexpr (Operation <= 0b001) {
+            const unsigned carry  = Operation == 0b001 && state.status.GetCarryBit() ? 1 : 0;
+            const auto     sum    = static_cast<std::uint16_t>(accumulator + value + carry);
+            state.status.RecordAddition(accumulator, value, sum);
+            state.registers.SetAccumulator(static_cast<std::uint8_t>(sum));
+        } else if constexpr (Operation <= 0b011 || Operation == 0b111) {
+            // Subtraction adds the two's complement, AC is the carry out of bit 3 of that addition
+            const int      borrow     = Operation == 0b011 && state.status.GetCarryBit() ? 1 : 0;
+            const auto     complement = static_cast<std::uint8_t>(~value);
+            const auto     sum        = static_cast<std::uint16_t>(accumulator + complement + 1 - borrow);
+            state.status.RecordSubtraction(accumulator, complement, sum);
+            if constexpr (Operation != 0b111) {
+                state.registers.SetAccumulator(static_cast<std::uint8_t>(sum));
+            }
+        } else if constexpr (Operation == 0b100) {
+            const auto result = static_cast<std::uint8_t>(accumulator & value);
+            state.status.RecordLogical(result, true);
+            state.registers.SetAccumulator(result);
+        } else {
+            const auto result
+                = static_cast<std::uint8_t>(Operation == 0b101 ? accumulator ^ value : accumulator | value);
+            state.status.RecordLogical(result, false);
+            state.registers.SetAccumulator(result);
+        }
+    }
+
+    // INR and DCR leave the carry flag untouched
+    template <std::uint8_t Code>
+    static auto Increment(ProcessorState &state) noexcept -> void
+    {
+        const std::uint8_t value  = GetOperand<Code>(state);
+        const auto         result = static_cast<std::uint8_t>(value + 1);
+        state.status.RecordIncrement(value, result);
+        SetOperand<Code>(state, result);
+    }
+
+    template <std::uint8_t Code>
+    static auto Decrement(ProcessorState &state) noexcept -> void
+    {
+        const std::uint8_t value  = GetOperand<Code>(state);
+        const auto         result = static_cast<std::uint8_t>(value - 1);
+        state.status.RecordDecrement(value, result);
+        SetOperand<Code>(state, result);
+    }
+
+    // Operations: 000 - RLC, 001 - RRC, 010 - RAL, 011 - RAR, 100 - DAA, 101 - CMA, 110 - STC, 111 - CMC
+    template <std::uint8_t Operation>
+    static auto Accumulator(ProcessorState &state) noexcept -> void
+    {
+        const std::uint8_t accumulator = state.registers.GetAccumulator();
+        const bool         carry       = state.status.GetCarryBit();
+        if constexpr (Operation == 0b000) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>((accumulator << 1) | (accumulator >> 7)));
+            SetFlag(state.status, StatusRegister::carryFlag, accumulator & 0x80);
+        } else if constexpr (Operation == 0b001) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>((accumulator >> 1) | (accumulator << 7)));
+            SetFlag(state.status, StatusRegister::carryFlag, accumulator & 0x01);
+        } else if constexpr (Operation == 0b010) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>((accumulator << 1) | (carry ? 0x01 : 0x00)));
+            SetFlag(state.status, StatusRegister::carryFlag, accumulator & 0x80);
+        } else if constexpr (Operation == 0b011) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>((accumulator >> 1) | (carry ? 0x80 : 0x00)));
+            SetFlag(state.status, StatusRegister::carryFlag, accumulator & 0x01);
+        } else if constexpr (Operation == 0b100) {
+            DecimalAdjust(state);
+        } else if constexpr (Operation == 0b101) {
+            state.registers.SetAccumulator(static_cast<std::uint8_t>(~accumulator));
+        } else if constexpr (Operation == 0b110) {
+            state.status.SetCarryBit();
+        } else {
+            SetFlag(state.status, StatusRegister::carryFlag, !carry);
+        }
+    }
+
+    static auto DecimalAdjust(ProcessorState &state) noexcept -> void
+    {
+        const std::uint16_t adjusted
+            = StatusRegister::DecimalAdjust(state.registers.GetAccumulator(), state.status.GetFlags());
+        state.status.SetFlags(static_cast<std::uint8_t>(adjusted >> 8));
+        state.registers.SetAccumulator(static_cast<std::uint8_t>(adjusted));
+    }
+
 public:  // Data Members
 private: // Data Members
+    static const std::array<Handler, 0x100> handlers_;
+    static const std::array<Superinstruction, 19> superinstructions_;
+
+    // Outside of the address space, so that no address is stepped over
+    static constexpr std::uint32_t noAddress = 0x10000;
+
+    DispatchMode dispatchMode_ = defaultDispatchMode;
+
+    BlockCache    blockCache_;
+    DebugStop     debugStop_ = DebugStop::None;
+    std::uint32_t stepOver_  = noAddress;
+
+#if INTERPRETER_8085_HAS_JIT
+    JitCompiler jitCompiler_;
+    JitContext  jitContext_;
+#endif
+};
+
+inline constexpr std::array<ExecutionUnit::Handler, 0x100> ExecutionUnit::handlers_
+    = ExecutionUnit::MakeHandlerTable(std::make_index_sequence<0x100> {});
+
+// The hottest opcode pairs of the bench workloads as reported by the ExecutionProfiler, along with the usual
+// 16 bit zero tests and count-down loops. A write may only come last, see Superinstruction.
+inline constexpr std::array<Superinstruction, 19> ExecutionUnit::superinstructions_ = {
+    // Loop tails
+    Fuse<opcodes::INX_H, opcodes::DCR_C, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_B, opcodes::ORA_C, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_C, opcodes::ORA_B, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_D, opcodes::ORA_E, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_E, opcodes::ORA_D, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_H, opcodes::ORA_L, opcodes::JNZ>(),
+    Fuse<opcodes::MOV_A_L, opcodes::ORA_H, opcodes::JNZ>(),
+    Fuse<opcodes::DCR_B, opcodes::JNZ>(),
+    Fuse<opcodes::DCR_C, opcodes::JNZ>(),
+    // Pointer walks and block copies
+    Fuse<opcodes::LXI_H, opcodes::MOV_A_M>(),
+    Fuse<opcodes::MOV_A_M, opcodes::STAX_D>(),
+    Fuse<opcodes::MOV_A_M, opcodes::INX_H>(),
+    Fuse<opcodes::INX_H, opcodes::INX_D>(),
+    Fuse<opcodes::LDAX_D, opcodes::ADC_M>(),
+    Fuse<opcodes::CMP_M, opcodes::JC>(),
+    // Swaps and BCD arithmetic
+    Fuse<opcodes::MOV_D_M, opcodes::MOV_M_A>(),
+    Fuse<opcodes::DCX_H, opcodes::MOV_M_D>(),
+    Fuse<opcodes::DAA, opcodes::MOV_M_A>(),
+    // Shifting HL left
+    Fuse<opcodes::DAD_H, opcodes::DAD_H>(),
 };
 
 } // namespace intel_8085
@@ -1,8 +1,12 @@
 #ifndef INTERPRETER_8085_INSTRUCTION_SET_HPP
 #define INTERPRETER_8085_INSTRUCTION_SET_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <optional>
+#include <string_view>
 
 namespace intel_8085 {
 
@@ -255,22 +259,28 @@ enum class opcodes : std::uint8_t {
     RST_7    = 0xFF
 };
 
-const std::map<std::string, opcodes> stringToInstruction { { "NOP", opcodes::NOP }, { "LXI_B", opcodes::LXI_B },
-    { "STAX_B", opcodes::STAX_B }, { "INX_B", opcodes::INX_B }, { "INR_B", opcodes::INR_B },
-    { "DCR_B", opcodes::DCR_B }, { "MVI_B", opcodes::MVI_B }, { "RLC", opcodes::RLC }, { "DAD_B", opcodes::DAD_B },
-    { "LDAX_B", opcodes::LDAX_B }, { "DCX_B", opcodes::DCX_B }, { "INR_C", opcodes::INR_C },
-    { "DCR_C", opcodes::DCR_C }, { "MVI_C", opcodes::MVI_C }, { "RRC", opcodes::RRC }, { "LXI_D", opcodes::LXI_D },
-    { "STAX_D", opcodes::STAX_D }, { "INX_D", opcodes::INX_D }, { "INR_D", opcodes::INR_D },
-    { "DCR_D", opcodes::DCR_D }, { "MVI_D", opcodes::MVI_D }, { "RAL", opcodes::RAL }, { "DAD_D", opcodes::DAD_D },
-    { "LDAX_D", opcodes::LDAX_D }, { "DCX_D", opcodes::DCX_D }, { "INR_E", opcodes::INR_E },
-    { "DCR_E", opcodes::DCR_E }, { "MVI_E", opcodes::MVI_E }, { "RAR", opcodes::RAR }, { "RIM", opcodes::RIM },
-    { "LXI_H", opcodes::LXI_H }, { "SHLD", opcodes::SHLD }, { "INX_H", opcodes::INX_H }, { "INR_H", opcodes::INR_H },
-    { "DCR_H", opcodes::DCR_H }, { "MVI_H", opcodes::MVI_H }, { "DAA", opcodes::DAA }, { "DAD_H", opcodes::DAD_H },
-    { "LHLD", opcodes::LHLD }, { "DCX_H", opcodes::DCX_H }, { "INR_L", opcodes::INR_L }, { "DCR_L", opcodes::DCR_L },
-    { "MVI_L", opcodes::MVI_L }, { "CMA", opcodes::CMA }, { "SIM", opcodes::SIM }, { "LXI_SP", opcodes::LXI_SP },
-    { "STA", opcodes::STA }, { "INX_SP", opcodes::INX_SP }, { "INR_M", opcodes::INR_M }, { "DCR_M", opcodes::DCR_M },
-    { "MVI_M", opcodes::MVI_M }, { "STC", opcodes::STC }, { "DAD_SP", opcodes::DAD_SP }, { "LDA", opcodes::LDA },
-    { "DCX_SP", opcodes::DCX_SP }, { "INR_A", opcodes::INR_A }, { "DCR_A", opcodes::DCR_A },
+// A mnemonic as written in programs, e.g. MOV_A_B
+struct Mnemonic {
+    std::string_view name;
+    opcodes          opcode;
+};
+
+constexpr std::array<Mnemonic, 246> mnemonics { {
+    { "NOP", opcodes::NOP }, { "LXI_B", opcodes::LXI_B }, { "STAX_B", opcodes::STAX_B }, { "INX_B", opcodes::INX_B },
+    { "INR_B", opcodes::INR_B }, { "DCR_B", opcodes::DCR_B }, { "MVI_B", opcodes::MVI_B }, { "RLC", opcodes::RLC },
+    { "DAD_B", opcodes::DAD_B }, { "LDAX_B", opcodes::LDAX_B }, { "DCX_B", opcodes::DCX_B },
+    { "INR_C", opcodes::INR_C }, { "DCR_C", opcodes::DCR_C }, { "MVI_C", opcodes::MVI_C }, { "RRC", opcodes::RRC },
+    { "LXI_D", opcodes::LXI_D }, { "STAX_D", opcodes::STAX_D }, { "INX_D", opcodes::INX_D },
+    { "INR_D", opcodes::INR_D }, { "DCR_D", opcodes::DCR_D }, { "MVI_D", opcodes::MVI_D }, { "RAL", opcodes::RAL },
+    { "DAD_D", opcodes::DAD_D }, { "LDAX_D", opcodes::LDAX_D }, { "DCX_D", opcodes::DCX_D },
+    { "INR_E", opcodes::INR_E }, { "DCR_E", opcodes::DCR_E }, { "MVI_E", opcodes::MVI_E }, { "RAR", opcodes::RAR },
+    { "RIM", opcodes::RIM }, { "LXI_H", opcodes::LXI_H }, { "SHLD", opcodes::SHLD }, { "INX_H", opcodes::INX_H },
+    { "INR_H", opcodes::INR_H }, { "DCR_H", opcodes::DCR_H }, { "MVI_H", opcodes::MVI_H }, { "DAA", opcodes::DAA },
+    { "DAD_H", opcodes::DAD_H }, { "LHLD", opcodes::LHLD }, { "DCX_H", opcodes::DCX_H }, { "INR_L", opcodes::INR_L },
+    { "DCR_L", opcodes::DCR_L }, { "MVI_L", opcodes::MVI_L }, { "CMA", opcodes::CMA }, { "SIM", opcodes::SIM },
+    { "LXI_SP", opcodes::LXI_SP }, { "STA", opcodes::STA }, { "INX_SP", opcodes::INX_SP }, { "INR_M", opcodes::INR_M },
+    { "DCR_M", opcodes::DCR_M }, { "MVI_M", opcodes::MVI_M }, { "STC", opcodes::STC }, { "DAD_SP", opcodes::DAD_SP },
+    { "LDA", opcodes::LDA }, { "DCX_SP", opcodes::DCX_SP }, { "INR_A", opcodes::INR_A }, { "DCR_A", opcodes::DCR_A },
     { "MVI_A", opcodes::MVI_A }, { "CMC", opcodes::CMC }, { "MOV_B_B", opcodes::MOV_B_B },
     { "MOV_B_C", opcodes::MOV_B_C }, { "MOV_B_D", opcodes::MOV_B_D }, { "MOV_B_E", opcodes::MOV_B_E },
     { "MOV_B_H", opcodes::MOV_B_H }, { "MOV_B_L", opcodes::MOV_B_L }, { "MOV_B_M", opcodes::MOV_B_M },
@@ -323,7 +333,307 @@ const std::map<std::string, opcodes> stringToInstruction { { "NOP", opcodes::NOP
     { "RP", opcodes::RP }, { "POP_PSW", opcodes::POP_PSW }, { "JP", opcodes::JP }, { "DI", opcodes::DI },
     { "CP", opcodes::CP }, { "PUSH_PSW", opcodes::PUSH_PSW }, { "ORI", opcodes::ORI }, { "RST_6", opcodes::RST_6 },
     { "RM", opcodes::RM }, { "SPHL", opcodes::SPHL }, { "JM", opcodes::JM }, { "EI", opcodes::EI },
-    { "CM", opcodes::CM }, { "CPI", opcodes::CPI }, { "RST_7", opcodes::RST_7 } };
+    { "CM", opcodes::CM }, { "CPI", opcodes::CPI }, { "RST_7", opcodes::RST_7 } } };
+
+// Opcode field helpers, refer doc/InstructionDecodeLogic.md for the bit layout
+[[nodiscard]] constexpr auto OpcodeGroup(const std::uint8_t opcode) noexcept -> std::uint8_t { return opcode >> 6; }
+
+[[nodiscard]] constexpr auto DestinationField(const std::uint8_t opcode) noexcept -> std::uint8_t
+{
+    return (opcode >> 3) & 0x07;
+}
+
+[[nodiscard]] constexpr auto SourceField(const std::uint8_t opcode) noexcept -> std::uint8_t { return opcode & 0x07; }
+
+[[nodiscard]] constexpr auto RegisterPairField(const std::uint8_t opcode) noexcept -> std::uint8_t
+{
+    return (opcode >> 4) & 0x03;
+}
+
+// Opcodes left unused by the 8085 (undocumented on real silicon)
+[[nodiscard]] constexpr auto IsValidOpcode(const std::uint8_t opcode) noexcept -> bool
+{
+    switch (opcode) {
+    case 0x08:
+    case 0x10:
+    case 0x18:
+    case 0x28:
+    case 0x38:
+    case 0xCB:
+    case 0xD9:
+    case 0xDD:
+    case 0xED:
+    case 0xFD:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Total size in bytes (opcode + operands)
+[[nodiscard]] constexpr auto InstructionLength(const std::uint8_t opcode) noexcept -> std::uint8_t
+{
+    const std::uint8_t low3 = SourceField(opcode);
+    switch (OpcodeGroup(opcode)) {
+    case 0b00:
+        if (low3 == 0b110) {
+            return 2; // MVI
+        }
+        if ((opcode & 0x0F) == 0x01) {
+            return 3; // LXI
+        }
+        if (opcode == 0x22 || opcode == 0x2A || opcode == 0x32 || opcode == 0x3A) {
+            return 3; // SHLD, LHLD, STA, LDA
+        }
+        return 1;
+    case 0b11:
+        if (low3 == 0b010 || low3 == 0b100 || opcode == 0xC3 || opcode == 0xCD) {
+            return 3; // Jcc, Ccc, JMP, CALL
+        }
+        if (low3 == 0b110 || opcode == 0xD3 || opcode == 0xDB) {
+            return 2; // ALU immediate, OUT, IN
+        }
+        return 1;
+    default:
+        return 1;
+    }
+}
+
+// T-states taken by each instruction, conditional instructions are listed with their not-taken cost
+[[nodiscard]] constexpr auto InstructionCycles(const std::uint8_t opcode) noexcept -> std::uint8_t
+{
+    const std::uint8_t high3 = DestinationField(opcode);
+    const std::uint8_t low3  = SourceField(opcode);
+    switch (OpcodeGroup(opcode)) {
+    case 0b00:
+        switch (low3) {
+        case 0b100: // INR
+        case 0b101: // DCR
+            return high3 == 0b110 ? 10 : 4;
+        case 0b110: // MVI
+            return high3 == 0b110 ? 10 : 7;
+        case 0b111: // RLC, RRC, RAL, RAR, DAA, CMA, STC, CMC
+            return 4;
+        case 0b001: // LXI, DAD
+            return 10;
+        case 0b010: // STAX, SHLD, STA, LDAX, LHLD, LDA
+            return high3 < 0b100 ? 7 : (high3 & 0b010 ? 13 : 16);
+        case 0b011: // INX, DCX
+            return 6;
+        default: // NOP, RIM, SIM
+            return 4;
+        }
+    case 0b01:
+        if (opcode == static_cast<std::uint8_t>(opcodes::HLT)) {
+            return 5;
+        }
+        return (high3 == 0b110 || low3 == 0b110) ? 7 : 4;
+    case 0b10:
+        return low3 == 0b110 ? 7 : 4;
+    default:
+        switch (low3) {
+        case 0b000: // Rcc
+            return 6;
+        case 0b001: // POP, RET, PCHL, SPHL
+            return (opcode == 0xE9 || opcode == 0xF9) ? 6 : 10;
+        case 0b010: // Jcc
+            return 7;
+        case 0b011: // JMP, OUT, IN, XTHL, XCHG, DI, EI
+            return opcode == 0xE3 ? 16 : (opcode >= 0xEB ? 4 : 10);
+        case 0b100: // Ccc
+            return 9;
+        case 0b101: // PUSH, CALL
+            return opcode == 0xCD ? 18 : 12;
+        case 0b110: // ALU immediate
+            return 7;
+        default: // RST
+            return 12;
+        }
+    }
+}
+
+// CALL, Ccc and RST, the instructions pushing a return address
+[[nodiscard]] constexpr auto IsCall(const std::uint8_t opcode) noexcept -> bool
+{
+    return opcode == static_cast<std::uint8_t>(opcodes::CALL)
+        || (OpcodeGroup(opcode) == 0b11 && (SourceField(opcode) == 0b100 || SourceField(opcode) == 0b111));
+}
+
+// Instructions storing to memory: MOV M, r, INR/DCR/MVI M, STAX, SHLD, STA and those writing the stack
+[[nodiscard]] constexpr auto WritesMemory(const std::uint8_t opcode) noexcept -> bool
+{
+    const std::uint8_t high3 = DestinationField(opcode);
+    const std::uint8_t low3  = SourceField(opcode);
+    switch (OpcodeGroup(opcode)) {
+    case 0b00:
+        return (high3 == 0b110 && low3 >= 0b100 && low3 <= 0b110) || (low3 == 0b010 && (opcode & 0x08) == 0);
+    case 0b01:
+        return high3 == 0b110 && opcode != static_cast<std::uint8_t>(opcodes::HLT);
+    case 0b11:
+        return IsCall(opcode) || (low3 == 0b101 && (opcode & 0x08) == 0)
+            || opcode == static_cast<std::uint8_t>(opcodes::XTHL);
+    default:
+        return false;
+    }
+}
+
+// Instructions which may transfer control elsewhere (or stop the processor) terminate a basic block.
+// So do those after which an interrupt may have to be accepted: EI and SIM change what is deliverable, and devices
+// behind IN and OUT may raise interrupts.
+[[nodiscard]] constexpr auto EndsBasicBlock(const std::uint8_t opcode) noexcept -> bool
+{
+    if (!IsValidOpcode(opcode) || opcode == static_cast<std::uint8_t>(opcodes::HLT)
+        || opcode == static_cast<std::uint8_t>(opcodes::SIM)) {
+        return true;
+    }
+    if (OpcodeGroup(opcode) != 0b11) {
+        return false;
+    }
+    const std::uint8_t low3 = SourceField(opcode);
+    return low3 == 0b000 || low3 == 0b010 || low3 == 0b100 || low3 == 0b111 // Rcc, Jcc, Ccc, RST
+        || opcode == static_cast<std::uint8_t>(opcodes::RET) || opcode == static_cast<std::uint8_t>(opcodes::PCHL)
+        || opcode == static_cast<std::uint8_t>(opcodes::JMP) || opcode == static_cast<std::uint8_t>(opcodes::CALL)
+        || opcode == static_cast<std::uint8_t>(opcodes::IN) || opcode == static_cast<std::uint8_t>(opcodes::OUT)
+        || opcode == static_cast<std::uint8_t>(opcodes::EI);
+}
+
+template <typename Generator>
+[[nodiscard]] constexpr auto MakeOpcodeTable(Generator generator) noexcept -> std::array<std::uint8_t, 0x100>
+{
+    std::array<std::uint8_t, 0x100> table {};
+    for (std::size_t opcode = 0; opcode < table.size(); opcode++) {
+        table[opcode] = generator(static_cast<std::uint8_t>(opcode));
+    }
+    return table;
+}
+
+constexpr std::array<std::uint8_t, 0x100> instructionLength = MakeOpcodeTable(InstructionLength);
+constexpr std::array<std::uint8_t, 0x100> instructionCycles = MakeOpcodeTable(InstructionCycles);
+
+// T-states of a conditional return, jump or call whose condition holds, same as InstructionCycles otherwise
+[[nodiscard]] constexpr auto InstructionCyclesTaken(const std::uint8_t opcode) noexcept -> std::uint8_t
+{
+    if (OpcodeGroup(opcode) == 0b11) {
+        switch (SourceField(opcode)) {
+        case 0b000: // Rcc
+            return 12;
+        case 0b010: // Jcc
+            return 10;
+        case 0b100: // Ccc
+            return 18;
+        default:
+            break;
+        }
+    }
+    return InstructionCycles(opcode);
+}
+constexpr std::array<std::uint8_t, 0x100> instructionCyclesTaken = MakeOpcodeTable(InstructionCyclesTaken);
+
+// Mnemonic of every opcode, empty for the invalid ones
+constexpr std::array<std::string_view, 0x100> instructionMnemonic = [] {
+    std::array<std::string_view, 0x100> table {};
+    for (const Mnemonic &mnemonic : mnemonics) {
+        table[static_cast<std::uint8_t>(mnemonic.opcode)] = mnemonic.name;
+    }
+    return table;
+}();
+
+// Perfect hash of the mnemonics, built at compile time with hash and displace: every mnemonic hashes to one of
+// the buckets, and every bucket gets the first seed that sends all of its mnemonics to free slots.
+// A lookup hashes twice and compares against the one mnemonic its slot can hold, there is no probing.
+struct MnemonicTable {
+    static constexpr std::uint32_t bucketCount = 0x40;
+    static constexpr std::uint32_t slotCount   = 0x200;
+
+    std::array<std::uint16_t, bucketCount> seeds {};
+    std::array<std::uint8_t, slotCount>    slots {};
+};
+
+// FNV-1a, with the seed folded into the offset basis
+[[nodiscard]] constexpr auto MnemonicHash(const std::string_view name, const std::uint32_t seed) noexcept
+    -> std::uint32_t
+{
+    std::uint32_t hash = 0x811C9DC5U ^ (seed * 0x9E3779B9U);
+    for (const char c : name) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x01000193U;
+    }
+    return hash ^ (hash >> 16);
+}
+
+[[nodiscard]] constexpr auto MakeMnemonicTable() noexcept -> MnemonicTable
+{
+    constexpr std::uint32_t bucketCount = MnemonicTable::bucketCount;
+    constexpr std::uint32_t slotCount   = MnemonicTable::slotCount;
+
+    MnemonicTable table;
+    // Free slots hold an invalid opcode, whose empty mnemonic never matches
+    table.slots.fill(0x08);
+    std::array<bool, slotCount>                 used {};
+    std::array<std::size_t, bucketCount>        bucketSize {};
+    std::array<std::uint32_t, mnemonics.size()> bucketOf {};
+    std::size_t                                 largest = 0;
+    for (std::size_t index = 0; index < mnemonics.size(); index++) {
+        bucketOf[index] = MnemonicHash(mnemonics[index].name, 0) % bucketCount;
+        largest         = std::max(largest, ++bucketSize[bucketOf[index]]);
+    }
+    // Crowded buckets are placed first, while most slots are still free
+    for (std::size_t size = largest; size > 0; size--) {
+        for (std::uint32_t bucket = 0; bucket < bucketCount; bucket++) {
+            if (bucketSize[bucket] != size) {
+                continue;
+            }
+            for (std::uint32_t seed = 1;; seed++) {
+                std::array<bool, slotCount> taken = used;
+                bool                        fits  = true;
+                for (std::size_t index = 0; fits && index < mnemonics.size(); index++) {
+                    if (bucketOf[index] == bucket) {
+                        const std::uint32_t slot = MnemonicHash(mnemonics[index].name, seed) % slotCount;
+                        fits                     = !taken[slot];
+                        taken[slot]              = true;
+                    }
+                }
+                if (fits) {
+                    for (std::size_t index = 0; index < mnemonics.size(); index++) {
+                        if (bucketOf[index] == bucket) {
+                            table.slots[MnemonicHash(mnemonics[index].name, seed) % slotCount]
+                                = static_cast<std::uint8_t>(mnemonics[index].opcode);
+                        }
+                    }
+                    used                = taken;
+                    table.seeds[bucket] = static_cast<std::uint16_t>(seed);
+                    break;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+constexpr MnemonicTable mnemonicTable = MakeMnemonicTable();
+
+// Opcode of a mnemonic, nullopt if there is no such instruction
+[[nodiscard]] constexpr auto FindOpcode(const std::string_view name) noexcept -> std::optional<opcodes>
+{
+    const std::uint32_t bucket = MnemonicHash(name, 0) % MnemonicTable::bucketCount;
+    const std::uint8_t  opcode
+        = mnemonicTable.slots[MnemonicHash(name, mnemonicTable.seeds[bucket]) % MnemonicTable::slotCount];
+    if (name.empty() || instructionMnemonic[opcode] != name) {
+        return std::nullopt;
+    }
+    return static_cast<opcodes>(opcode);
+}
+
+static_assert(FindOpcode("NOP") == opcodes::NOP && FindOpcode("MOV_A_M") == opcodes::MOV_A_M);
+static_assert(FindOpcode("RST_7") == opcodes::RST_7 && !FindOpcode("MOV_A").has_value() && !FindOpcode("").has_value());
+static_assert([] {
+    for (const Mnemonic &mnemonic : mnemonics) {
+        const auto opcode = static_cast<std::uint8_t>(mnemonic.opcode);
+        if (FindOpcode(mnemonic.name) != mnemonic.opcode || !IsValidOpcode(opcode)) {
+            return false;
+        }
+    }
+    return true;
+}());
 
 } // namespace intel_8085
 
@@ -0,0 +1,103 @@
+#ifndef INTERPRETER_8085_INTERRUPT_CONTROLLER_HPP
+#define INTERPRETER_8085_INTERRUPT_CONTROLLER_HPP
+
+#include <bit>
+#include <cstdint>
+
+#include "processor_state.hpp"
+
+namespace intel_8085 {
+
+// Interrupt inputs of the 8085, by priority: TRAP, RST 7.5, RST 6.5 and RST 5.5.
+// TRAP is accepted whatever the interrupt enable and the masks, the RST inputs only while interrupts are enabled and
+// their mask bit is clear. Accepting any interrupt disables interrupts, wakes a halted processor and calls the
+// vector of the input, taking 12 T-states like an RST. TRAP and RST 7.5 are edge triggered and stay requested until
+// accepted, RST 7.5 also until reset through SIM. RST 5.5 and 6.5 are level triggered and stay requested until
+// lowered, so they are accepted again once interrupts are re-enabled.
+// Requests live in the ProcessorState, so that RIM sees them and save states hold them.
+class InterruptController {
+public: // Functions/Methods
+    explicit InterruptController(ProcessorState &state) noexcept : state_(state) { }
+
+    // Ends the current run, so that a request raised while the processor runs is seen at the next stop
+    auto Raise(const InterruptLine line) noexcept -> void
+    {
+        state_.interruptRequests |= static_cast<std::uint8_t>(line);
+        state_.stopRequested = true;
+    }
+
+    // Lowering RST 7.5 does nothing, its request is latched
+    auto Lower(const InterruptLine line) noexcept -> void
+    {
+        if (line != InterruptLine::Rst75) {
+            state_.interruptRequests &= static_cast<std::uint8_t>(~static_cast<std::uint8_t>(line));
+        }
+    }
+
+    // True if the next call to Accept() would accept an interrupt
+    [[nodiscard]] auto IsDeliverable() const noexcept -> bool { return GetDeliverable() != 0; }
+
+    // Accepts the highest priority interrupt allowed, returns false if there is none
+    auto Accept() noexcept -> bool
+    {
+        const std::uint8_t deliverable = GetDeliverable();
+        if (deliverable == 0) {
+            return false;
+        }
+        const std::uint8_t line = std::bit_floor(deliverable);
+        if (line & (static_cast<std::uint8_t>(InterruptLine::Trap) | static_cast<std::uint8_t>(InterruptLine::Rst75))) {
+            state_.interruptRequests &= static_cast<std::uint8_t>(~line);
+        }
+
+        // Accounted before the pushes like the cycles of an instruction, so that the WriteJournal sees them past the
+        // instruction boundary
+        state_.cycles += acceptCycles;
+        const std::uint16_t pc = state_.registers.GetPc();
+        const auto          sp = static_cast<std::uint16_t>(state_.registers.GetSp() - 2);
+        state_.memory.Write(sp, static_cast<std::uint8_t>(pc));
+        state_.memory.Write(static_cast<std::uint16_t>(sp + 1), static_cast<std::uint8_t>(pc >> 8));
+        state_.registers.SetSp(sp);
+        state_.registers.SetPc(GetVector(line));
+        state_.interruptsEnabled = false;
+        state_.halted            = false;
+        return true;
+    }
+
+private: // Functions/Methods
+    [[nodiscard]] auto GetDeliverable() const noexcept -> std::uint8_t
+    {
+        constexpr auto trap = static_cast<std::uint8_t>(InterruptLine::Trap);
+        if (state_.interruptRequests & trap) {
+            return trap;
+        }
+        if (!state_.interruptsEnabled || state_.interruptsDeferred) {
+            return 0;
+        }
+        return static_cast<std::uint8_t>(state_.interruptRequests & ~state_.interruptMask & 0x07);
+    }
+
+    // TRAP calls 0x24, RST 5.5, 6.5 and 7.5 call 0x2C, 0x34 and 0x3C
+    [[nodiscard]] static constexpr auto GetVector(const std::uint8_t line) noexcept -> std::uint16_t
+    {
+        switch (line) {
+        case static_cast<std::uint8_t>(InterruptLine::Trap):
+            return 0x24;
+        case static_cast<std::uint8_t>(InterruptLine::Rst75):
+            return 0x3C;
+        case static_cast<std::uint8_t>(InterruptLine::Rst65):
+            return 0x34;
+        default:
+            return 0x2C;
+        }
+    }
+
+public:  // Data Members
+    static constexpr std::uint8_t acceptCycles = 12;
+
+private: // Data Members
+    ProcessorState &state_;
+};
+
+} // namespace intel_8085
+
+#endif
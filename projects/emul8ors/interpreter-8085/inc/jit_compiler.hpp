@@ -0,0 +1,584 @@
+#ifndef INTERPRETER_8085_JIT_COMPILER_HPP
+#define INTERPRETER_8085_JIT_COMPILER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "block_cache.hpp"
+#include "instruction_set.hpp"
+#include "processor_state.hpp"
+
+// Translation to native code is only available on x86-64 Linux hosts
+#if defined(__x86_64__) && defined(__linux__) && !defined(INTERPRETER_8085_NO_JIT)
+#define INTERPRETER_8085_HAS_JIT 1
+#include "x86_64_emitter.hpp"
+#else
+#define INTERPRETER_8085_HAS_JIT 0
+#endif
+
+namespace intel_8085 {
+
+// Register file handed to native blocks, slots are in the order the registers are pinned to R8B - R15B.
+// Native code reaches every field with an 8 bit displacement, so the context has to stay below 128 bytes.
+struct JitContext {
+    std::array<std::uint8_t, 8> registers      = {}; // B, C, D, E, H, L, A, flags
+    std::uint64_t               cycles         = 0;
+    std::uint64_t               endCycle       = 0;
+    std::uint32_t               executed       = 0;  // Instructions retired by the native code
+    std::uint16_t               pc             = 0;  // Where the interpreter resumes
+    ProcessorState             *processor      = nullptr;
+    std::uint8_t *const        *pages          = nullptr; // The memory's page table and attributes
+    const std::uint8_t         *pageAttributes = nullptr;
+
+    auto Load(ProcessorState &state, const std::uint64_t cycleLimit) noexcept -> void
+    {
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            registers[code] = state.registers.Get(code);
+        }
+        registers[6]   = state.registers.GetAccumulator();
+        registers[7]   = state.status.GetFlags();
+        cycles         = state.cycles;
+        endCycle       = cycleLimit;
+        executed       = 0;
+        processor      = &state;
+        pages          = state.memory.GetPageTable();
+        pageAttributes = state.memory.GetPageAttributeTable();
+    }
+
+    auto Store(ProcessorState &state) const noexcept -> void
+    {
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            state.registers.Set(code, registers[code]);
+        }
+        state.registers.SetAccumulator(registers[6]);
+        state.status.SetFlags(registers[7]);
+        state.registers.SetPc(pc);
+        state.cycles = cycles;
+    }
+};
+
+#if INTERPRETER_8085_HAS_JIT
+
+// Translates hot DecodedBlocks into x86-64 code.
+// The 8085 registers and flags stay pinned in R8B - R15B for the whole block. The x86 SF, ZF, AF, PF and CF
+// flags sit in the same bit positions as S, Z, AC, P and CY, so flags are taken straight from LAHF and only
+// patched up where the 8085 differs (AC on subtraction and logical operations, CY kept by INR/DCR).
+// Loads and stores look up the page attributes inline: pages with none set are accessed in place through the page
+// table, any other page (device, watched, shared, code or journaled) goes through SystemMemory in a call out. A
+// store which dirties code, or reaches a device requesting a stop, leaves the block right after, like the
+// interpreter does.
+// Translation stops at the first instruction that touches the stack, I/O or interrupts and the interpreter resumes
+// from there. A block that jumps back to its own start loops natively until the cycle budget would be crossed by
+// another iteration.
+class JitCompiler {
+public: // Functions/Methods
+    // Returns nullptr if not even the first instruction of the block can be translated
+    [[nodiscard]] auto Compile(const DecodedBlock &block) noexcept -> NativeBlock
+    {
+        using x86_64::AluOp;
+        using x86_64::Condition;
+        using x86_64::Reg;
+
+        emitter_.Clear();
+        for (const Reg reg : calleeSaved) {
+            emitter_.Push(reg);
+        }
+        for (std::uint8_t slot = 0; slot < pinned.size(); slot++) {
+            emitter_.LoadByte(pinned[slot], context, static_cast<std::uint8_t>(offsetof(JitContext, registers) + slot));
+        }
+
+        const auto loopStart  = emitter_.Here();
+        std::size_t translated = 0;
+        std::uint32_t cycles  = 0;
+        for (const MicroOp &microOp : block.microOps) {
+            // Counted up to and including the instruction being translated, for stores leaving the block early
+            retiredInstructions_ = static_cast<std::uint32_t>(translated + 1);
+            retiredCycles_       = cycles + microOp.cycles;
+            if (EndsBasicBlock(microOp.opcode) || !Translate(microOp)) {
+                break;
+            }
+            translated++;
+            cycles += microOp.cycles;
+        }
+        if (translated == 0 && !IsTranslatableJump(block.microOps.front().opcode)) {
+            return nullptr;
+        }
+
+        const MicroOp *const terminator
+            = translated < block.microOps.size() ? &block.microOps[translated] : nullptr;
+        if (terminator != nullptr && IsTranslatableJump(terminator->opcode)) {
+            // Each path bumps the counters once, at its own cost
+            const std::uint16_t target = terminator->operand;
+            std::optional<x86_64::Emitter::Label> taken;
+            if (terminator->opcode != static_cast<std::uint8_t>(opcodes::JMP)) {
+                taken = BranchIfCondition(DestinationField(terminator->opcode));
+                AccountBlock(static_cast<std::uint32_t>(translated + 1), cycles + terminator->cycles);
+                ExitTo(terminator->nextPc);
+            }
+            if (taken.has_value()) {
+                emitter_.Patch(taken.value(), emitter_.Here());
+            }
+            cycles += instructionCyclesTaken[terminator->opcode];
+            AccountBlock(static_cast<std::uint32_t>(translated + 1), cycles);
+            if (target == block.startAddress) {
+                // Loop while another iteration stays within the budget
+                emitter_.LoadQword(Reg::RAX, context, offsetof(JitContext, cycles));
+                emitter_.AddImmediate64(Reg::RAX, cycles);
+                emitter_.CompareQword(Reg::RAX, context, offsetof(JitContext, endCycle));
+                emitter_.JumpIfTo(Condition::B, loopStart);
+            }
+            ExitTo(target);
+        } else {
+            AccountBlock(static_cast<std::uint32_t>(translated), cycles);
+            ExitTo(terminator != nullptr ? static_cast<std::uint16_t>(terminator->nextPc
+                                               - instructionLength[terminator->opcode])
+                                         : block.microOps.back().nextPc);
+        }
+
+        // Shared epilogue
+        const auto epilogue = emitter_.Here();
+        for (const auto exit : exits_) {
+            emitter_.Patch(exit, epilogue);
+        }
+        exits_.clear();
+        for (std::uint8_t slot = 0; slot < pinned.size(); slot++) {
+            emitter_.StoreByte(
+                context, static_cast<std::uint8_t>(offsetof(JitContext, registers) + slot), pinned[slot]);
+        }
+        for (auto reg = calleeSaved.rbegin(); reg != calleeSaved.rend(); reg++) {
+            emitter_.Pop(*reg);
+        }
+        emitter_.Ret();
+
+        const void *const code = arena_.Commit(emitter_.GetCode());
+        if (code == nullptr) {
+            return nullptr;
+        }
+        compiledBlocks_++;
+        return reinterpret_cast<NativeBlock>(const_cast<void *>(code));
+    }
+
+    // Discards all generated code, every NativeBlock handed out must be dropped first
+    auto Reset() noexcept -> void { arena_.Reset(); }
+
+    [[nodiscard]] auto IsFull() const noexcept -> bool { return arena_.GetUsed() > arenaSize - maxBlockCode; }
+
+    [[nodiscard]] auto GetCompiledBlockCount() const noexcept -> std::size_t { return compiledBlocks_; }
+
+private: // Functions/Methods
+    using Reg = x86_64::Reg;
+
+    // 8085 register code (B, C, D, E, H, L, M, A) to host register
+    [[nodiscard]] static constexpr auto Pinned(const std::uint8_t code) noexcept -> Reg
+    {
+        return code == 0b111 ? accumulator : pinned[code];
+    }
+
+    [[nodiscard]] static constexpr auto IsTranslatableJump(const std::uint8_t opcode) noexcept -> bool
+    {
+        return opcode == static_cast<std::uint8_t>(opcodes::JMP)
+            || (OpcodeGroup(opcode) == 0b11 && SourceField(opcode) == 0b010);
+    }
+
+    auto AccountBlock(const std::uint32_t instructions, const std::uint32_t cycles) noexcept -> void
+    {
+        emitter_.AddMemoryImmediate(context, offsetof(JitContext, cycles), cycles, true);
+        emitter_.AddMemoryImmediate(context, offsetof(JitContext, executed), instructions, false);
+    }
+
+    auto ExitTo(const std::uint16_t pc) noexcept -> void
+    {
+        emitter_.StoreWordImmediate(context, offsetof(JitContext, pc), pc);
+        exits_.push_back(emitter_.Jump());
+    }
+
+    // Conditions: 000 - NZ, 001 - Z, 010 - NC, 011 - C, 100 - PO, 101 - PE, 110 - P, 111 - M
+    [[nodiscard]] auto BranchIfCondition(const std::uint8_t condition) noexcept -> x86_64::Emitter::Label
+    {
+        constexpr std::array<std::uint8_t, 4> masks = {
+            StatusRegister::zeroFlag,
+            StatusRegister::carryFlag,
+            StatusRegister::parityFlag,
+            StatusRegister::signFlag,
+        };
+        emitter_.TestImmediate8(flags, masks[condition >> 1]);
+        return emitter_.JumpIf((condition & 0x01) ? x86_64::Condition::NZ : x86_64::Condition::Z);
+    }
+
+    // Moves the x86 flags of the last operation into the 8085 flags register.
+    // Flags in keepMask keep their old value, the rest come from resultMask with xorMask/orMask patching them up.
+    auto MergeFlags(const std::uint8_t resultMask, const std::uint8_t xorMask = 0, const std::uint8_t orMask = 0,
+        const std::uint8_t keepMask = 0) noexcept -> void
+    {
+        using x86_64::AluOp;
+        emitter_.LoadFlagsToEax();
+        if (xorMask != 0) {
+            emitter_.AluImmediate32(AluOp::XOR, Reg::RAX, xorMask);
+        }
+        emitter_.AluImmediate32(AluOp::AND, Reg::RAX, resultMask);
+        if (orMask != 0) {
+            emitter_.AluImmediate32(AluOp::OR, Reg::RAX, orMask);
+        }
+        if (keepMask == 0) {
+            emitter_.Mov32(flags, Reg::RAX);
+        } else {
+            emitter_.AluImmediate32(AluOp::AND, flags, keepMask);
+            emitter_.Or32(flags, Reg::RAX);
+        }
+    }
+
+    // Only CY changes, taken from the x86 carry
+    auto MergeCarry() noexcept -> void
+    {
+        emitter_.SetCarry8(Reg::RAX);
+        emitter_.AluImmediate8(x86_64::AluOp::AND, flags, static_cast<std::uint8_t>(~StatusRegister::carryFlag));
+        emitter_.Alu8(x86_64::AluOp::OR, flags, Reg::RAX);
+    }
+
+    // Byte at the address in ECX to dst, which may not be RAX, RCX or RDX. Clobbers RCX.
+    auto EmitLoad(const Reg dst) noexcept -> void
+    {
+        constexpr auto attributes = static_cast<std::uint8_t>(
+            static_cast<std::uint8_t>(PageAttribute::Device) | static_cast<std::uint8_t>(PageAttribute::Watch));
+        const auto slowPath = LookUpPage(attributes);
+        emitter_.LoadByteIndexed(dst, Reg::RAX, Reg::RDX);
+        const auto done = emitter_.Jump();
+
+        emitter_.Patch(slowPath, emitter_.Here());
+        emitter_.Mov32(Reg::RSI, Reg::RCX);
+        CallOut(reinterpret_cast<std::uintptr_t>(&ReadMemory));
+        emitter_.Mov8(dst, Reg::RAX);
+        emitter_.Patch(done, emitter_.Here());
+    }
+
+    // src to the address in ECX, src may not be RAX, RCX or RDX. Clobbers RCX. Leaves the block for nextPc if the
+    // store dirtied code or requested a stop.
+    auto EmitStore(const Reg src, const std::uint16_t nextPc) noexcept -> void
+    {
+        const auto slowPath = LookUpPage(0xFF);
+        emitter_.StoreByteIndexed(Reg::RAX, Reg::RDX, src);
+        const auto done = emitter_.Jump();
+
+        emitter_.Patch(slowPath, emitter_.Here());
+        emitter_.ZeroExtend8(Reg::RDX, src);
+        emitter_.Mov32(Reg::RSI, Reg::RCX);
+        emitter_.MovImmediate32(Reg::RCX, retiredCycles_);
+        CallOut(reinterpret_cast<std::uintptr_t>(&WriteMemory));
+        emitter_.TestImmediate8(Reg::RAX, 0xFF);
+        const auto clean = emitter_.JumpIf(x86_64::Condition::Z);
+        AccountBlock(retiredInstructions_, retiredCycles_);
+        ExitTo(nextPc);
+        emitter_.Patch(clean, emitter_.Here());
+        emitter_.Patch(done, emitter_.Here());
+    }
+
+    // Branches off if the page of the address in ECX has any of attributes set, otherwise leaves the page in RAX and
+    // the offset into it in RDX
+    [[nodiscard]] auto LookUpPage(const std::uint8_t attributes) noexcept -> x86_64::Emitter::Label
+    {
+        emitter_.Mov32(Reg::RDX, Reg::RCX);
+        emitter_.ShiftRight32(Reg::RDX, 8);
+        emitter_.LoadQword(Reg::RAX, context, offsetof(JitContext, pageAttributes));
+        emitter_.TestByteIndexed(Reg::RAX, Reg::RDX, attributes);
+        const auto slowPath = emitter_.JumpIf(x86_64::Condition::NZ);
+        emitter_.LoadQword(Reg::RAX, context, offsetof(JitContext, pages));
+        emitter_.LoadQwordIndexed(Reg::RAX, Reg::RAX, Reg::RDX);
+        emitter_.ZeroExtend8(Reg::RDX, Reg::RCX);
+        return slowPath;
+    }
+
+    // Calls helper(context, ESI, EDX, ECX). B, C, D and E are pinned to caller saved registers and are kept in the
+    // context across the call, the stack is 16 byte aligned by the push of the context.
+    auto CallOut(const std::uintptr_t helper) noexcept -> void
+    {
+        for (std::uint8_t slot = 0; slot < 4; slot++) {
+            emitter_.StoreByte(
+                context, static_cast<std::uint8_t>(offsetof(JitContext, registers) + slot), pinned[slot]);
+        }
+        emitter_.Push(context);
+        emitter_.MovImmediate64(Reg::RAX, helper);
+        emitter_.CallRegister(Reg::RAX);
+        emitter_.Pop(context);
+        for (std::uint8_t slot = 0; slot < 4; slot++) {
+            emitter_.LoadByte(pinned[slot], context, static_cast<std::uint8_t>(offsetof(JitContext, registers) + slot));
+        }
+    }
+
+    static auto ReadMemory(JitContext *context, const std::uint32_t address) noexcept -> std::uint8_t
+    {
+        return context->processor->memory.Read(static_cast<std::uint16_t>(address));
+    }
+
+    // True if the write dirtied code or a device requested a stop. The journal reads the cycle count of the writing
+    // instruction off the state.
+    static auto WriteMemory(JitContext *context, const std::uint32_t address, const std::uint32_t value,
+        const std::uint32_t cycles) noexcept -> bool
+    {
+        ProcessorState &state = *context->processor;
+        state.cycles          = context->cycles + cycles;
+        state.memory.Write(static_cast<std::uint16_t>(address), static_cast<std::uint8_t>(value));
+        return state.memory.HasDirtyCode() || state.stopRequested;
+    }
+
+    // Loads pair 00 - BC, 01 - DE, 10 - HL into the 16 bit scratch register
+    auto LoadPair(const Reg scratch, const std::uint8_t pair) noexcept -> void
+    {
+        emitter_.ZeroExtend8(scratch, pinned[pair * 2U]);
+        emitter_.ShiftLeft32(scratch, 8);
+        emitter_.Alu8(x86_64::AluOp::OR, scratch, pinned[pair * 2U + 1U]);
+    }
+
+    auto StorePair(const std::uint8_t pair, const Reg scratch) noexcept -> void
+    {
+        emitter_.Mov8(pinned[pair * 2U + 1U], scratch);
+        emitter_.ShiftRight32(scratch, 8);
+        emitter_.Mov8(pinned[pair * 2U], scratch);
+    }
+
+    [[nodiscard]] auto TranslateAlu(const std::uint8_t operation, const std::optional<Reg> source,
+        const std::uint8_t immediate) noexcept -> bool
+    {
+        using x86_64::AluOp;
+        // 000 - ADD, 001 - ADC, 010 - SUB, 011 - SBB, 100 - ANA, 101 - XRA, 110 - ORA, 111 - CMP
+        constexpr std::array<AluOp, 8> operations
+            = { AluOp::ADD, AluOp::ADC, AluOp::SUB, AluOp::SBB, AluOp::AND, AluOp::XOR, AluOp::OR, AluOp::CMP };
+        if (operation == 0b001 || operation == 0b011) {
+            emitter_.BitTest32(flags, 0);
+        }
+        if (source.has_value()) {
+            emitter_.Alu8(operations[operation], accumulator, source.value());
+        } else {
+            emitter_.AluImmediate8(operations[operation], accumulator, immediate);
+        }
+        if (operation <= 0b001) {
+            MergeFlags(StatusRegister::flagsMask);
+        } else if (operation <= 0b011 || operation == 0b111) {
+            // The 8085 sets AC when the low nibble does not borrow
+            MergeFlags(StatusRegister::flagsMask, StatusRegister::auxCarryFlag);
+        } else {
+            // x86 leaves AF undefined after logical operations, ANA sets AC while XRA and ORA clear it
+            MergeFlags(StatusRegister::flagsMask & ~StatusRegister::auxCarryFlag, 0,
+                operation == 0b100 ? StatusRegister::auxCarryFlag : 0);
+        }
+        return true;
+    }
+
+    // Emits the native code for a single instruction, false if it has to be left to the interpreter
+    [[nodiscard]] auto Translate(const MicroOp &microOp) noexcept -> bool
+    {
+        const std::uint8_t opcode = microOp.opcode;
+        const std::uint8_t high3  = DestinationField(opcode);
+        const std::uint8_t low3   = SourceField(opcode);
+        const std::uint8_t pair   = RegisterPairField(opcode);
+        const auto         byte   = static_cast<std::uint8_t>(microOp.operand);
+
+        // Ahead of the groups, the ALU immediate case below turns down the rest of group 11
+        if (opcode == static_cast<std::uint8_t>(opcodes::XCHG)) {
+            emitter_.Xchg8(pinned[2], pinned[4]);
+            emitter_.Xchg8(pinned[3], pinned[5]);
+            return true;
+        }
+        switch (OpcodeGroup(opcode)) {
+        case 0b01: // MOV r, r
+            if (high3 == 0b110 || low3 == 0b110) {
+                LoadPair(Reg::RCX, 0b10);
+                if (low3 == 0b110) {
+                    EmitLoad(Pinned(high3));
+                } else {
+                    EmitStore(Pinned(low3), microOp.nextPc);
+                }
+            } else if (high3 != low3) {
+                emitter_.Mov8(Pinned(high3), Pinned(low3));
+            }
+            return true;
+        case 0b10: // ALU r
+            if (low3 == 0b110) {
+                LoadPair(Reg::RCX, 0b10);
+                EmitLoad(Reg::RSI);
+                return TranslateAlu(high3, Reg::RSI, 0);
+            }
+            return TranslateAlu(high3, Pinned(low3), 0);
+        case 0b11: // ALU immediate
+            return low3 == 0b110 && TranslateAlu(high3, std::nullopt, byte);
+        default:
+            break;
+        }
+
+        // M operands are worked on in SIL
+        const std::uint8_t allButCarry = StatusRegister::flagsMask & ~StatusRegister::carryFlag;
+        const Reg          operand     = high3 == 0b110 ? Reg::RSI : Pinned(high3);
+        switch (low3) {
+        case 0b100: // INR
+        case 0b101: // DCR
+            if (high3 == 0b110) {
+                LoadPair(Reg::RCX, 0b10);
+                EmitLoad(operand);
+            }
+            if (low3 == 0b100) {
+                emitter_.Increment8(operand);
+                MergeFlags(allButCarry, 0, 0, StatusRegister::carryFlag);
+            } else {
+                emitter_.Decrement8(operand);
+                MergeFlags(allButCarry, StatusRegister::auxCarryFlag, 0, StatusRegister::carryFlag);
+            }
+            if (high3 == 0b110) {
+                LoadPair(Reg::RCX, 0b10);
+                EmitStore(operand, microOp.nextPc);
+            }
+            return true;
+        case 0b110: // MVI
+            emitter_.MovImmediate8(operand, byte);
+            if (high3 == 0b110) {
+                LoadPair(Reg::RCX, 0b10);
+                EmitStore(operand, microOp.nextPc);
+            }
+            return true;
+        case 0b111:
+            return TranslateAccumulator(high3);
+        default:
+            break;
+        }
+
+        if (opcode == static_cast<std::uint8_t>(opcodes::NOP)) {
+            return true;
+        }
+        if (low3 == 0b010) {
+            return TranslateTransfer(microOp);
+        }
+        // Register pair instructions, SP is not pinned
+        if (pair == 0b11) {
+            return false;
+        }
+        switch (opcode & 0x0F) {
+        case 0x01: // LXI
+            emitter_.MovImmediate8(pinned[pair * 2U], static_cast<std::uint8_t>(microOp.operand >> 8));
+            emitter_.MovImmediate8(pinned[pair * 2U + 1U], byte);
+            return true;
+        case 0x03: // INX
+        case 0x0B: // DCX
+            LoadPair(Reg::RCX, pair);
+            if ((opcode & 0x0F) == 0x03) {
+                emitter_.Increment16(Reg::RCX);
+            } else {
+                emitter_.Decrement16(Reg::RCX);
+            }
+            StorePair(pair, Reg::RCX);
+            return true;
+        case 0x09: // DAD
+            LoadPair(Reg::RCX, 0b10);
+            LoadPair(Reg::RDX, pair);
+            emitter_.Add16(Reg::RCX, Reg::RDX);
+            MergeCarry();
+            StorePair(0b10, Reg::RCX);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // STAX, LDAX, SHLD, LHLD, STA, LDA
+    [[nodiscard]] auto TranslateTransfer(const MicroOp &microOp) noexcept -> bool
+    {
+        const std::uint8_t pair = RegisterPairField(microOp.opcode);
+        const bool         load = (microOp.opcode & 0x08) != 0;
+        if (pair == 0b10) {
+            // SHLD is left to the interpreter, a store to code leaves the block and must not come between its bytes
+            if (!load) {
+                return false;
+            }
+            emitter_.MovImmediate32(Reg::RCX, microOp.operand);
+            EmitLoad(pinned[5]);
+            emitter_.MovImmediate32(Reg::RCX, static_cast<std::uint16_t>(microOp.operand + 1));
+            EmitLoad(pinned[4]);
+            return true;
+        }
+        if (pair == 0b11) {
+            emitter_.MovImmediate32(Reg::RCX, microOp.operand);
+        } else {
+            LoadPair(Reg::RCX, pair);
+        }
+        if (load) {
+            EmitLoad(accumulator);
+        } else {
+            EmitStore(accumulator, microOp.nextPc);
+        }
+        return true;
+    }
+
+    // 000 - RLC, 001 - RRC, 010 - RAL, 011 - RAR, 100 - DAA, 101 - CMA, 110 - STC, 111 - CMC
+    [[nodiscard]] auto TranslateAccumulator(const std::uint8_t operation) noexcept -> bool
+    {
+        using x86_64::AluOp;
+        switch (operation) {
+        case 0b000:
+        case 0b001:
+        case 0b010:
+        case 0b011:
+            if (operation >= 0b010) {
+                emitter_.BitTest32(flags, 0);
+            }
+            emitter_.Rotate8(operation, accumulator);
+            MergeCarry();
+            return true;
+        case 0b101:
+            emitter_.Not8(accumulator);
+            return true;
+        case 0b110:
+            emitter_.AluImmediate8(AluOp::OR, flags, StatusRegister::carryFlag);
+            return true;
+        case 0b111:
+            emitter_.AluImmediate8(AluOp::XOR, flags, StatusRegister::carryFlag);
+            return true;
+        default: // DAA, looked up in the interpreter's table
+            emitter_.ZeroExtend8(Reg::RAX, flags);
+            emitter_.Mov32(Reg::RDX, Reg::RAX);
+            emitter_.AluImmediate32(AluOp::AND, Reg::RAX, StatusRegister::carryFlag);
+            emitter_.ShiftLeft32(Reg::RAX, 9);
+            emitter_.AluImmediate32(AluOp::AND, Reg::RDX, StatusRegister::auxCarryFlag);
+            emitter_.ShiftLeft32(Reg::RDX, 4);
+            emitter_.Or32(Reg::RAX, Reg::RDX);
+            emitter_.ZeroExtend8(Reg::RDX, accumulator);
+            emitter_.Or32(Reg::RAX, Reg::RDX);
+            emitter_.MovImmediate64(
+                Reg::RDX, reinterpret_cast<std::uintptr_t>(StatusRegister::GetDecimalAdjustTable()));
+            emitter_.ZeroExtendWordIndexed(Reg::RAX, Reg::RDX, Reg::RAX);
+            emitter_.Mov8(accumulator, Reg::RAX);
+            emitter_.ShiftRight32(Reg::RAX, 8);
+            emitter_.Mov8(flags, Reg::RAX);
+            return true;
+        }
+    }
+
+public: // Data Members
+    // Executions of a block before it gets translated
+    static constexpr std::uint32_t threshold = 32;
+
+private: // Data Members
+    static constexpr std::size_t arenaSize    = 0x100000;
+    static constexpr std::size_t maxBlockCode = 0x4000;
+
+    static constexpr Reg context     = Reg::RDI;
+    static constexpr Reg accumulator = Reg::R14;
+    static constexpr Reg flags       = Reg::R15;
+
+    // Same order as JitContext::registers
+    static constexpr std::array<Reg, 8> pinned
+        = { Reg::R8, Reg::R9, Reg::R10, Reg::R11, Reg::R12, Reg::R13, Reg::R14, Reg::R15 };
+    static constexpr std::array<Reg, 4> calleeSaved = { Reg::R12, Reg::R13, Reg::R14, Reg::R15 };
+
+    x86_64::Emitter                      emitter_;
+    x86_64::ExecutableArena              arena_ { arenaSize };
+    std::vector<x86_64::Emitter::Label>  exits_;
+    std::size_t                          compiledBlocks_      = 0;
+    std::uint32_t                        retiredInstructions_ = 0;
+    std::uint32_t                        retiredCycles_       = 0;
+};
+
+#endif
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef INTERPRETER_8085_LITTLE_ENDIAN_HPP
+#define INTERPRETER_8085_LITTLE_ENDIAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace intel_8085 {
+
+// Fixed width fields of the binary file formats, stored little endian whatever the host
+template <typename Value>
+auto StoreLittleEndian(const std::span<std::uint8_t> bytes, const std::size_t offset, const Value value) noexcept
+    -> void
+{
+    for (std::size_t index = 0; index < sizeof(Value); index++) {
+        bytes[offset + index] = static_cast<std::uint8_t>(value >> (8 * index));
+    }
+}
+
+template <typename Value>
+[[nodiscard]] auto LoadLittleEndian(const std::span<const std::uint8_t> bytes, const std::size_t offset) noexcept
+    -> Value
+{
+    Value value = 0;
+    for (std::size_t index = 0; index < sizeof(Value); index++) {
+        value = static_cast<Value>(value | static_cast<Value>(bytes[offset + index]) << (8 * index));
+    }
+    return value;
+}
+
+} // namespace intel_8085
+
+#endif
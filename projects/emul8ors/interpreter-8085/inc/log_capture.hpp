@@ -0,0 +1,69 @@
+#ifndef INTERPRETER_8085_LOG_CAPTURE_HPP
+#define INTERPRETER_8085_LOG_CAPTURE_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/dist_sink.h"
+#include "spdlog/spdlog.h"
+
+namespace intel_8085 {
+
+// Collects what the calling thread logs while it is alive instead of printing it, so that code reporting problems
+// through spdlog can run on many threads at once and have its errors attributed to the job at hand.
+// Warnings and errors are kept in order, everything less severe is dropped. Other threads keep logging as usual.
+class LogCapture {
+public: // Functions/Methods
+    LogCapture() noexcept : previous_(std::exchange(active_, &messages_)) {}
+
+    LogCapture(const LogCapture &)                     = delete;
+    auto operator=(const LogCapture &) -> LogCapture & = delete;
+
+    ~LogCapture() { active_ = previous_; }
+
+    [[nodiscard]] auto GetMessages() const noexcept -> const std::vector<std::string> & { return messages_; }
+
+    [[nodiscard]] auto TakeMessages() noexcept -> std::vector<std::string> { return std::move(messages_); }
+
+    // Routes the default logger through the capturing sink, call once before logging from worker threads
+    static auto Install() -> void
+    {
+        const auto logger = spdlog::default_logger();
+        if (logger->sinks().size() == 1 && std::dynamic_pointer_cast<Sink>(logger->sinks().front()) != nullptr) {
+            return;
+        }
+        auto sink = std::make_shared<Sink>(logger->sinks());
+        logger->sinks().assign({ std::move(sink) });
+    }
+
+private: // Functions/Methods
+    // Forwards to the sinks it replaced unless the logging thread has a capture
+    class Sink : public spdlog::sinks::dist_sink<spdlog::details::null_mutex> {
+    public: // Functions/Methods
+        explicit Sink(std::vector<spdlog::sink_ptr> sinks) : dist_sink(std::move(sinks)) {}
+
+    protected: // Functions/Methods
+        void sink_it_(const spdlog::details::log_msg &message) override
+        {
+            if (active_ == nullptr) {
+                dist_sink::sink_it_(message);
+            } else if (message.level >= spdlog::level::warn) {
+                active_->emplace_back(message.payload.begin(), message.payload.end());
+            }
+        }
+    };
+
+public:  // Data Members
+private: // Data Members
+    std::vector<std::string>  messages_;
+    std::vector<std::string> *previous_;
+
+    static inline thread_local std::vector<std::string> *active_ = nullptr;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef INTERPRETER_8085_MAPPED_FILE_HPP
+#define INTERPRETER_8085_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INTERPRETER_8085_HAS_MMAP 1
+#else
+#define INTERPRETER_8085_HAS_MMAP 0
+#endif
+
+namespace intel_8085 {
+
+// Read-write private mapping of a whole file, writes through it never reach the file.
+// Files are read into a buffer where mmap is not available.
+class MappedFile {
+public: // Functions/Methods
+    [[nodiscard]] static auto Open(const std::string &filename) noexcept -> std::shared_ptr<MappedFile>
+    {
+        auto file = std::make_shared<MappedFile>();
+#if INTERPRETER_8085_HAS_MMAP
+        const int descriptor = ::open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return nullptr;
+        }
+        struct stat status {};
+        if (::fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            file->size_ = static_cast<std::size_t>(status.st_size);
+            void *data  = ::mmap(nullptr, file->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+            file->data_ = data == MAP_FAILED ? nullptr : static_cast<std::uint8_t *>(data);
+        }
+        ::close(descriptor);
+        if (file->data_ == nullptr) {
+            return nullptr;
+        }
+#else
+        std::ifstream stream(filename, std::ios::binary);
+        file->buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        if (!stream.eof() || file->buffer_.empty()) {
+            return nullptr;
+        }
+        file->data_ = file->buffer_.data();
+        file->size_ = file->buffer_.size();
+#endif
+        return file;
+    }
+
+    MappedFile() noexcept                              = default;
+    MappedFile(const MappedFile &)                     = delete;
+    auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+    ~MappedFile()
+    {
+#if INTERPRETER_8085_HAS_MMAP
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+#endif
+    }
+
+    [[nodiscard]] auto GetBytes() const noexcept -> std::span<std::uint8_t> { return { data_, size_ }; }
+
+private: // Data Members
+    std::uint8_t *data_ = nullptr;
+    std::size_t   size_ = 0;
+#if !INTERPRETER_8085_HAS_MMAP
+    std::vector<std::uint8_t> buffer_;
+#endif
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef INTERPRETER_8085_MEMORY_INSPECTOR_HPP
+#define INTERPRETER_8085_MEMORY_INSPECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "program_image.hpp"
+#include "system_memory.hpp"
+
+// Comparing memory 16 bytes at a time relies on SSE2, which every x86-64 host has
+#if defined(__SSE2__) && !defined(INTERPRETER_8085_NO_SIMD)
+#define INTERPRETER_8085_HAS_SSE2 1
+#include <emmintrin.h>
+#else
+#define INTERPRETER_8085_HAS_SSE2 0
+#endif
+
+namespace intel_8085 {
+
+// A run of addresses, both ends included
+struct MemoryRange {
+    std::uint16_t startAddress = 0x0000;
+    std::uint16_t endAddress   = 0x0000;
+};
+
+// Hex      - rows of the memory dump, 16 bytes each with their ASCII, covering the rows the ranges touch
+// Raw      - the bytes themselves, range after range
+// IntelHex - data records of up to 16 bytes and the end of file record, loadable as a program
+enum class ExportFormat : std::uint8_t { Hex, Raw, IntelHex };
+
+// Compares memory images, e.g. the final memory of a job against a golden image, reporting only the ranges which
+// differ. Pages shared copy-on-write by both images are equal without looking at them, every other page is compared
+// a 16 byte vector at a time into a bitmap of the bytes which differ, which the ranges are read off of.
+class MemoryInspector {
+public: // Functions/Methods
+    // Replaces the contents of ranges with the ranges of bytes which differ, in address order. Reusing the vector
+    // from one call to the next saves allocating it.
+    static auto Diff(const SystemMemory &left, const SystemMemory &right, std::vector<MemoryRange> &ranges) noexcept
+        -> void
+    {
+        ranges.clear();
+        for (std::size_t page = 0; page < 0x100; page++) {
+            const std::uint8_t *leftPage  = left.GetPage(static_cast<std::uint8_t>(page)).data();
+            const std::uint8_t *rightPage = right.GetPage(static_cast<std::uint8_t>(page)).data();
+            if (leftPage == rightPage) {
+                continue;
+            }
+            const std::array<std::uint64_t, 4> differences = ComparePage(leftPage, rightPage);
+            for (std::size_t word = 0; word < differences.size(); word++) {
+                AddRanges(ranges, page * SystemMemory::pageSize + word * 64, differences[word]);
+            }
+        }
+    }
+
+    [[nodiscard]] static auto IsEqual(const SystemMemory &left, const SystemMemory &right) noexcept -> bool
+    {
+        for (std::size_t page = 0; page < 0x100; page++) {
+            const std::uint8_t *leftPage  = left.GetPage(static_cast<std::uint8_t>(page)).data();
+            const std::uint8_t *rightPage = right.GetPage(static_cast<std::uint8_t>(page)).data();
+            if (leftPage != rightPage && ComparePage(leftPage, rightPage) != std::array<std::uint64_t, 4> {}) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private: // Functions/Methods
+    // Bitmap of the bytes of the page which differ, bit n of word w standing for byte 64 * w + n
+    [[nodiscard]] static auto ComparePage(const std::uint8_t *left, const std::uint8_t *right) noexcept
+        -> std::array<std::uint64_t, 4>
+    {
+        std::array<std::uint64_t, 4> differences {};
+#if INTERPRETER_8085_HAS_SSE2
+        for (std::size_t offset = 0; offset < SystemMemory::pageSize; offset += 16) {
+            const __m128i leftBytes  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + offset));
+            const __m128i rightBytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + offset));
+            const auto equal = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(leftBytes, rightBytes)));
+            differences[offset / 64] |= static_cast<std::uint64_t>(~equal & 0xFFFF) << (offset % 64);
+        }
+#else
+        for (std::size_t offset = 0; offset < SystemMemory::pageSize; offset += sizeof(std::uint64_t)) {
+            std::uint64_t leftWord  = 0;
+            std::uint64_t rightWord = 0;
+            std::memcpy(&leftWord, left + offset, sizeof(leftWord));
+            std::memcpy(&rightWord, right + offset, sizeof(rightWord));
+            if (leftWord == rightWord) {
+                continue;
+            }
+            for (std::size_t byte = 0; byte < sizeof(std::uint64_t); byte++) {
+                if (left[offset + byte] != right[offset + byte]) {
+                    differences[offset / 64] |= std::uint64_t { 1 } << ((offset + byte) % 64);
+                }
+            }
+        }
+#endif
+        return differences;
+    }
+
+    // Appends the runs of set bits, extending the last range where a run continues it
+    static auto AddRanges(std::vector<MemoryRange> &ranges, const std::size_t base, std::uint64_t bits) noexcept
+        -> void
+    {
+        while (bits != 0) {
+            const int         skipped = std::countr_zero(bits);
+            const int         length  = std::countr_one(bits >> skipped);
+            const std::size_t start   = base + static_cast<std::size_t>(skipped);
+            const std::size_t end     = start + static_cast<std::size_t>(length) - 1;
+            if (!ranges.empty() && ranges.back().endAddress + std::size_t { 1 } == start) {
+                ranges.back().endAddress = static_cast<std::uint16_t>(end);
+            } else {
+                ranges.push_back({ static_cast<std::uint16_t>(start), static_cast<std::uint16_t>(end) });
+            }
+            bits = skipped + length < 64 ? bits & (~std::uint64_t { 0 } << (skipped + length)) : 0;
+        }
+    }
+
+public:  // Data Members
+private: // Data Members
+};
+
+// Writes ranges of memory to a stream in one of the ExportFormats. Everything is formatted in place into a buffer
+// allocated once and handed to the stream whenever it fills up, so exporting costs no allocation per row and one
+// stream write per bufferSize bytes. Memory is read around devices.
+class MemoryExporter {
+public: // Functions/Methods
+    MemoryExporter() : buffer_(bufferSize) { }
+
+    [[nodiscard]] auto Write(std::ostream &outStream, const SystemMemory &memory, const MemoryRange range,
+        const ExportFormat format) noexcept -> bool
+    {
+        return Write(outStream, memory, std::span<const MemoryRange>(&range, 1), format);
+    }
+
+    // Ranges in address order, as MemoryInspector::Diff() gives them
+    [[nodiscard]] auto Write(std::ostream &outStream, const SystemMemory &memory,
+        const std::span<const MemoryRange> ranges, const ExportFormat format) noexcept -> bool
+    {
+        outStream_ = &outStream;
+        used_      = 0;
+        nextRow_   = 0;
+        for (const MemoryRange &range : ranges) {
+            switch (format) {
+            case ExportFormat::Hex:
+                WriteHexRows(memory, range);
+                break;
+            case ExportFormat::Raw:
+                WriteRaw(memory, range);
+                break;
+            case ExportFormat::IntelHex:
+                WriteIntelHexRecords(memory, range);
+                break;
+            }
+        }
+        if (format == ExportFormat::IntelHex) {
+            AppendHexRecord(0x0000, ProgramImage::hexEndOfFile, {});
+        }
+        Flush();
+        return !outStream.fail();
+    }
+
+private: // Functions/Methods
+    // Room for length more characters
+    [[nodiscard]] auto Reserve(const std::size_t length) noexcept -> char *
+    {
+        if (buffer_.size() - used_ < length) {
+            Flush();
+        }
+        return buffer_.data() + used_;
+    }
+
+    auto Flush() noexcept -> void
+    {
+        outStream_->write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+    // Rows shared by two ranges are written once
+    auto WriteHexRows(const SystemMemory &memory, const MemoryRange range) noexcept -> void
+    {
+        std::array<std::uint8_t, 0x10> row {};
+        for (std::uint32_t address = std::max<std::uint32_t>(range.startAddress & 0xFFF0, nextRow_);
+             address <= range.endAddress; address += 0x10) {
+            memory.ReadBlock(static_cast<std::uint16_t>(address), row);
+            char *end = SystemMemory::FormatDumpRow(static_cast<std::uint16_t>(address), row,
+                Reserve(SystemMemory::dumpRowLength));
+            used_    = static_cast<std::size_t>(end - buffer_.data());
+            nextRow_ = address + 0x10;
+        }
+    }
+
+    auto WriteRaw(const SystemMemory &memory, const MemoryRange range) noexcept -> void
+    {
+        for (std::uint32_t address = range.startAddress; address <= range.endAddress;) {
+            const std::size_t length = std::min<std::size_t>(range.endAddress + 1U - address, bufferSize);
+            char             *out    = Reserve(length);
+            memory.ReadBlock(static_cast<std::uint16_t>(address),
+                std::span<std::uint8_t>(reinterpret_cast<std::uint8_t *>(out), length));
+            used_ += length;
+            address += static_cast<std::uint32_t>(length);
+        }
+    }
+
+    auto WriteIntelHexRecords(const SystemMemory &memory, const MemoryRange range) noexcept -> void
+    {
+        constexpr std::size_t                  recordLength = ProgramImage::hexRecordLength;
+        std::array<std::uint8_t, recordLength> data {};
+        for (std::uint32_t address = range.startAddress; address <= range.endAddress; address += recordLength) {
+            const std::size_t length = std::min<std::size_t>(range.endAddress + 1U - address, recordLength);
+            memory.ReadBlock(static_cast<std::uint16_t>(address), std::span(data).first(length));
+            AppendHexRecord(
+                static_cast<std::uint16_t>(address), ProgramImage::hexData, std::span(data).first(length));
+        }
+    }
+
+    auto AppendHexRecord(const std::uint16_t address, const std::uint8_t type,
+        const std::span<const std::uint8_t> data) noexcept -> void
+    {
+        char *const start = Reserve(ProgramImage::maxHexRecordSize);
+        used_ += static_cast<std::size_t>(ProgramImage::FormatHexRecord(address, type, data, start) - start);
+    }
+
+public:  // Data Members
+    static constexpr std::size_t bufferSize = 0x10000;
+
+private: // Data Members
+    std::vector<char> buffer_;
+    std::size_t       used_      = 0;
+    std::uint32_t     nextRow_   = 0;
+    std::ostream     *outStream_ = nullptr;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef INTERPRETER_8085_PACER_HPP
+#define INTERPRETER_8085_PACER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace intel_8085 {
+
+// Unthrottled - runs as fast as the host allows
+// RealTime    - keeps the emulated clock in step with the wall clock
+enum class Pacing : std::uint8_t { Unthrottled, RealTime };
+
+// Stock 8085 systems run at 3.072 MHz off a 6.144 MHz crystal
+constexpr double defaultClockFrequency = 3.072e6;
+
+// Paces execution run in slices against the wall clock.
+// Every slice runs at full speed, after it the pacer sleeps until the wall clock has caught up with the T-states
+// executed so far, so timing calls are made once per slice rather than once per instruction. If the host falls
+// behind by more than a few slices, e.g. because the process was suspended, the lost time is written off instead
+// of being made up for by a burst of unpaced slices.
+class Pacer {
+public: // Functions/Methods
+    Pacer(const double clockFrequency, const std::uint64_t startCycle) noexcept
+        : clockFrequency_(clockFrequency),
+          sliceCycles_(std::max<std::uint64_t>(1, static_cast<std::uint64_t>(clockFrequency * sliceSeconds))),
+          epochCycle_(startCycle), epoch_(Clock::now())
+    {
+    }
+
+    // T-states to run before the next call to Wait
+    [[nodiscard]] auto GetSliceCycles() const noexcept -> std::uint64_t { return sliceCycles_; }
+
+    // Sleeps until the wall clock reaches the time the clock would take to run up to cycle
+    auto Wait(const std::uint64_t cycle) noexcept -> void
+    {
+        const auto target = epoch_
+            + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                static_cast<double>(cycle - epochCycle_) / clockFrequency_));
+        const auto now = Clock::now();
+        if (now - target > std::chrono::duration<double>(maxLagSeconds)) {
+            epoch_      = now;
+            epochCycle_ = cycle;
+        } else if (target > now) {
+            std::this_thread::sleep_until(target);
+        }
+    }
+
+private: // Functions/Methods
+    using Clock = std::chrono::steady_clock;
+
+public:  // Data Members
+private: // Data Members
+    static constexpr double sliceSeconds  = 0.002;
+    static constexpr double maxLagSeconds = 0.05;
+
+    double            clockFrequency_;
+    std::uint64_t     sliceCycles_;
+    std::uint64_t     epochCycle_;
+    Clock::time_point epoch_;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef INTERPRETER_8085_PERIPHERALS_HPP
+#define INTERPRETER_8085_PERIPHERALS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "device_bus.hpp"
+#include "event_scheduler.hpp"
+#include "interrupt_controller.hpp"
+
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <unistd.h>
+#define INTERPRETER_8085_HAS_POSIX_IO 1
+#else
+#define INTERPRETER_8085_HAS_POSIX_IO 0
+#endif
+
+namespace intel_8085 {
+
+// Serial port on two consecutive ports, after the data and status registers of an 8251:
+//   offset 0, data: reading takes the received byte, writing transmits a byte
+//   offset 1, status: bit 0 TxRDY, always set as transmission never stalls, bit 1 RxRDY, set while a byte waits
+// Received bytes come from a host file or named pipe and transmitted ones go to another. The input is read without
+// blocking, and at most once per character time while nothing is buffered, so a program spinning on the status
+// register does not make a system call per IN.
+class UartDevice final : public Device {
+public: // Functions/Methods
+    explicit UartDevice(const std::uint64_t cyclesPerCharacter = defaultCyclesPerCharacter) noexcept
+        : cyclesPerCharacter_(cyclesPerCharacter)
+    {
+    }
+
+    UartDevice(const UartDevice &)                     = delete;
+    auto operator=(const UartDevice &) -> UartDevice & = delete;
+
+    ~UartDevice() override
+    {
+#if INTERPRETER_8085_HAS_POSIX_IO
+        if (input_ >= 0) {
+            ::close(input_);
+        }
+#endif
+    }
+
+    // Either path may be empty for no input or no output. Opening an output pipe waits for its reader.
+    [[nodiscard]] auto Open(const std::string &input, const std::string &output) noexcept -> bool
+    {
+        if (!input.empty()) {
+#if INTERPRETER_8085_HAS_POSIX_IO
+            input_ = ::open(input.c_str(), O_RDONLY | O_NONBLOCK);
+            if (input_ < 0) {
+#else
+            input_.open(input, std::ios::binary);
+            if (!input_.is_open()) {
+#endif
+                spdlog::error("Could not open {} as the UART input", input);
+                return false;
+            }
+        }
+        if (!output.empty()) {
+            output_.open(output, std::ios::binary | std::ios::trunc);
+            if (!output_.is_open()) {
+                spdlog::error("Could not open {} as the UART output", output);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto In(const std::uint8_t port, const std::uint64_t cycle) noexcept -> std::uint8_t override
+    {
+        const bool received = Poll(cycle);
+        if (port == statusPort) {
+            return static_cast<std::uint8_t>(txReady | (received ? rxReady : 0x00));
+        }
+        return received ? received_[receivedHead_++] : 0x00;
+    }
+
+    // The output is flushed at every line feed
+    auto Out(const std::uint8_t port, const std::uint8_t value, const std::uint64_t /*cycle*/) noexcept
+        -> void override
+    {
+        if (port == dataPort && output_.is_open()) {
+            output_.put(static_cast<char>(value));
+            if (value == '\n') {
+                output_.flush();
+            }
+        }
+    }
+
+private: // Functions/Methods
+    // True while a received byte waits, reads the host input once the buffer ran empty and a character time passed
+    [[nodiscard]] auto Poll(const std::uint64_t cycle) noexcept -> bool
+    {
+        if (receivedHead_ < receivedCount_) {
+            return true;
+        }
+        if (cycle < nextPoll_) {
+            return false;
+        }
+        nextPoll_      = cycle + cyclesPerCharacter_;
+        receivedHead_  = 0;
+        receivedCount_ = 0;
+#if INTERPRETER_8085_HAS_POSIX_IO
+        if (input_ >= 0) {
+            const ::ssize_t count = ::read(input_, received_.data(), received_.size());
+            receivedCount_        = count > 0 ? static_cast<std::size_t>(count) : 0;
+        }
+#else
+        if (input_.is_open()) {
+            receivedCount_ = static_cast<std::size_t>(
+                input_.readsome(reinterpret_cast<char *>(received_.data()), received_.size()));
+        }
+#endif
+        return receivedCount_ > 0;
+    }
+
+public: // Data Members
+    static constexpr std::uint8_t dataPort   = 0x00;
+    static constexpr std::uint8_t statusPort = 0x01;
+    static constexpr std::uint8_t txReady    = 0x01;
+    static constexpr std::uint8_t rxReady    = 0x02;
+
+    // A 10 bit frame at 9600 baud on a 3.072 MHz clock
+    static constexpr std::uint64_t defaultCyclesPerCharacter = 3200;
+
+private: // Data Members
+#if INTERPRETER_8085_HAS_POSIX_IO
+    int input_ = -1;
+#else
+    std::ifstream input_;
+#endif
+    std::ofstream                 output_;
+    std::array<std::uint8_t, 256> received_ {};
+    std::size_t                   receivedHead_  = 0;
+    std::size_t                   receivedCount_ = 0;
+    std::uint64_t                 nextPoll_      = 0;
+    std::uint64_t                 cyclesPerCharacter_;
+};
+
+// Interval timer on three consecutive ports, loosely after the timer of an 8155:
+//   offset 0 and 1, count low and high: writing sets the reload value, reading gives the current count
+//   offset 2, control and status: writing bit 0 starts (1) or stops (0) the timer, reading gives bit 0 running and
+//   bit 7 terminal count, which is set once the count wrapped since the last status read and cleared by the read
+// A running timer counts down once every prescaler T-states from reload - 1 to 0 and starts over, a reload value of 0
+// standing for 0x10000. Nothing runs between accesses, the count is derived from the cycle count of the access.
+// A connected timer raises its interrupt line every time the count wraps, through events scheduled at the wraps.
+class TimerDevice final : public Device {
+public: // Functions/Methods
+    explicit TimerDevice(const std::uint64_t prescaler = 1) noexcept : prescaler_(std::max<std::uint64_t>(prescaler, 1))
+    {
+    }
+
+    [[nodiscard]] auto In(const std::uint8_t port, const std::uint64_t cycle) noexcept -> std::uint8_t override
+    {
+        switch (port) {
+        case countLowPort:
+            return static_cast<std::uint8_t>(GetCount(cycle));
+        case countHighPort:
+            return static_cast<std::uint8_t>(GetCount(cycle) >> 8);
+        case controlPort: {
+            if (!running_) {
+                return 0x00;
+            }
+            const std::uint64_t wraps    = GetElapsedCounts(cycle) / GetPeriod();
+            const bool          terminal = wraps > wrapsSeen_;
+            wrapsSeen_                   = wraps;
+            return static_cast<std::uint8_t>(running | (terminal ? terminalCount : 0x00));
+        }
+        default:
+            return 0xFF;
+        }
+    }
+
+    // Raises line at every wrap from the next start of the timer on, e.g. InterruptLine::Rst75
+    auto Connect(EventScheduler &scheduler, InterruptController &interrupts, const InterruptLine line) noexcept -> void
+    {
+        scheduler_  = &scheduler;
+        interrupts_ = &interrupts;
+        line_       = line;
+    }
+
+    auto Out(const std::uint8_t port, const std::uint8_t value, const std::uint64_t cycle) noexcept -> void override
+    {
+        switch (port) {
+        case countLowPort:
+            reload_ = static_cast<std::uint16_t>((reload_ & 0xFF00) | value);
+            break;
+        case countHighPort:
+            reload_ = static_cast<std::uint16_t>((reload_ & 0x00FF) | value << 8);
+            break;
+        case controlPort:
+            // Events scheduled before a restart or stop find the generation changed and do nothing
+            generation_++;
+            if (value & running) {
+                start_     = cycle;
+                wrapsSeen_ = 0;
+                running_   = true;
+                ScheduleWrap(cycle + GetPeriod() * prescaler_);
+            } else if (running_) {
+                stoppedCount_ = GetCount(cycle);
+                running_      = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // T-states from the cycle given until the count next wraps, only meaningful while the timer runs
+    [[nodiscard]] auto GetCyclesToWrap(const std::uint64_t cycle) const noexcept -> std::uint64_t
+    {
+        const std::uint64_t period = GetPeriod();
+        return (period - GetElapsedCounts(cycle) % period) * prescaler_ - (cycle - start_) % prescaler_;
+    }
+
+    [[nodiscard]] auto IsRunning() const noexcept -> bool { return running_; }
+
+private: // Functions/Methods
+    auto ScheduleWrap(const std::uint64_t cycle) noexcept -> void
+    {
+        if (scheduler_ == nullptr) {
+            return;
+        }
+        scheduler_->Schedule(cycle, [this, generation = generation_](const std::uint64_t wrapCycle) {
+            if (generation == generation_) {
+                interrupts_->Raise(line_);
+                ScheduleWrap(wrapCycle + GetPeriod() * prescaler_);
+            }
+        });
+    }
+
+    [[nodiscard]] auto GetPeriod() const noexcept -> std::uint64_t { return reload_ == 0 ? 0x10000 : reload_; }
+
+    [[nodiscard]] auto GetElapsedCounts(const std::uint64_t cycle) const noexcept -> std::uint64_t
+    {
+        return (cycle - start_) / prescaler_;
+    }
+
+    [[nodiscard]] auto GetCount(const std::uint64_t cycle) const noexcept -> std::uint16_t
+    {
+        if (!running_) {
+            return stoppedCount_;
+        }
+        return static_cast<std::uint16_t>(GetPeriod() - 1 - GetElapsedCounts(cycle) % GetPeriod());
+    }
+
+public: // Data Members
+    static constexpr std::uint8_t countLowPort  = 0x00;
+    static constexpr std::uint8_t countHighPort = 0x01;
+    static constexpr std::uint8_t controlPort   = 0x02;
+    static constexpr std::uint8_t running       = 0x01;
+    static constexpr std::uint8_t terminalCount = 0x80;
+
+private: // Data Members
+    std::uint64_t prescaler_;
+    std::uint64_t start_        = 0;
+    std::uint64_t wrapsSeen_    = 0;
+    std::uint16_t reload_       = 0;
+    std::uint64_t generation_   = 0;
+    std::uint16_t stoppedCount_ = 0;
+    bool          running_      = false;
+
+    EventScheduler      *scheduler_  = nullptr;
+    InterruptController *interrupts_ = nullptr;
+    InterruptLine        line_       = InterruptLine::Rst75;
+};
+
+// Memory mapped character display, one byte per cell, row after row from the start of its region.
+// Addresses past the last cell read 0xFF and ignore writes.
+class DisplayBuffer final : public Device {
+public: // Functions/Methods
+    explicit DisplayBuffer(const std::size_t columns = 40, const std::size_t rows = 25) noexcept
+        : columns_(std::max<std::size_t>(columns, 1)), cells_(columns_ * rows, ' ')
+    {
+    }
+
+    [[nodiscard]] auto Read(const std::uint16_t offset) noexcept -> std::uint8_t override
+    {
+        return offset < cells_.size() ? cells_[offset] : 0xFF;
+    }
+
+    auto Write(const std::uint16_t offset, const std::uint8_t value) noexcept -> void override
+    {
+        if (offset < cells_.size()) {
+            cells_[offset] = value;
+            dirty_         = true;
+        }
+    }
+
+    // Pages of the region to map the display at
+    [[nodiscard]] auto GetPageCount() const noexcept -> std::size_t { return (cells_.size() + 0xFF) / 0x100; }
+
+    // Set by writes since the last Render()
+    [[nodiscard]] auto IsDirty() const noexcept -> bool { return dirty_; }
+
+    // One line per row without trailing blanks, unprintable cells show as blanks
+    auto Render(std::ostream &outStream) noexcept -> void
+    {
+        std::string line;
+        for (std::size_t row = 0; row < cells_.size() / columns_; row++) {
+            line.clear();
+            for (std::size_t column = 0; column < columns_; column++) {
+                const std::uint8_t cell = cells_[row * columns_ + column];
+                line.push_back(std::isprint(cell) ? static_cast<char>(cell) : ' ');
+            }
+            line.erase(line.find_last_not_of(' ') + 1);
+            outStream << line << '\n';
+        }
+        dirty_ = false;
+    }
+
+private: // Data Members
+    std::size_t               columns_;
+    std::vector<std::uint8_t> cells_;
+    bool                      dirty_ = false;
+};
+
+} // namespace intel_8085
+
+#endif
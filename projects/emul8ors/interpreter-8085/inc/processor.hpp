@@ -1,78 +1,453 @@
 #ifndef INTERPRETER_8085_PROCESSOR_HPP
 #define INTERPRETER_8085_PROCESSOR_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
 #include "spdlog/spdlog.h"
 
+#include "event_scheduler.hpp"
+#include "execution_history.hpp"
+#include "execution_trace.hpp"
 #include "execution_unit.hpp"
+#include "interrupt_controller.hpp"
+#include "pacer.hpp"
+#include "processor_state.hpp"
+#include "profiler.hpp"
+#include "program_image.hpp"
 #include "program_loader.hpp"
-#include "register.hpp"
-#include "status_register.hpp"
-#include "system_memory.hpp"
+#include "snapshot.hpp"
 
 namespace intel_8085 {
 
-class Processor {
+// Profiler is NullProfiler, which compiles instrumentation out altogether, or anything hooking every instruction and
+// every accepted interrupt through an enabled flag and the Record and Interrupt methods, i.e. ExecutionProfiler or
+// ExecutionTracer. An instrumented processor steps through the handler table one instruction at a time whatever the
+// dispatch mode, so that every instruction is seen.
+// Runs are split at the events of the EventScheduler, interrupts are only looked at between runs and whenever an
+// instruction or a device requests a stop.
+// Breakpoints and watchpoints are only seen by uninstrumented processors.
+template <typename Profiler = NullProfiler>
+class BasicProcessor {
 public: // Functions/Methods
-    // Processor()
-    Processor()
+    BasicProcessor() = default;
+
+    // Starts off as a copy of another processor's state. Memory pages are shared copy-on-write, so forking a
+    // processor with a program loaded costs a page table copy. Nothing decoded by the other processor carries over.
+    explicit BasicProcessor(const ProcessorState &state) noexcept : state_(state)
     {
-        a_.SetContext(systemMemory_, status_);
-        b_.SetContext(systemMemory_, status_);
-        c_.SetContext(systemMemory_, status_);
-        d_.SetContext(systemMemory_, status_);
-        e_.SetContext(systemMemory_, status_);
-        h_.SetContext(systemMemory_, status_);
-        l_.SetContext(systemMemory_, status_);
-        pc_.SetContext(systemMemory_, status_);
-        sp_.SetContext(systemMemory_, status_);
+        executionUnit_.FlushCaches(state_.memory);
     }
 
+    // The scheduler and the interrupt controller refer to the state
+    BasicProcessor(const BasicProcessor &)                     = delete;
+    auto operator=(const BasicProcessor &) -> BasicProcessor & = delete;
+
     // ~Processor()
 
     // LoadProgram()
+    // Takes a program image, an Intel HEX file or a .program file
     [[nodiscard]] auto LoadProgram(const std::string &filename) noexcept -> bool
     {
-        return ProgramLoader::Load(systemMemory_, filename);
+        std::uint16_t entryPoint = 0x0000;
+        bool          loaded     = false;
+        if (ProgramImage::IsImage(filename)) {
+            loaded = ProgramImage::LoadImage(state_.memory, filename, entryPoint);
+        } else if (ProgramImage::IsIntelHex(filename)) {
+            loaded = ProgramImage::LoadIntelHex(state_.memory, filename, entryPoint);
+        } else {
+            loaded = ProgramLoader::Load(state_.memory, filename, entryPoint);
+        }
+        if (!loaded) {
+            return false;
+        }
+        executionUnit_.FlushCaches(state_.memory);
+        state_.registers.SetPc(entryPoint);
+        state_.halted = false;
+        Prebuild();
+        history_.Restart();
+        return true;
+    }
+
+    // Reset()
+    // Returns to a copy of another state, e.g. a program just loaded into a fresh state.
+    // The flag evaluation mode is kept and the decoded code is kept where it is unchanged. Scheduled events and
+    // devices are left alone. The execution history starts over.
+    auto Reset(const ProcessorState &initial) noexcept -> void
+    {
+        Restore(initial);
+        history_.Restart();
+    }
+
+    // Writes the whole machine state to a binary save state file
+    [[nodiscard]] auto SaveSnapshot(const std::string &filename) const noexcept -> bool
+    {
+        return Snapshot::Save(state_, filename);
+    }
+
+    // Continues from a save state, which maps the file instead of reading it
+    [[nodiscard]] auto LoadSnapshot(const std::string &filename) noexcept -> bool
+    {
+        if (!Snapshot::Load(state_, filename)) {
+            return false;
+        }
+        Prebuild();
+        history_.Restart();
+        return true;
+    }
+
+    // Connects the devices of a bus to port I/O and to the memory pages mapped on it, nullptr disconnects them.
+    // The bus is not owned and stays attached across Reset() and LoadSnapshot(), as does a copy of the state.
+    auto AttachBus(DeviceBus *bus) noexcept -> void
+    {
+        state_.memory.AttachBus(bus);
+        executionUnit_.FlushCaches(state_.memory);
     }
 
+    [[nodiscard]] auto GetMemory() noexcept -> SystemMemory & { return state_.memory; }
+
+    // Devices schedule their events and raise their interrupts here
+    [[nodiscard]] auto GetScheduler() noexcept -> EventScheduler & { return scheduler_; }
+
+    [[nodiscard]] auto GetInterruptController() noexcept -> InterruptController & { return interrupts_; }
+
     // Run()
+    // Returns the number of instructions executed before halting for good or running out of the cycle budget.
+    // A halted processor idles until the next event as long as an interrupt may still wake it, i.e. while one is
+    // deliverable or an event is scheduled, which may raise TRAP whatever the interrupt enable. The cycle budget is in
+    // T-states, the paced and unthrottled runs execute exactly the same instructions.
+    // A run also ends at a breakpoint or after a watched access, see GetDebugStop().
+    auto Run(std::uint64_t cycleBudget = std::numeric_limits<std::uint64_t>::max()) noexcept -> std::uint64_t
+    {
+        BeginRun();
+        if (pacing_ == Pacing::Unthrottled) {
+            return RunFor(cycleBudget);
+        }
+        return RunPaced(cycleBudget);
+    }
+
+    // Real-time pacing runs at clockFrequency T-states per second, which is ignored when unthrottled
+    auto SetPacing(const Pacing pacing, const double clockFrequency = defaultClockFrequency) noexcept -> void
+    {
+        pacing_         = pacing;
+        clockFrequency_ = clockFrequency;
+    }
+
+    // T-states elapsed since reset
+    [[nodiscard]] auto GetCycles() const noexcept -> std::uint64_t { return state_.cycles; }
+
+    auto SetDispatchMode(const DispatchMode dispatchMode) noexcept -> void
+    {
+        executionUnit_.SetDispatchMode(dispatchMode);
+    }
+
+    // Eager evaluation computes every flag as it is set, meant for checking the lazy flags against
+    auto SetFlagEvaluation(const FlagEvaluation evaluation) noexcept -> void
+    {
+        state_.status.SetFlagEvaluation(evaluation);
+    }
+
+    [[nodiscard]] auto IsHalted() const noexcept -> bool { return state_.halted; }
+
+    [[nodiscard]] auto GetState() const noexcept -> const ProcessorState & { return state_; }
+
+    [[nodiscard]] auto GetProfiler() noexcept -> Profiler & { return profiler_; }
+
+    // Debugger
+    // A run stops before the instruction at a breakpoint, unless the run starts at it, so that running again
+    // continues past the breakpoint last stopped at
+    auto SetBreakpoint(const std::uint16_t address) noexcept -> void
+    {
+        executionUnit_.SetBreakpoint(state_.memory, address);
+    }
+
+    auto ClearBreakpoint(const std::uint16_t address) noexcept -> void
+    {
+        executionUnit_.ClearBreakpoint(state_.memory, address);
+    }
+
+    // A run stops after the instruction making the first watched access, GetWatchHit() tells which
+    auto SetWatchpoint(const std::uint16_t address, const WatchKind kind = WatchKind::Write) noexcept -> void
+    {
+        state_.memory.SetWatchpoint(address, kind);
+    }
+
+    auto ClearWatchpoint(const std::uint16_t address, const WatchKind kind = WatchKind::Access) noexcept -> void
+    {
+        state_.memory.ClearWatchpoint(address, kind);
+    }
+
+    // Why the last run ended early, DebugStop::None if it did not end at a breakpoint or a watchpoint
+    [[nodiscard]] auto GetDebugStop() const noexcept -> DebugStop { return executionUnit_.GetDebugStop(); }
+
+    [[nodiscard]] auto GetWatchHit() const noexcept -> const std::optional<WatchHit> &
+    {
+        return state_.memory.GetWatchHit();
+    }
+
+    // Executes a single instruction, unpaced. A step which accepts an interrupt stops at its vector instead.
+    // Returns the number of instructions executed.
+    auto Step() noexcept -> std::uint64_t
+    {
+        BeginRun();
+        return RunFor(1);
+    }
+
+    // Runs until PC reaches address, like Run() with a breakpoint there for the duration of the run
+    auto RunTo(const std::uint16_t address,
+        const std::uint64_t cycleBudget = std::numeric_limits<std::uint64_t>::max()) noexcept -> std::uint64_t
+    {
+        const bool armed = executionUnit_.HasBreakpoint(address);
+        if (!armed) {
+            SetBreakpoint(address);
+        }
+        const std::uint64_t executed = Run(cycleBudget);
+        if (!armed) {
+            ClearBreakpoint(address);
+        }
+        return executed;
+    }
+
+    [[nodiscard]] auto GetRegisters() const noexcept -> const RegisterFile & { return state_.registers; }
+
+    auto SetRegisters(const RegisterFile &registers) noexcept -> void { state_.registers = registers; }
+
+    [[nodiscard]] auto GetFlags() const noexcept -> std::uint8_t { return state_.status.GetFlags(); }
+
+    auto SetFlags(const std::uint8_t flags) noexcept -> void { state_.status.SetFlags(flags); }
+
+    // Reverse execution
+    // Records a checkpoint every interval T-states and journals every memory write in between, keeping the last
+    // maxCheckpoints. Going back replays from a checkpoint, which is exact as long as the program depends on nothing
+    // but its memory and registers: devices and scheduled events are not rolled back. Breakpoints and watchpoints
+    // are ignored while replaying.
+    auto EnableHistory(const std::uint64_t interval = ExecutionHistory::defaultInterval,
+        const std::size_t maxCheckpoints = ExecutionHistory::defaultMaxCheckpoints) noexcept -> void
+    {
+        history_.Enable(interval, maxCheckpoints);
+    }
+
+    auto DisableHistory() noexcept -> void { history_.Disable(); }
+
+    // Goes back to before the last instruction executed, or interrupt accepted, returns false if the history does
+    // not reach back that far
+    auto StepBack() noexcept -> bool { return RewindBefore(state_.cycles); }
+
+    // Goes back to just before the last instruction which wrote to address, so that the next Step() makes the write.
+    // Returns false if no recorded write is left.
+    auto RunBackToWrite(const std::uint16_t address) noexcept -> bool
+    {
+        const std::optional<std::uint64_t> cycle = history_.FindLastWrite(address);
+        return cycle.has_value() && RewindBefore(*cycle);
+    }
 
     // DumpInfo()
     auto DumpInfo(std::uint16_t startAddress = 0x0000, std::uint16_t endAddress = 0xFFFF,
         std::ostream &outStream = std::clog) const noexcept -> void
     {
-        systemMemory_.DumpMemoryContent(startAddress, endAddress, outStream);
+        state_.memory.DumpMemoryContent(startAddress, endAddress, outStream);
     }
 
     // Shutdown()
 
 private: // Functions/Methods
+    // Decodes the code statically reachable from the PC and the interrupt vectors of a program just loaded, so that
+    // its first pass through hot code does not stall on decoding. Instrumented processors do not run decoded blocks.
+    auto Prebuild() noexcept -> void
+    {
+        if constexpr (!Profiler::enabled) {
+            const std::vector<std::uint16_t> entryPoints
+                = ControlFlowGraph::DefaultEntryPoints(state_.memory, state_.registers.GetPc());
+            executionUnit_.Prebuild(state_, ControlFlowGraph::Build(state_.memory, entryPoints));
+        }
+    }
+
+    auto Restore(const ProcessorState &initial) noexcept -> void
+    {
+        const FlagEvaluation evaluation = state_.status.GetFlagEvaluation();
+        state_.registers                = initial.registers;
+        state_.status                   = initial.status;
+        state_.status.SetFlagEvaluation(evaluation);
+        state_.cycles             = initial.cycles;
+        state_.interruptMask      = initial.interruptMask;
+        state_.interruptsEnabled  = initial.interruptsEnabled;
+        state_.interruptRequests  = initial.interruptRequests;
+        state_.interruptsDeferred = initial.interruptsDeferred;
+        state_.halted             = initial.halted;
+        state_.ports              = initial.ports;
+        state_.memory.RestoreFrom(initial.memory);
+    }
+
+    // Moves to the last instruction boundary before cycle. Where that boundary is only shows by stepping through
+    // the instructions before cycle, so this replays twice from the checkpoint: once to find the boundary and once
+    // to stop at it. The first replay may take checkpoints and drop the oldest, so this keeps its own copy.
+    auto RewindBefore(const std::uint64_t cycle) noexcept -> bool
+    {
+        const ProcessorState *found = history_.FindCheckpoint(cycle);
+        if (found == nullptr) {
+            return false;
+        }
+        const ProcessorState checkpoint = *found;
+        Restore(checkpoint);
+        history_.Truncate();
+        if (cycle - state_.cycles > maxStepCycles) {
+            Replay(cycle - maxStepCycles);
+        }
+        std::uint64_t boundary = state_.cycles;
+        while (state_.cycles < cycle) {
+            boundary = state_.cycles;
+            BeginRun();
+            if (RunFor(1) == 0 && state_.cycles == boundary) {
+                break;
+            }
+        }
+
+        Restore(checkpoint);
+        history_.Truncate();
+        Replay(boundary);
+        BeginRun();
+        return true;
+    }
+
+    // Runs to the first instruction boundary at or past cycle, through any breakpoint or watchpoint
+    auto Replay(const std::uint64_t cycle) noexcept -> void
+    {
+        while (state_.cycles < cycle) {
+            const std::uint64_t start = state_.cycles;
+            BeginRun();
+            RunFor(cycle - state_.cycles);
+            if (state_.cycles == start) {
+                break;
+            }
+        }
+    }
+
+    // Forgets why the last run stopped and lets the new one start at a breakpoint
+    auto BeginRun() noexcept -> void
+    {
+        executionUnit_.ClearDebugStop();
+        executionUnit_.StepOverBreakpoint(state_.registers.GetPc());
+        state_.memory.ClearWatchHit();
+    }
+
+    auto RunFor(const std::uint64_t cycleBudget) noexcept -> std::uint64_t
+    {
+        const std::uint64_t remaining = std::numeric_limits<std::uint64_t>::max() - state_.cycles;
+        const std::uint64_t endCycle  = state_.cycles + std::min(cycleBudget, remaining);
+        std::uint64_t       executed  = 0;
+        while (state_.cycles < endCycle && !IsHaltedForGood() && !IsDebugStopped()) {
+            history_.Update();
+            AcceptInterrupt();
+            const std::uint64_t sliceEnd
+                = std::min({ scheduler_.GetNextCycle(), history_.GetNextCheckpoint(), endCycle });
+            if (state_.interruptsDeferred) {
+                // The instruction after EI runs before any maskable interrupt is accepted
+                executed += RunSlice(1);
+                state_.interruptsDeferred = false;
+            } else if (state_.halted) {
+                state_.cycles = std::max(state_.cycles, sliceEnd);
+            } else if (sliceEnd > state_.cycles) {
+                executed += RunSlice(sliceEnd - state_.cycles);
+            }
+            scheduler_.RunDue(state_.cycles);
+        }
+        return executed;
+    }
+
+    // Halted with nothing left to wake it up
+    [[nodiscard]] auto IsHaltedForGood() const noexcept -> bool
+    {
+        return state_.halted && !interrupts_.IsDeliverable() && scheduler_.IsEmpty();
+    }
+
+    [[nodiscard]] auto IsDebugStopped() const noexcept -> bool
+    {
+        return executionUnit_.GetDebugStop() != DebugStop::None;
+    }
+
+    auto AcceptInterrupt() noexcept -> void
+    {
+        const std::uint16_t returnAddress = state_.registers.GetPc();
+        if (interrupts_.Accept()) {
+            if constexpr (Profiler::enabled) {
+                profiler_.Interrupt(returnAddress, state_.registers.GetPc(), InterruptController::acceptCycles);
+            }
+        }
+    }
+
+    auto RunSlice(const std::uint64_t cycleBudget) noexcept -> std::uint64_t
+    {
+        if constexpr (Profiler::enabled) {
+            return RunProfiled(cycleBudget);
+        } else {
+            return executionUnit_.Run(state_, cycleBudget);
+        }
+    }
+
+    auto RunProfiled(const std::uint64_t cycleBudget) noexcept -> std::uint64_t
+    {
+        const std::uint64_t remaining = std::numeric_limits<std::uint64_t>::max() - state_.cycles;
+        const std::uint64_t endCycle  = state_.cycles + std::min(cycleBudget, remaining);
+        std::uint64_t       executed  = 0;
+        state_.stopRequested          = state_.halted;
+        while (!state_.stopRequested && state_.cycles < endCycle) {
+            const std::uint16_t pc      = state_.registers.GetPc();
+            const std::uint16_t sp      = state_.registers.GetSp();
+            const std::uint64_t start   = state_.cycles;
+            std::uint16_t       operand = 0;
+            const std::uint8_t  opcode  = ExecutionUnit::Step(state_, operand);
+            profiler_.Record(pc, opcode, operand, static_cast<std::uint32_t>(state_.cycles - start), sp, state_);
+            executed++;
+        }
+        return executed;
+    }
+
+    auto RunPaced(const std::uint64_t cycleBudget) noexcept -> std::uint64_t
+    {
+        const std::uint64_t remaining = std::numeric_limits<std::uint64_t>::max() - state_.cycles;
+        const std::uint64_t endCycle  = state_.cycles + std::min(cycleBudget, remaining);
+        Pacer               pacer(clockFrequency_, state_.cycles);
+        std::uint64_t       executed = 0;
+        while (state_.cycles < endCycle && !IsHaltedForGood() && !IsDebugStopped()) {
+            executed += RunFor(std::min(pacer.GetSliceCycles(), endCycle - state_.cycles));
+            pacer.Wait(state_.cycles);
+        }
+        return executed;
+    }
+
 public:  // Data Members
 private: // Data Members
-    // ExecutionUnit
-    [[maybe_unused]] ExecutionUnit executionUnit_;
+    // Neither an instruction nor accepting an interrupt takes longer
+    static constexpr std::uint64_t maxStepCycles
+        = std::max(*std::max_element(instructionCyclesTaken.begin(), instructionCyclesTaken.end()),
+            InterruptController::acceptCycles);
 
-    // Memory
-    SystemMemory systemMemory_;
+    // ExecutionUnit
+    ExecutionUnit executionUnit_;
 
-    // Status Register
-    StatusRegister status_;
+    // Memory, Status Register, Registers
+    ProcessorState state_;
 
-    // Registers
-    Register<std::uint8_t> a_ = { 0 };
-    Register<std::uint8_t> b_ = { 0 };
-    Register<std::uint8_t> c_ = { 0 };
-    Register<std::uint8_t> d_ = { 0 };
-    Register<std::uint8_t> e_ = { 0 };
-    Register<std::uint8_t> h_ = { 0 };
-    Register<std::uint8_t> l_ = { 0 };
+    EventScheduler      scheduler_ { state_ };
+    InterruptController interrupts_ { state_ };
+    ExecutionHistory    history_ { state_ };
 
-    Register<std::uint16_t> pc_ = { 0 };
-    Register<std::uint16_t> sp_ = { 0 };
+    // Profiler, empty unless profiling
+    [[no_unique_address]] Profiler profiler_;
 
-    // Clock?
+    // Clock
+    Pacing pacing_         = Pacing::Unthrottled;
+    double clockFrequency_ = defaultClockFrequency;
 };
 
+using Processor = BasicProcessor<>;
+
+using ProfilingProcessor = BasicProcessor<ExecutionProfiler>;
+
+using TracingProcessor = BasicProcessor<ExecutionTracer>;
+
 } // namespace intel_8085
 
 #endif
@@ -0,0 +1,51 @@
+#ifndef INTERPRETER_8085_PROCESSOR_STATE_HPP
+#define INTERPRETER_8085_PROCESSOR_STATE_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "register_file.hpp"
+#include "status_register.hpp"
+#include "system_memory.hpp"
+
+namespace intel_8085 {
+
+// Interrupt inputs in ascending priority, laid out like the mask bits of SIM and, shifted left by 4, the pending
+// bits of RIM. TRAP is not maskable.
+enum class InterruptLine : std::uint8_t { Rst55 = 0x01, Rst65 = 0x02, Rst75 = 0x04, Trap = 0x08 };
+
+// Architectural state of the processor, operated upon by the ExecutionUnit.
+// Everything touched by nearly every instruction shares the first cache line, memory follows.
+struct alignas(64) ProcessorState {
+    // Registers
+    RegisterFile registers;
+
+    // Status Register
+    StatusRegister status;
+
+    // Elapsed T-states since reset
+    std::uint64_t cycles = 0;
+
+    // Interrupt mask as set by SIM and read by RIM
+    std::uint8_t interruptMask     = 0x07;
+    bool         interruptsEnabled = false;
+    // Requested interrupts not accepted yet, one InterruptLine bit each
+    std::uint8_t interruptRequests = 0;
+    // Set by an EI finding requests, none of them is accepted before the instruction after the EI has run
+    bool interruptsDeferred = false;
+
+    bool halted = false;
+    // Ends a run after the current instruction, the run loops check nothing else between instructions.
+    // Set along with halted, and whenever an interrupt may have become deliverable.
+    bool stopRequested = false;
+
+    // Memory
+    SystemMemory memory;
+
+    // I/O ports, OUT latches a value which IN reads back
+    std::array<std::uint8_t, 0x100> ports = {};
+};
+
+} // namespace intel_8085
+
+#endif
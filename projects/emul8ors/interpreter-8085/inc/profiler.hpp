@@ -0,0 +1,326 @@
+#ifndef INTERPRETER_8085_PROFILER_HPP
+#define INTERPRETER_8085_PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "instruction_set.hpp"
+#include "processor_state.hpp"
+
+namespace intel_8085 {
+
+// Stands in for a profiler when none is wanted, a Processor instantiated with it compiles every hook away
+struct NullProfiler {
+    static constexpr bool enabled = false;
+};
+
+// Records where a guest program spends its time: executions and T-states per address, executions per opcode and
+// per pair of consecutive opcodes, and T-states per subroutine through a shadow call stack kept on CALL/Ccc/RST and
+// RET/Rcc. An accepted interrupt opens a frame for its vector like a call, which the RET ending the service routine
+// closes.
+// Calls and returns are told apart from not taken conditionals by the stack pointer moving, so a program
+// balancing its stack by hand (e.g. popping a return address) leaves the shadow stack in a frame too deep,
+// which the next unmatched return recovers from.
+// The call stacks form a tree of call paths, every node accumulating the T-states spent in it directly, which is
+// what WriteFoldedStacks writes out for flamegraph.pl and similar tools.
+class ExecutionProfiler {
+public: // Functions/Methods
+    static constexpr bool enabled = true;
+
+    ExecutionProfiler() : executions_(0x10000), cycles_(0x10000), opcodeAt_(0x10000), pairs_(0x10000) { Clear(); }
+
+    auto Clear() noexcept -> void
+    {
+        std::fill(executions_.begin(), executions_.end(), 0);
+        std::fill(cycles_.begin(), cycles_.end(), 0);
+        opcodes_.fill(0);
+        std::fill(pairs_.begin(), pairs_.end(), 0);
+        fallThrough_ = noAddress;
+        nodes_.assign(1, CallNode {});
+        current_       = 0;
+        depth_         = 0;
+        overflowDepth_ = 0;
+        started_       = false;
+    }
+
+    // Called after every instruction with the PC and SP it started from, its opcode and operand bytes and the
+    // T-states it took
+    auto Record(const std::uint16_t pc, const std::uint8_t opcode, const std::uint16_t /*operand*/,
+        const std::uint32_t cycles, const std::uint16_t sp, const ProcessorState &state) noexcept -> void
+    {
+        if (!started_) {
+            // The call tree is rooted at wherever execution started
+            nodes_[0].function = pc;
+            started_           = true;
+        }
+        executions_[pc]++;
+        cycles_[pc] += cycles;
+        opcodeAt_[pc] = opcode;
+        opcodes_[opcode]++;
+        // Only pairs of instructions next to each other in memory, the ones a decoder could fuse
+        if (pc == fallThrough_) {
+            pairs_[static_cast<std::size_t>(previousOpcode_ << 8 | opcode)]++;
+        }
+        previousOpcode_ = opcode;
+        fallThrough_    = static_cast<std::uint16_t>(pc + instructionLength[opcode]);
+        // The instruction itself is accounted to the frame it was executed in
+        nodes_[current_].selfCycles += cycles;
+
+        const std::uint16_t newSp = state.registers.GetSp();
+        if (IsCall(opcode) && newSp == static_cast<std::uint16_t>(sp - 2)) {
+            Enter(state.registers.GetPc());
+        } else if (IsReturn(opcode) && newSp == static_cast<std::uint16_t>(sp + 2)) {
+            Leave();
+        }
+    }
+
+    // Called once an interrupt has been accepted, with the address it returns to, the vector it jumped to and the
+    // T-states accepting it took
+    auto Interrupt(const std::uint16_t returnAddress, const std::uint16_t vector, const std::uint32_t cycles) noexcept
+        -> void
+    {
+        if (!started_) {
+            nodes_[0].function = returnAddress;
+            started_           = true;
+        }
+        // The next instruction is not reached from the one before, so it does not pair up with it
+        fallThrough_ = noAddress;
+        Enter(vector);
+        nodes_[current_].selfCycles += cycles;
+    }
+
+    [[nodiscard]] auto GetExecutions(const std::uint16_t address) const noexcept -> std::uint64_t
+    {
+        return executions_[address];
+    }
+
+    [[nodiscard]] auto GetCycles(const std::uint16_t address) const noexcept -> std::uint64_t
+    {
+        return cycles_[address];
+    }
+
+    [[nodiscard]] auto GetOpcodeCount(const std::uint8_t opcode) const noexcept -> std::uint64_t
+    {
+        return opcodes_[opcode];
+    }
+
+    // Times second ran right after first, straight from the address following it
+    [[nodiscard]] auto GetPairCount(const std::uint8_t first, const std::uint8_t second) const noexcept
+        -> std::uint64_t
+    {
+        return pairs_[static_cast<std::size_t>(first << 8 | second)];
+    }
+
+    // The topCount hottest addresses, opcodes, opcode pairs and subroutines
+    auto WriteReport(std::ostream &outStream, const std::size_t topCount = 20) const -> void
+    {
+        const std::uint64_t totalCycles = std::accumulate(cycles_.begin(), cycles_.end(), std::uint64_t { 0 });
+        const std::uint64_t totalExecutions
+            = std::accumulate(executions_.begin(), executions_.end(), std::uint64_t { 0 });
+        outStream << fmt::format("Profiled {} instructions, {} T-states\n", totalExecutions, totalCycles);
+
+        outStream << fmt::format("\nHot spots by T-states:\n{:>6}  {:<10} {:>14} {:>16} {:>7}\n", "Addr",
+            "Opcode", "Executions", "T-states", "%");
+        std::vector<std::uint16_t> addresses;
+        for (std::uint32_t address = 0; address < cycles_.size(); address++) {
+            if (executions_[address] != 0) {
+                addresses.push_back(static_cast<std::uint16_t>(address));
+            }
+        }
+        for (const std::uint16_t address :
+            Top(addresses, topCount, [&](const std::uint16_t at) { return cycles_[at]; })) {
+            outStream << fmt::format("{:#06x}  {:<10} {:>14} {:>16} {:>6.2f}%\n", address,
+                instructionMnemonic[opcodeAt_[address]], executions_[address], cycles_[address],
+                Percent(cycles_[address], totalCycles));
+        }
+
+        outStream << fmt::format("\nOpcodes by executions:\n{:>6}  {:<10} {:>14} {:>7}\n", "Opcode", "Mnemonic",
+            "Executions", "%");
+        std::vector<std::uint8_t> executedOpcodes;
+        for (std::uint32_t opcode = 0; opcode < opcodes_.size(); opcode++) {
+            if (opcodes_[opcode] != 0) {
+                executedOpcodes.push_back(static_cast<std::uint8_t>(opcode));
+            }
+        }
+        for (const std::uint8_t opcode :
+            Top(executedOpcodes, topCount, [&](const std::uint8_t code) { return opcodes_[code]; })) {
+            outStream << fmt::format("{:#04x}    {:<10} {:>14} {:>6.2f}%\n", opcode, instructionMnemonic[opcode],
+                opcodes_[opcode], Percent(opcodes_[opcode], totalExecutions));
+        }
+
+        outStream << fmt::format("\nOpcode pairs by executions:\n{:>6}  {:<21} {:>14} {:>7}\n", "Pair", "Mnemonics",
+            "Executions", "%");
+        std::vector<std::uint16_t> executedPairs;
+        for (std::uint32_t pair = 0; pair < pairs_.size(); pair++) {
+            if (pairs_[pair] != 0) {
+                executedPairs.push_back(static_cast<std::uint16_t>(pair));
+            }
+        }
+        for (const std::uint16_t pair :
+            Top(executedPairs, topCount, [&](const std::uint16_t code) { return pairs_[code]; })) {
+            outStream << fmt::format("{:#06x}  {:<10} {:<10} {:>14} {:>6.2f}%\n", pair, instructionMnemonic[pair >> 8],
+                instructionMnemonic[pair & 0xFF], pairs_[pair], Percent(pairs_[pair], totalExecutions));
+        }
+
+        const auto functions = GetFunctionProfiles();
+        outStream << fmt::format("\nSubroutines by inclusive T-states:\n{:>6}  {:>12} {:>16} {:>16} {:>7}\n",
+            "Addr", "Calls", "Self", "Inclusive", "%");
+        std::vector<std::size_t> indices(functions.size());
+        std::iota(indices.begin(), indices.end(), std::size_t { 0 });
+        for (const std::size_t index :
+            Top(indices, topCount, [&](const std::size_t i) { return functions[i].inclusiveCycles; })) {
+            const FunctionProfile &function = functions[index];
+            outStream << fmt::format("{:#06x}  {:>12} {:>16} {:>16} {:>6.2f}%\n", function.address, function.calls,
+                function.selfCycles, function.inclusiveCycles, Percent(function.inclusiveCycles, totalCycles));
+        }
+    }
+
+    // One line per call path, e.g. "0x1000;0x1234;0x1300 5120", weighted by the T-states spent in the innermost
+    auto WriteFoldedStacks(std::ostream &outStream) const -> void
+    {
+        for (std::uint32_t node = 0; node < nodes_.size(); node++) {
+            if (nodes_[node].selfCycles == 0) {
+                continue;
+            }
+            std::vector<std::uint16_t> path;
+            for (std::uint32_t frame = node; frame != noNode; frame = nodes_[frame].parent) {
+                path.push_back(nodes_[frame].function);
+            }
+            std::string line;
+            for (auto frame = path.rbegin(); frame != path.rend(); frame++) {
+                line += fmt::format("{}{:#06x}", line.empty() ? "" : ";", *frame);
+            }
+            outStream << fmt::format("{} {}\n", line, nodes_[node].selfCycles);
+        }
+    }
+
+private: // Functions/Methods
+    struct CallNode {
+        std::uint16_t                                        function   = 0x0000;
+        std::uint32_t                                        parent     = noNode;
+        std::uint64_t                                        calls      = 0;
+        std::uint64_t                                        selfCycles = 0;
+        std::vector<std::pair<std::uint16_t, std::uint32_t>> children; // Callee address and node
+    };
+
+    struct FunctionProfile {
+        std::uint16_t address         = 0x0000;
+        std::uint64_t calls           = 0;
+        std::uint64_t selfCycles      = 0;
+        std::uint64_t inclusiveCycles = 0; // Recursive calls are counted once
+    };
+
+    [[nodiscard]] static constexpr auto IsReturn(const std::uint8_t opcode) noexcept -> bool
+    {
+        return opcode == static_cast<std::uint8_t>(opcodes::RET)
+            || (OpcodeGroup(opcode) == 0b11 && SourceField(opcode) == 0b000);
+    }
+
+    auto Enter(const std::uint16_t function) -> void
+    {
+        if (overflowDepth_ > 0 || depth_ >= maxDepth) {
+            overflowDepth_++;
+            return;
+        }
+        auto &children = nodes_[current_].children;
+        auto  child    = std::find_if(children.begin(), children.end(),
+                [function](const auto &entry) { return entry.first == function; });
+        std::uint32_t next = 0;
+        if (child != children.end()) {
+            next = child->second;
+        } else {
+            next = static_cast<std::uint32_t>(nodes_.size());
+            children.emplace_back(function, next);
+            nodes_.push_back({ function, current_, 0, 0, {} });
+        }
+        nodes_[next].calls++;
+        current_ = next;
+        depth_++;
+    }
+
+    auto Leave() noexcept -> void
+    {
+        if (overflowDepth_ > 0) {
+            overflowDepth_--;
+        } else if (depth_ > 0) {
+            current_ = nodes_[current_].parent;
+            depth_--;
+        }
+    }
+
+    [[nodiscard]] auto GetFunctionProfiles() const -> std::vector<FunctionProfile>
+    {
+        std::vector<FunctionProfile> functions;
+        std::vector<std::uint32_t>   slot(0x10000, noNode);
+        const auto                   profile = [&](const std::uint16_t address) -> FunctionProfile & {
+            if (slot[address] == noNode) {
+                slot[address] = static_cast<std::uint32_t>(functions.size());
+                functions.push_back({ address, 0, 0, 0 });
+            }
+            return functions[slot[address]];
+        };
+        for (const CallNode &node : nodes_) {
+            FunctionProfile &function = profile(node.function);
+            function.calls += node.calls;
+            function.selfCycles += node.selfCycles;
+            // Every distinct function on the path of the node includes its T-states
+            std::vector<std::uint16_t> seen;
+            for (std::uint32_t frame = static_cast<std::uint32_t>(&node - nodes_.data()); frame != noNode;
+                 frame = nodes_[frame].parent) {
+                const std::uint16_t address = nodes_[frame].function;
+                if (std::find(seen.begin(), seen.end(), address) == seen.end()) {
+                    seen.push_back(address);
+                    profile(address).inclusiveCycles += node.selfCycles;
+                }
+            }
+        }
+        return functions;
+    }
+
+    template <typename Item, typename Key>
+    [[nodiscard]] static auto Top(std::vector<Item> items, const std::size_t count, Key key) -> std::vector<Item>
+    {
+        const auto end = items.begin() + static_cast<std::ptrdiff_t>(std::min(count, items.size()));
+        std::partial_sort(items.begin(), end, items.end(),
+            [&](const Item &left, const Item &right) { return key(left) > key(right); });
+        items.erase(end, items.end());
+        return items;
+    }
+
+    [[nodiscard]] static auto Percent(const std::uint64_t part, const std::uint64_t whole) noexcept -> double
+    {
+        return whole == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(whole);
+    }
+
+public:  // Data Members
+private: // Data Members
+    static constexpr std::uint32_t noNode   = 0xFFFFFFFF;
+    static constexpr std::size_t   maxDepth = 0x100;
+    // Outside of the address space, so that the first instruction does not pair up
+    static constexpr std::uint32_t noAddress = 0x10000;
+
+    std::vector<std::uint64_t>       executions_;
+    std::vector<std::uint64_t>       cycles_;
+    std::vector<std::uint8_t>        opcodeAt_; // Opcode last executed at each address
+    std::array<std::uint64_t, 0x100> opcodes_ {};
+    std::vector<std::uint64_t>       pairs_; // Indexed by first opcode << 8 | second opcode
+    std::uint32_t                    fallThrough_    = noAddress;
+    std::uint8_t                     previousOpcode_ = 0x00;
+    std::vector<CallNode>            nodes_;
+    std::uint32_t                    current_       = 0;
+    std::size_t                      depth_         = 0;
+    std::size_t                      overflowDepth_ = 0;
+    bool                             started_       = false;
+};
+
+} // namespace intel_8085
+
+#endif
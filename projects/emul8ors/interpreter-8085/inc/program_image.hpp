@@ -0,0 +1,324 @@
+#ifndef INTERPRETER_8085_PROGRAM_IMAGE_HPP
+#define INTERPRETER_8085_PROGRAM_IMAGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "little_endian.hpp"
+#include "mapped_file.hpp"
+#include "program.hpp"
+#include "program_loader.hpp"
+#include "system_memory.hpp"
+
+namespace intel_8085 {
+
+// Programs assembled down to the bytes they load into memory, so loading them costs a copy rather than a parse.
+// Two formats are supported:
+// Image     - binary, little endian. A 16 byte header (magic, version, entry point, segment count) followed by the
+//             segments, each a record of load address, reserved word and byte count, then the bytes themselves.
+//             Loading maps the file and copies the segments straight into memory.
+// Intel HEX - text interchange format, with the entry point in a start segment address (03) record.
+class ProgramImage {
+public: // Functions/Methods
+    // A run of bytes loaded at an address, the data section and the code section of a program each make one
+    struct Segment {
+        std::uint16_t             address = 0x0000;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    // Segments in load order, later segments win where they overlap
+    [[nodiscard]] static auto Assemble(const Program &program) noexcept -> std::vector<Segment>
+    {
+        return { { program.dataSection.startingAddress, program.dataSection.data },
+            { program.codeSection.startingAddress, ProgramLoader::AssembleCode(program.codeSection) } };
+    }
+
+    [[nodiscard]] static auto IsImage(const std::string &filename) noexcept -> bool
+    {
+        std::array<char, magic.size()> start {};
+        std::ifstream                  file(filename, std::ios::binary);
+        return file.read(start.data(), start.size()) && start == magic;
+    }
+
+    [[nodiscard]] static auto IsIntelHex(const std::string &filename) noexcept -> bool
+    {
+        return filename.ends_with(".hex") || filename.ends_with(".ihx");
+    }
+
+    // The image file contents of a program
+    [[nodiscard]] static auto EncodeImage(const Program &program) noexcept -> std::vector<std::uint8_t>
+    {
+        const auto segments = Assemble(program);
+
+        std::vector<std::uint8_t> bytes(headerSize);
+        std::memcpy(bytes.data(), magic.data(), magic.size());
+        StoreLittleEndian<std::uint32_t>(bytes, versionOffset, version);
+        StoreLittleEndian<std::uint16_t>(bytes, entryPointOffset, program.codeSection.startingAddress);
+        StoreLittleEndian<std::uint16_t>(bytes, segmentCountOffset, static_cast<std::uint16_t>(segments.size()));
+        for (const Segment &segment : segments) {
+            const std::size_t record = bytes.size();
+            bytes.resize(record + segmentHeaderSize);
+            StoreLittleEndian<std::uint16_t>(bytes, record, segment.address);
+            StoreLittleEndian<std::uint32_t>(bytes, record + 4, static_cast<std::uint32_t>(segment.bytes.size()));
+            bytes.insert(bytes.end(), segment.bytes.begin(), segment.bytes.end());
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] static auto WriteImage(const Program &program, const std::string &filename) noexcept -> bool
+    {
+        const auto    bytes = EncodeImage(program);
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            spdlog::error("Could not write the program image {}", filename);
+            return false;
+        }
+        return true;
+    }
+
+    // On success, entryPoint is set to the entry point recorded in the image
+    [[nodiscard]] static auto LoadImage(
+        SystemMemory &memory, const std::string &filename, std::uint16_t &entryPoint) noexcept -> bool
+    {
+        const auto file = MappedFile::Open(filename);
+        if (file == nullptr) {
+            spdlog::error("Could not read the program image {}", filename);
+            return false;
+        }
+        const std::span<const std::uint8_t> bytes = file->GetBytes();
+        if (bytes.size() < headerSize || std::memcmp(bytes.data(), magic.data(), magic.size()) != 0
+            || LoadLittleEndian<std::uint32_t>(bytes, versionOffset) != version) {
+            spdlog::error("{} is not a valid program image", filename);
+            return false;
+        }
+
+        // Check every record before writing anything, so a truncated image leaves memory untouched
+        const std::uint16_t segmentCount = LoadLittleEndian<std::uint16_t>(bytes, segmentCountOffset);
+        std::size_t         offset       = headerSize;
+        for (std::uint16_t segment = 0; segment < segmentCount; segment++) {
+            if (bytes.size() - offset < segmentHeaderSize) {
+                spdlog::error("Segment #{} of program image {} is truncated", segment, filename);
+                return false;
+            }
+            const std::size_t length = LoadLittleEndian<std::uint32_t>(bytes, offset + 4);
+            if (length > bytes.size() - offset - segmentHeaderSize || length > 0x10000) {
+                spdlog::error("Segment #{} of program image {} is truncated", segment, filename);
+                return false;
+            }
+            offset += segmentHeaderSize + length;
+        }
+
+        offset = headerSize;
+        for (std::uint16_t segment = 0; segment < segmentCount; segment++) {
+            const std::uint16_t address = LoadLittleEndian<std::uint16_t>(bytes, offset);
+            const std::size_t   length  = LoadLittleEndian<std::uint32_t>(bytes, offset + 4);
+            memory.WriteBlock(address, bytes.subspan(offset + segmentHeaderSize, length));
+            offset += segmentHeaderSize + length;
+        }
+        entryPoint = LoadLittleEndian<std::uint16_t>(bytes, entryPointOffset);
+        spdlog::info("Loaded program image {} into memory", filename);
+        return true;
+    }
+
+    // The Intel HEX text of a program
+    [[nodiscard]] static auto EncodeIntelHex(const Program &program) noexcept -> std::string
+    {
+        std::string                        text;
+        std::array<char, maxHexRecordSize> record {};
+        const auto append = [&text, &record](const std::uint16_t address, const std::uint8_t type,
+                                const std::span<const std::uint8_t> data) {
+            text.append(record.data(), FormatHexRecord(address, type, data, record.data()));
+        };
+        for (const Segment &segment : Assemble(program)) {
+            for (std::size_t offset = 0; offset < segment.bytes.size(); offset += hexRecordLength) {
+                const std::size_t length = std::min(hexRecordLength, segment.bytes.size() - offset);
+                append(static_cast<std::uint16_t>(segment.address + offset), hexData,
+                    std::span(segment.bytes).subspan(offset, length));
+            }
+        }
+        const std::uint16_t               entryPoint = program.codeSection.startingAddress;
+        const std::array<std::uint8_t, 4> startAddress
+            = { 0x00, 0x00, static_cast<std::uint8_t>(entryPoint >> 8), static_cast<std::uint8_t>(entryPoint) };
+        append(0x0000, hexStartSegmentAddress, startAddress);
+        append(0x0000, hexEndOfFile, {});
+        return text;
+    }
+
+    [[nodiscard]] static auto WriteIntelHex(const Program &program, const std::string &filename) noexcept -> bool
+    {
+        std::ofstream file(filename, std::ios::trunc);
+        file << EncodeIntelHex(program);
+        if (!file) {
+            spdlog::error("Could not write the Intel HEX file {}", filename);
+            return false;
+        }
+        return true;
+    }
+
+    // Reads data (00), end of file (01) and start address (03, 05) records. Without a start address record the
+    // entry point is the lowest address loaded. Extended address records must stay within the first 64 KiB.
+    [[nodiscard]] static auto LoadIntelHex(
+        SystemMemory &memory, const std::string &filename, std::uint16_t &entryPoint) noexcept -> bool
+    {
+        std::ifstream                stream(filename);
+        std::string                  line;
+        std::vector<Segment>         segments;
+        std::optional<std::uint16_t> startAddress;
+        std::size_t                  lineNumber = 0;
+        bool                         ended      = false;
+        while (!ended && std::getline(stream, line)) {
+            lineNumber++;
+            const std::string_view record = TrimRecord(line);
+            if (record.empty()) {
+                continue;
+            }
+            const auto bytes = DecodeHexRecord(record);
+            if (!bytes.has_value()) {
+                spdlog::error("Malformed Intel HEX record on line {} of {}", lineNumber, filename);
+                return false;
+            }
+            const std::span<const std::uint8_t> data(bytes->begin() + 4, bytes->end() - 1);
+            const auto address = static_cast<std::uint16_t>((*bytes)[1] << 8 | (*bytes)[2]);
+            switch ((*bytes)[3]) {
+            case hexData:
+                segments.push_back({ address, { data.begin(), data.end() } });
+                break;
+            case hexEndOfFile:
+                ended = true;
+                break;
+            case hexExtendedSegmentAddress:
+            case hexExtendedLinearAddress:
+                if (std::any_of(data.begin(), data.end(), [](const std::uint8_t b) { return b != 0; })) {
+                    spdlog::error("Line {} of {} addresses beyond 64 KiB", lineNumber, filename);
+                    return false;
+                }
+                break;
+            case hexStartSegmentAddress:
+            case hexStartLinearAddress:
+                if (data.size() != 4) {
+                    spdlog::error("Malformed start address on line {} of {}", lineNumber, filename);
+                    return false;
+                }
+                startAddress = static_cast<std::uint16_t>(data[2] << 8 | data[3]);
+                break;
+            default:
+                spdlog::error("Unknown Intel HEX record type {:#04x} on line {} of {}", (*bytes)[3], lineNumber,
+                    filename);
+                return false;
+            }
+        }
+        if (!ended || segments.empty()) {
+            spdlog::error("{} has no data or no end of file record", filename);
+            return false;
+        }
+
+        for (const Segment &segment : segments) {
+            memory.WriteBlock(segment.address, segment.bytes);
+        }
+        entryPoint = startAddress.value_or(
+            std::min_element(segments.begin(), segments.end(), [](const Segment &lhs, const Segment &rhs) {
+                return lhs.address < rhs.address;
+            })->address);
+        spdlog::info("Loaded Intel HEX file {} into memory", filename);
+        return true;
+    }
+
+    // Formats one Intel HEX record, checksum and newline included, into out and returns the end of it. Needs room for
+    // maxHexRecordSize characters, data holding up to hexRecordLength bytes.
+    [[nodiscard]] static auto FormatHexRecord(const std::uint16_t address, const std::uint8_t type,
+        const std::span<const std::uint8_t> data, char *out) noexcept -> char *
+    {
+        auto       checksum = static_cast<std::uint8_t>(data.size() + (address >> 8) + (address & 0xFF) + type);
+        const auto append   = [&out](const std::uint8_t byte) {
+            *out++ = hexDigits[byte >> 4];
+            *out++ = hexDigits[byte & 0x0F];
+        };
+
+        *out++ = ':';
+        append(static_cast<std::uint8_t>(data.size()));
+        append(static_cast<std::uint8_t>(address >> 8));
+        append(static_cast<std::uint8_t>(address));
+        append(type);
+        for (const std::uint8_t byte : data) {
+            append(byte);
+            checksum = static_cast<std::uint8_t>(checksum + byte);
+        }
+        append(static_cast<std::uint8_t>(-checksum));
+        *out++ = '\n';
+        return out;
+    }
+
+private: // Functions/Methods
+    // Drops surrounding whitespace, including the carriage return of files written on Windows
+    [[nodiscard]] static auto TrimRecord(const std::string_view line) noexcept -> std::string_view
+    {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    // Returns the record bytes, byte count through checksum, once the length and checksum check out
+    [[nodiscard]] static auto DecodeHexRecord(const std::string_view record) noexcept
+        -> std::optional<std::vector<std::uint8_t>>
+    {
+        if (record.size() < 11 || record.front() != ':' || record.size() % 2 == 0) {
+            return std::nullopt;
+        }
+        std::vector<std::uint8_t> bytes(record.size() / 2);
+        std::uint8_t              checksum = 0;
+        for (std::size_t index = 0; index < bytes.size(); index++) {
+            const char *first       = record.data() + 1 + index * 2;
+            const auto [end, error] = std::from_chars(first, first + 2, bytes[index], 16);
+            if (error != std::errc {} || end != first + 2) {
+                return std::nullopt;
+            }
+            checksum = static_cast<std::uint8_t>(checksum + bytes[index]);
+        }
+        if (checksum != 0 || bytes.size() != bytes[0] + 5U) {
+            return std::nullopt;
+        }
+        return bytes;
+    }
+
+public: // Data Members
+    static constexpr std::uint32_t version = 1;
+
+    static constexpr std::size_t  hexRecordLength  = 0x10;
+    static constexpr std::size_t  maxHexRecordSize = 1 + 2 * (4 + hexRecordLength + 1) + 1;
+    static constexpr std::uint8_t hexData          = 0x00;
+    static constexpr std::uint8_t hexEndOfFile     = 0x01;
+
+private: // Data Members
+    static constexpr std::array<char, 8> magic = { 'i', '8', '0', '8', '5', 'i', 'm', 'g' };
+
+    static constexpr std::size_t versionOffset      = 0x08;
+    static constexpr std::size_t entryPointOffset   = 0x0C;
+    static constexpr std::size_t segmentCountOffset = 0x0E;
+    static constexpr std::size_t headerSize         = 0x10;
+    static constexpr std::size_t segmentHeaderSize  = 0x08;
+
+    static constexpr std::string_view hexDigits = "0123456789ABCDEF";
+
+    static constexpr std::uint8_t hexExtendedSegmentAddress = 0x02;
+    static constexpr std::uint8_t hexStartSegmentAddress    = 0x03;
+    static constexpr std::uint8_t hexExtendedLinearAddress  = 0x04;
+    static constexpr std::uint8_t hexStartLinearAddress     = 0x05;
+};
+
+} // namespace intel_8085
+
+#endif
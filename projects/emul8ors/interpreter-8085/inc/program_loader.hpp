@@ -3,62 +3,94 @@
 
 #include <filesystem>
 #include <optional>
-#include <queue>
-#include <sstream>
 #include <string>
+#include <string_view>
 
 #include "spdlog/spdlog.h"
 
 #include "instruction_set.hpp"
+#include "mapped_file.hpp"
 #include "program.hpp"
+#include "program_tokenizer.hpp"
 #include "system_memory.hpp"
 
 namespace intel_8085 {
 
 class ProgramLoader {
 public: // Functions/Methods
-    [[nodiscard]] static auto Load(SystemMemory &memory, const std::string &filename) noexcept -> bool
+    // On success, entryPoint is set to the starting address of the code section
+    [[nodiscard]] static auto Load(
+        SystemMemory &memory, const std::string &filename, std::uint16_t &entryPoint) noexcept -> bool
     {
-        if (ValidateFileType(filename)) {
-            spdlog::info("Loading program from file: {}", filename);
+        const auto program = Parse(filename);
+        if (!program.has_value()) {
+            return false;
+        }
+        if (!LoadProgram(memory, program.value())) {
+            spdlog::error("Invalid program, could not load into memory");
+            return false;
+        }
+        spdlog::info("Loaded a valid program into memory");
+        entryPoint = program->codeSection.startingAddress;
+        return true;
+    }
 
-            std::fstream            programStream(filename, std::fstream::in);
-            std::string             line;
-            std::queue<std::string> tokens;
+    // Parses a program file without loading it, so that it can be loaded many times over
+    [[nodiscard]] static auto Parse(const std::string &filename) noexcept -> std::optional<Program>
+    {
+        if (!ValidateFileType(filename)) {
+            return std::nullopt;
+        }
+        spdlog::info("Loading program from file: {}", filename);
 
-            while (std::getline(programStream, line) && TokenizeLine(line, tokens, " \t\n")) {
-                spdlog::debug("Line: {}", line);
-            }
+        const auto file = MapFile(filename);
+        if (file == nullptr) {
+            return std::nullopt;
+        }
+        ProgramTokenizer tokens(AsText(*file));
 
-            if (tokens.empty()) {
-                spdlog::error("No valid tokens found in program file");
-                return false;
-            }
+        Program program;
+        if (!CreateProgram(program, tokens)) {
+            spdlog::error("Invalid program, could not parse {}", filename);
+            return std::nullopt;
+        }
+        spdlog::debug("Any tokens remaining to be processed: {}", !tokens.Empty());
 
+        // Data section
+        spdlog::debug("Data Section Starting Address: {:#x}", program.dataSection.startingAddress);
+        for (const auto val : program.dataSection.data) {
+            spdlog::debug("Data: {:#x}", val);
+        }
+
+        // Code section
+        spdlog::debug("Code Section Starting Address: {:#x}", program.codeSection.startingAddress);
+        for (const auto &val : program.codeSection.instructions) {
+            spdlog::debug("Instruction: {:#x}, {:#x}, {:#x}", val.opcode, val.operand1, val.operand2);
+        }
+        return program;
+    }
+
+    // Parses a file made up of data sections only, e.g. the inputs of a batch run
+    [[nodiscard]] static auto ParseDataSections(const std::string &filename) noexcept
+        -> std::optional<std::vector<DataSection>>
+    {
+        const auto file = MapFile(filename);
+        if (file == nullptr) {
+            spdlog::error("Could not read data sections from {}", filename);
+            return std::nullopt;
+        }
+        ProgramTokenizer         tokens(AsText(*file));
+        std::vector<DataSection> dataSections;
+        while (!tokens.Empty()) {
             Program program;
-            if (CreateProgram(program, tokens) && LoadProgram(memory, program)) {
-                spdlog::info("Loaded a valid program into memory");
-                spdlog::debug("Any tokens remaining to be processed: {}", !tokens.empty());
-
-                // Data section
-                spdlog::debug("Data Section Starting Address: {:#x}", program.dataSection.startingAddress);
-                for (const auto val : program.dataSection.data) {
-                    spdlog::debug("Data: {:#x}", val);
-                }
-
-                // Code section
-                spdlog::debug("Code Section Starting Address: {:#x}", program.codeSection.startingAddress);
-                for (const auto &val : program.codeSection.instructions) {
-                    spdlog::debug("Instruction: {:#x}, {:#x}, {:#x}", val.opcode, val.operand1, val.operand2);
-                }
-                return true;
-            } else {
-                spdlog::error("Invalid program, could not load into memory");
-                return false;
+            if (tokens.Front() != "data_begin" || !PopulateDataSection(program, tokens)
+                || !VerifyDataSection(program.dataSection)) {
+                spdlog::error("Invalid data section #{} in {}", dataSections.size(), filename);
+                return std::nullopt;
             }
-            return true;
+            dataSections.push_back(std::move(program.dataSection));
         }
-        return false;
+        return dataSections;
     }
 
     [[nodiscard]] static auto LoadProgram(SystemMemory &memory, const Program &program) noexcept -> bool
@@ -66,13 +98,17 @@ public: // Functions/Methods
         return VerifyProgram(program) && LoadProgramIntoMemory(memory, program);
     }
 
-private: // Functions/Methods
-    [[nodiscard]] static auto LoadProgramIntoMemory(SystemMemory &memory, const Program &program) noexcept -> bool
+    // Writes a data section on top of whatever is in memory, through the write path which tracks code changes
+    static auto LoadDataSection(SystemMemory &memory, const DataSection &dataSection) noexcept -> void
+    {
+        memory.WriteBlock(dataSection.startingAddress, dataSection.data);
+    }
+
+    // The bytes of the code section as laid out in memory
+    [[nodiscard]] static auto AssembleCode(const CodeSection &codeSection) noexcept -> std::vector<std::uint8_t>
     {
-        std::copy(program.dataSection.data.begin(), program.dataSection.data.end(),
-            memory.GetIterator(program.dataSection.startingAddress));
         std::vector<std::uint8_t> codeSectionCondensed;
-        for (const auto &instruction : program.codeSection.instructions) {
+        for (const auto &instruction : codeSection.instructions) {
             if (instruction.opcode & 0x0100) {
                 codeSectionCondensed.push_back(static_cast<std::uint8_t>(instruction.opcode & 0xFF));
             }
@@ -83,64 +119,75 @@ private: // Functions/Methods
                 codeSectionCondensed.push_back(static_cast<std::uint8_t>(instruction.operand2 & 0xFF));
             }
         }
-        std::copy(codeSectionCondensed.begin(), codeSectionCondensed.end(),
-            memory.GetIterator(program.codeSection.startingAddress));
-        return true;
+        return codeSectionCondensed;
     }
 
     [[nodiscard]] static auto VerifyProgram(const Program &program) noexcept -> bool
     {
-        return program.dataSection.startingAddress >= 0x8000 && program.dataSection.startingAddress < 0xF000
-            && program.dataSection.data.size() < 0xEFFF - 0x8000 && program.codeSection.startingAddress >= 0x1000
+        return VerifyDataSection(program.dataSection) && program.codeSection.startingAddress >= 0x1000
             && program.codeSection.startingAddress < 0x8000
             && program.codeSection.instructions.size() < 0x7FFF - 0x1000;
     }
 
-    // Owns the token queue passed in, will empty the queue before returning
+private: // Functions/Methods
+    [[nodiscard]] static auto LoadProgramIntoMemory(SystemMemory &memory, const Program &program) noexcept -> bool
+    {
+        memory.WriteBlock(program.dataSection.startingAddress, program.dataSection.data);
+        memory.WriteBlock(program.codeSection.startingAddress, AssembleCode(program.codeSection));
+        return true;
+    }
+
+    [[nodiscard]] static auto VerifyDataSection(const DataSection &dataSection) noexcept -> bool
+    {
+        return dataSection.startingAddress >= 0x8000 && dataSection.startingAddress < 0xF000
+            && dataSection.data.size() < 0xEFFF - 0x8000;
+    }
+
+    // Consumes the tokens passed in
     // Fills the program struct from the tokens passed in
-    [[nodiscard]] static auto CreateProgram(Program &program, std::queue<std::string> &tokens) noexcept -> bool
+    [[nodiscard]] static auto CreateProgram(Program &program, ProgramTokenizer &tokens) noexcept -> bool
     {
         return PopulateDataSection(program, tokens) && PopulateCodeSection(program, tokens);
     }
 
-    [[nodiscard]] static auto PopulateDataSection(Program &program, std::queue<std::string> &tokens) noexcept -> bool
+    [[nodiscard]] static auto PopulateDataSection(Program &program, ProgramTokenizer &tokens) noexcept -> bool
     {
-        if (tokens.front() != "data_begin") {
+        if (tokens.Front() != "data_begin") {
             spdlog::debug("Did not find a data section, skipping ahead to code section");
             return true;
         }
         spdlog::debug("Found a data section, populating program struct");
-        tokens.pop();
+        tokens.Pop();
         if (PopulateSectionStartingAddress(program, tokens, SectionType::DataSection)
-            && PopulateDataSectionBlock(program, tokens) && tokens.front() == "data_end") {
-            tokens.pop();
+            && PopulateDataSectionBlock(program, tokens) && tokens.Front() == "data_end") {
+            tokens.Pop();
             return true;
         } else {
-            spdlog::error("Expected a data_end token");
+            spdlog::error("Expected a data_end token on line {}", tokens.GetLine());
             return false;
         }
     }
 
-    [[nodiscard]] static auto PopulateCodeSection(Program &program, std::queue<std::string> &tokens) noexcept -> bool
+    [[nodiscard]] static auto PopulateCodeSection(Program &program, ProgramTokenizer &tokens) noexcept -> bool
     {
-        if (tokens.front() != "code_begin") {
+        if (tokens.Front() != "code_begin") {
             spdlog::error("Code section not found, no program to execute");
             return false;
         }
         spdlog::debug("Found a code section, populating program struct");
-        tokens.pop();
+        tokens.Pop();
         if (PopulateSectionStartingAddress(program, tokens, SectionType::CodeSection)
-            && PopulateCodeSectionBlock(program, tokens) && tokens.front() == "code_end") {
-            tokens.pop();
+            && PopulateCodeSectionBlock(program, tokens) && tokens.Front() == "code_end") {
+            tokens.Pop();
             return true;
         } else {
-            spdlog::error("Expected a code_end token");
+            spdlog::error("Expected a code_end token on line {}", tokens.GetLine());
             return false;
         }
     }
 
     [[nodiscard]] static auto PopulateSectionStartingAddress(
-        Program &program, std::queue<std::string> &tokens, SectionType sectionType) noexcept -> bool
+        Program &program, ProgramTokenizer &tokens, SectionType sectionType) noexcept -> bool
     {
         auto val = Consume<std::uint16_t>(tokens);
         if (!val.has_value()) {
@@ -155,8 +202,7 @@ private: // Functions/Methods
         return true;
     }
 
-    [[nodiscard]] static auto PopulateDataSectionBlock(Program &program, std::queue<std::string> &tokens) noexcept
-        -> bool
+    [[nodiscard]] static auto PopulateDataSectionBlock(Program &program, ProgramTokenizer &tokens) noexcept -> bool
     {
         auto length = Consume<std::uint16_t>(tokens);
         if (!length.has_value()) {
@@ -172,149 +218,114 @@ private: // Functions/Methods
         return true;
     }
 
-    [[nodiscard]] static auto PopulateCodeSectionBlock(Program &program, std::queue<std::string> &tokens) noexcept
-        -> bool
+    [[nodiscard]] static auto PopulateCodeSectionBlock(Program &program, ProgramTokenizer &tokens) noexcept -> bool
     {
         auto firstInstruction = ParseInstruction(tokens);
         if (!firstInstruction.has_value()) {
             spdlog::error("Failure processing instructions");
             return false;
         }
-        auto isHalt = [](const std::string &instruction) -> bool {
-            return stringToInstruction.contains(instruction) && stringToInstruction.at(instruction) == opcodes::HLT;
+        auto isHalt = [](const std::string_view instruction) -> bool {
+            return FindOpcode(instruction) == opcodes::HLT;
         };
         program.codeSection.instructions.push_back(firstInstruction.value());
-        while (!tokens.empty() && !isHalt(tokens.front())) {
+        while (!tokens.Empty() && !isHalt(tokens.Front())) {
             auto instruction = ParseInstruction(tokens);
             if (!instruction.has_value()) {
                 return false;
             }
             program.codeSection.instructions.push_back(instruction.value());
         }
-        if (tokens.empty() || !isHalt(tokens.front())) {
+        if (tokens.Empty() || !isHalt(tokens.Front())) {
             spdlog::error("Expected HLT instruction at the end of program");
             return false;
         }
         auto halt = ParseInstruction(tokens);
         if (!halt.has_value()) {
-            spdlog::error("Failure parsing HLT instruction: {}", tokens.front());
+            spdlog::error("Failure parsing HLT instruction: {}", tokens.Front());
             return false;
         }
         program.codeSection.instructions.push_back(halt.value());
         return true;
     }
 
-    [[nodiscard]] static auto ParseInstruction(std::queue<std::string> &tokens) noexcept -> std::optional<Instruction>
+    // An instruction token is the mnemonic followed by up to two comma separated byte operands, e.g. MVI_B,0x7F
+    [[nodiscard]] static auto ParseInstruction(ProgramTokenizer &tokens) noexcept -> std::optional<Instruction>
     {
-        if (tokens.empty()) {
+        if (tokens.Empty()) {
             return std::nullopt;
         }
-        std::string_view instruction = tokens.front();
-        std::string_view opcode      = instruction;
-        std::string_view operand1;
-        std::string_view operand2;
-
-        auto comma1 = instruction.find_first_of(",");
-        auto comma2 = instruction.find_last_of(",");
-        if (comma1 != instruction.npos) {
-            opcode.remove_suffix(instruction.size() - comma1);
-            instruction.remove_prefix(std::min(instruction.find_first_of(",") + 1, instruction.size()));
-            operand1 = instruction;
-        }
-        if (comma2 != instruction.npos && comma2 != comma1) {
-            operand1.remove_suffix(instruction.size() - comma2);
-            instruction.remove_prefix(std::min(instruction.find_first_of(",") + 1, instruction.size()));
-            operand2 = instruction;
-        }
-
-        const std::string opcodeString = { opcode.begin(), opcode.end() };
-        if (!stringToInstruction.contains(opcodeString)) {
-            spdlog::error("Invalid instruction: {}", opcodeString);
+        std::string_view instruction = tokens.Front();
+        const auto       opcode      = NextField(instruction);
+        const auto       found       = FindOpcode(opcode);
+        if (!found.has_value()) {
+            spdlog::error("Invalid instruction {} on line {}", opcode, tokens.GetLine());
+            return std::nullopt;
         }
 
-        std::uint16_t opcodeData   = static_cast<std::uint16_t>(stringToInstruction.at(opcodeString)) | 0x0100;
+        const auto    opcodeData   = static_cast<std::uint16_t>(static_cast<std::uint16_t>(found.value()) | 0x0100);
         std::uint16_t operand1Data = 0;
         std::uint16_t operand2Data = 0;
-
-        if (operand1.length() > 0) {
-            auto val = Parse<std::uint8_t>({ operand1.begin(), operand1.end() });
-            if (!val.has_value()) {
-                return std::nullopt;
+        for (std::uint16_t *operandData : { &operand1Data, &operand2Data }) {
+            if (instruction.empty()) {
+                break;
             }
-            operand1Data = static_cast<std::uint16_t>(val.value()) | 0x0100;
-        }
-        if (operand2.length() > 0) {
-            auto val = Parse<std::uint8_t>({ operand2.begin(), operand2.end() });
+            const auto operand = NextField(instruction);
+            const auto val     = ProgramTokenizer::ParseNumber<std::uint8_t>(operand);
             if (!val.has_value()) {
+                spdlog::error("Invalid operand {} on line {}", operand, tokens.GetLine());
                 return std::nullopt;
             }
-            operand2Data = static_cast<std::uint16_t>(val.value()) | 0x0100;
+            *operandData = static_cast<std::uint16_t>(val.value() | 0x0100);
+        }
+        if (!instruction.empty()) {
+            spdlog::error("Too many operands for {} on line {}", opcode, tokens.GetLine());
+            return std::nullopt;
         }
 
-        tokens.pop();
+        tokens.Pop();
         return { { opcodeData, operand1Data, operand2Data } };
     }
 
-    template <typename Data>
-    [[nodiscard]] static auto Consume(std::queue<std::string> &tokens) noexcept -> std::optional<Data>
+    // Splits off the text up to the next comma, dropping the comma
+    [[nodiscard]] static auto NextField(std::string_view &text) noexcept -> std::string_view
     {
-        auto val = Parse<Data>(tokens.front());
-        if (val.has_value()) {
-            tokens.pop();
-        }
-        return val;
+        const auto comma = text.find(',');
+        const auto field = text.substr(0, comma);
+        text.remove_prefix(comma == text.npos ? text.size() : comma + 1);
+        return field;
     }
 
     template <typename Data>
-    [[nodiscard]] static auto Parse(const std::string &data) noexcept -> std::optional<Data>
+    [[nodiscard]] static auto Consume(ProgramTokenizer &tokens) noexcept -> std::optional<Data>
     {
-        try {
-            const unsigned long val = std::stoul(data, nullptr, 0);
-            if (val >= 1 << sizeof(Data) * 8) {
-                spdlog::error("Parsed Value {} (hex: {:#x}) cannot be fit into {} bytes", val, val, sizeof(Data));
-                return std::nullopt;
-            }
-            return { static_cast<Data>(val) };
-        } catch (...) {
-            spdlog::error("Error parsing byte from string {}", data);
+        if (tokens.Empty()) {
+            spdlog::error("Unexpected end of file");
             return std::nullopt;
         }
-    }
-
-    [[maybe_unused]] static auto TokenizeLine(const std::string &line, std::queue<std::string> &tokens,
-        const std::string_view delims = " \t", const std::string_view skipLineToken = "//") noexcept -> bool
-    {
-        auto temp    = DropComment(line, skipLineToken);
-        auto lineEnd = temp.end();
-        auto tempIt  = temp.begin();
-        while (tempIt < lineEnd) {
-            temp = TrimLine(temp, delims);
-            if (temp.length() > 0) {
-                tokens.emplace(temp);
-            }
-            tempIt = temp.end();
-            temp   = std::string_view(tempIt, static_cast<std::size_t>(lineEnd - tempIt));
+        const auto val = ProgramTokenizer::ParseNumber<Data>(tokens.Front());
+        if (!val.has_value()) {
+            spdlog::error("Expected a value that fits into {} byte(s) and received {} on line {}", sizeof(Data),
+                tokens.Front(), tokens.GetLine());
+            return std::nullopt;
         }
-        return true;
+        tokens.Pop();
+        return val;
     }
 
-    [[nodiscard]] static auto DropComment(std::string_view line, const std::string_view skipLineToken) noexcept
-        -> std::string_view
+    [[nodiscard]] static auto MapFile(const std::string &filename) noexcept -> std::shared_ptr<MappedFile>
     {
-        if (const auto commentStart = line.find(skipLineToken); commentStart != line.npos) {
-            line.remove_suffix(line.size() - commentStart);
+        auto file = MappedFile::Open(filename);
+        if (file == nullptr) {
+            spdlog::error("No valid tokens found in file {}", filename);
         }
-        return line;
+        return file;
     }
 
-    [[nodiscard]] static auto TrimLine(std::string_view line, const std::string_view delims) noexcept
-        -> std::string_view
+    [[nodiscard]] static auto AsText(const MappedFile &file) noexcept -> std::string_view
     {
-        line.remove_prefix(std::min(line.find_first_not_of(delims), line.size()));
-        if (const auto trimPos = line.find_first_of(delims); trimPos != line.npos) {
-            line.remove_suffix(line.size() - trimPos);
-        }
-        return line;
+        const auto bytes = file.GetBytes();
+        return { reinterpret_cast<const char *>(bytes.data()), bytes.size() };
     }
 
     [[nodiscard]] static auto ValidateFileType(const std::string &filename) noexcept -> bool
@@ -0,0 +1,96 @@
+#ifndef INTERPRETER_8085_PROGRAM_TOKENIZER_HPP
+#define INTERPRETER_8085_PROGRAM_TOKENIZER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace intel_8085 {
+
+// Single pass scanner over program text, yielding whitespace separated tokens and skipping // comments.
+// Tokens are views into the text, which has to outlive the tokenizer, nothing is copied or allocated.
+class ProgramTokenizer {
+public: // Functions/Methods
+    explicit ProgramTokenizer(const std::string_view text) noexcept : text_(text) { Advance(); }
+
+    [[nodiscard]] auto Empty() const noexcept -> bool { return token_.empty(); }
+
+    // The current token, empty once the text is exhausted
+    [[nodiscard]] auto Front() const noexcept -> std::string_view { return token_; }
+
+    auto Pop() noexcept -> void { Advance(); }
+
+    // 1-based line of the current token
+    [[nodiscard]] auto GetLine() const noexcept -> std::size_t { return tokenLine_; }
+
+    // Parses a whole token as an unsigned number: 0x/0X prefixed hexadecimal, 0 prefixed octal or decimal.
+    // Returns nullopt if the token has anything else in it, or if the value does not fit into Data.
+    template <typename Data>
+    [[nodiscard]] static auto ParseNumber(std::string_view token) noexcept -> std::optional<Data>
+    {
+        int base = 10;
+        if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) {
+            base = 16;
+            token.remove_prefix(2);
+        } else if (token.size() > 1 && token[0] == '0') {
+            base = 8;
+            token.remove_prefix(1);
+        }
+        std::uint32_t value     = 0;
+        const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value, base);
+        if (token.empty() || error != std::errc {} || end != token.data() + token.size()
+            || value > std::numeric_limits<Data>::max()) {
+            return std::nullopt;
+        }
+        return static_cast<Data>(value);
+    }
+
+private: // Functions/Methods
+    [[nodiscard]] static constexpr auto IsSpace(const char c) noexcept -> bool
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    [[nodiscard]] auto AtComment() const noexcept -> bool
+    {
+        return text_[position_] == '/' && position_ + 1 < text_.size() && text_[position_ + 1] == '/';
+    }
+
+    auto Advance() noexcept -> void
+    {
+        while (position_ < text_.size()) {
+            if (text_[position_] == '\n') {
+                line_++;
+                position_++;
+            } else if (IsSpace(text_[position_])) {
+                position_++;
+            } else if (AtComment()) {
+                position_ = std::min(text_.find('\n', position_), text_.size());
+            } else {
+                break;
+            }
+        }
+        const std::size_t start = position_;
+        while (position_ < text_.size() && !IsSpace(text_[position_]) && !AtComment()) {
+            position_++;
+        }
+        token_     = text_.substr(start, position_ - start);
+        tokenLine_ = line_;
+    }
+
+public:  // Data Members
+private: // Data Members
+    std::string_view text_;
+    std::string_view token_;
+    std::size_t      position_  = 0;
+    std::size_t      line_      = 1;
+    std::size_t      tokenLine_ = 1;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef INTERPRETER_8085_REGISTER_FILE_HPP
+#define INTERPRETER_8085_REGISTER_FILE_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace intel_8085 {
+
+// The general purpose registers along with PC and SP, 12 bytes in all.
+// The 8-bit registers are stored low byte first (C, B, E, D, L, H) so that on little endian hosts BC, DE and HL
+// are plain 16-bit loads and stores. Registers are addressed by their 3-bit code from the instruction encoding.
+class RegisterFile {
+public: // Functions/Methods
+    // Codes: 000 - B, 001 - C, 010 - D, 011 - E, 100 - H, 101 - L, 111 - A
+    template <std::uint8_t Code>
+    [[nodiscard]] constexpr auto Get() const noexcept -> std::uint8_t
+    {
+        static_assert(Code != m, "M is a memory operand, not a register");
+        return bytes_[Slot(Code)];
+    }
+
+    template <std::uint8_t Code>
+    constexpr auto Set(const std::uint8_t value) noexcept -> void
+    {
+        static_assert(Code != m, "M is a memory operand, not a register");
+        bytes_[Slot(Code)] = value;
+    }
+
+    [[nodiscard]] constexpr auto Get(const std::uint8_t code) const noexcept -> std::uint8_t
+    {
+        return bytes_[Slot(code)];
+    }
+
+    constexpr auto Set(const std::uint8_t code, const std::uint8_t value) noexcept -> void
+    {
+        bytes_[Slot(code)] = value;
+    }
+
+    [[nodiscard]] constexpr auto GetAccumulator() const noexcept -> std::uint8_t { return bytes_[accumulatorSlot]; }
+
+    constexpr auto SetAccumulator(const std::uint8_t value) noexcept -> void { bytes_[accumulatorSlot] = value; }
+
+    // Register pairs: 00 - BC, 01 - DE, 10 - HL
+    template <std::uint8_t Pair>
+    [[nodiscard]] auto GetPair() const noexcept -> std::uint16_t
+    {
+        static_assert(Pair < 0b11, "SP and PSW are not held in the register pairs");
+        if constexpr (std::endian::native == std::endian::little) {
+            std::uint16_t value = 0;
+            std::memcpy(&value, &bytes_[Pair * 2], sizeof(value));
+            return value;
+        } else {
+            return static_cast<std::uint16_t>(bytes_[Pair * 2 + 1] << 8 | bytes_[Pair * 2]);
+        }
+    }
+
+    template <std::uint8_t Pair>
+    auto SetPair(const std::uint16_t value) noexcept -> void
+    {
+        static_assert(Pair < 0b11, "SP and PSW are not held in the register pairs");
+        if constexpr (std::endian::native == std::endian::little) {
+            std::memcpy(&bytes_[Pair * 2], &value, sizeof(value));
+        } else {
+            bytes_[Pair * 2]     = static_cast<std::uint8_t>(value);
+            bytes_[Pair * 2 + 1] = static_cast<std::uint8_t>(value >> 8);
+        }
+    }
+
+    [[nodiscard]] constexpr auto GetPc() const noexcept -> std::uint16_t { return pc_; }
+
+    constexpr auto SetPc(const std::uint16_t pc) noexcept -> void { pc_ = pc; }
+
+    [[nodiscard]] constexpr auto GetSp() const noexcept -> std::uint16_t { return sp_; }
+
+    constexpr auto SetSp(const std::uint16_t sp) noexcept -> void { sp_ = sp; }
+
+private: // Functions/Methods
+    // B/C, D/E and H/L swap places to put the low byte first, A follows HL
+    [[nodiscard]] static constexpr auto Slot(const std::uint8_t code) noexcept -> std::size_t
+    {
+        return code == a ? accumulatorSlot : static_cast<std::size_t>(code ^ 0x01);
+    }
+
+public: // Data Members
+    static constexpr std::uint8_t b = 0b000;
+    static constexpr std::uint8_t c = 0b001;
+    static constexpr std::uint8_t d = 0b010;
+    static constexpr std::uint8_t e = 0b011;
+    static constexpr std::uint8_t h = 0b100;
+    static constexpr std::uint8_t l = 0b101;
+    static constexpr std::uint8_t m = 0b110;
+    static constexpr std::uint8_t a = 0b111;
+
+private: // Data Members
+    static constexpr std::size_t accumulatorSlot = 6;
+
+    std::array<std::uint8_t, 8> bytes_ = {}; // C, B, E, D, L, H, A, unused
+    std::uint16_t               pc_    = 0;
+    std::uint16_t               sp_    = 0;
+};
+
+} // namespace intel_8085
+
+#endif
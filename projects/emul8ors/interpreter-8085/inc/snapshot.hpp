@@ -0,0 +1,173 @@
+#ifndef INTERPRETER_8085_SNAPSHOT_HPP
+#define INTERPRETER_8085_SNAPSHOT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "spdlog/spdlog.h"
+
+#include "little_endian.hpp"
+#include "mapped_file.hpp"
+#include "processor_state.hpp"
+#include "system_memory.hpp"
+
+namespace intel_8085 {
+
+// Binary save state of a ProcessorState, all fields little endian:
+//   0x000 - 0x0FF  Header: magic, version, stored page count, cycles, PC, SP, B C D E H L A, flags, interrupt mask,
+//                  interrupt enable, halted, interrupt requests, interrupts deferred by EI and a 256 bit bitmap of
+//                  the stored pages
+//   0x100 - 0x1FF  I/O port latches
+//   0x200 - ...    The stored pages in ascending order, pageSize bytes each
+// Only pages holding a non-zero byte are stored. Loading maps the file and backs the memory pages with it
+// copy-on-write, so nothing past the header is parsed or copied.
+class Snapshot {
+public: // Functions/Methods
+    [[nodiscard]] static auto Save(const ProcessorState &state, const std::string &filename) noexcept -> bool
+    {
+        std::array<std::uint8_t, pagesOffset> prologue {};
+        std::bitset<0x100>                    storedPages;
+        for (std::size_t page = 0; page < storedPages.size(); page++) {
+            const auto data = state.memory.GetPage(static_cast<std::uint8_t>(page));
+            storedPages.set(page, std::any_of(data.begin(), data.end(), [](const std::uint8_t b) { return b != 0; }));
+        }
+
+        std::memcpy(&prologue[magicOffset], magic.data(), magic.size());
+        StoreLittleEndian<std::uint32_t>(prologue, versionOffset, version);
+        StoreLittleEndian<std::uint16_t>(prologue, pageCountOffset, static_cast<std::uint16_t>(storedPages.count()));
+        StoreLittleEndian<std::uint64_t>(prologue, cyclesOffset, state.cycles);
+        StoreLittleEndian<std::uint16_t>(prologue, pcOffset, state.registers.GetPc());
+        StoreLittleEndian<std::uint16_t>(prologue, spOffset, state.registers.GetSp());
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            prologue[registersOffset + code] = state.registers.Get(code);
+        }
+        prologue[registersOffset + 6]      = state.registers.GetAccumulator();
+        prologue[flagsOffset]              = state.status.GetFlags();
+        prologue[interruptMaskOffset]      = state.interruptMask;
+        prologue[interruptsEnabledOffset]  = state.interruptsEnabled ? 1 : 0;
+        prologue[haltedOffset]             = state.halted ? 1 : 0;
+        prologue[interruptRequestsOffset]  = state.interruptRequests;
+        prologue[interruptsDeferredOffset] = state.interruptsDeferred ? 1 : 0;
+        for (std::size_t page = 0; page < storedPages.size(); page++) {
+            if (storedPages.test(page)) {
+                prologue[pageBitmapOffset + page / 8] |= static_cast<std::uint8_t>(1U << (page % 8));
+            }
+        }
+        std::copy(state.ports.begin(), state.ports.end(), prologue.begin() + portsOffset);
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(prologue.data()), prologue.size());
+        for (std::size_t page = 0; page < storedPages.size(); page++) {
+            if (storedPages.test(page)) {
+                const auto data = state.memory.GetPage(static_cast<std::uint8_t>(page));
+                file.write(reinterpret_cast<const char *>(data.data()), data.size());
+            }
+        }
+        if (!file) {
+            spdlog::error("Could not write the save state {}", filename);
+            return false;
+        }
+        return true;
+    }
+
+    // Restores everything but the flag evaluation mode of the state.
+    // Memory is restored through SystemMemory::RestoreFrom, so decoded code on unchanged pages stays valid.
+    [[nodiscard]] static auto Load(ProcessorState &state, const std::string &filename) noexcept -> bool
+    {
+        const auto file = MappedFile::Open(filename);
+        if (file == nullptr) {
+            spdlog::error("Could not read the save state {}", filename);
+            return false;
+        }
+        const std::span<std::uint8_t> bytes = file->GetBytes();
+        if (!Verify(bytes)) {
+            spdlog::error("{} is not a valid save state", filename);
+            return false;
+        }
+
+        SystemMemory image;
+        std::size_t  offset = pagesOffset;
+        for (std::size_t page = 0; page < 0x100; page++) {
+            if (bytes[pageBitmapOffset + page / 8] & (1U << (page % 8))) {
+                // Every page holds a reference to the whole mapping
+                image.MapPage(static_cast<std::uint8_t>(page), std::shared_ptr<std::uint8_t>(file, &bytes[offset]));
+                offset += SystemMemory::pageSize;
+            }
+        }
+        state.memory.RestoreFrom(image);
+
+        state.cycles = LoadLittleEndian<std::uint64_t>(bytes, cyclesOffset);
+        state.registers.SetPc(LoadLittleEndian<std::uint16_t>(bytes, pcOffset));
+        state.registers.SetSp(LoadLittleEndian<std::uint16_t>(bytes, spOffset));
+        for (std::uint8_t code = RegisterFile::b; code <= RegisterFile::l; code++) {
+            state.registers.Set(code, bytes[registersOffset + code]);
+        }
+        state.registers.SetAccumulator(bytes[registersOffset + 6]);
+        state.status.SetFlags(bytes[flagsOffset]);
+        state.interruptMask      = bytes[interruptMaskOffset];
+        state.interruptsEnabled  = bytes[interruptsEnabledOffset] != 0;
+        state.halted             = bytes[haltedOffset] != 0;
+        state.interruptRequests  = bytes[interruptRequestsOffset];
+        state.interruptsDeferred = bytes[interruptsDeferredOffset] != 0;
+        std::copy_n(bytes.begin() + portsOffset, state.ports.size(), state.ports.begin());
+        return true;
+    }
+
+    // True if the file starts like a save state, to tell save states and programs apart
+    [[nodiscard]] static auto IsSnapshot(const std::string &filename) noexcept -> bool
+    {
+        std::array<char, magic.size()> start {};
+        std::ifstream                  file(filename, std::ios::binary);
+        return file.read(start.data(), start.size()) && start == magic;
+    }
+
+private: // Functions/Methods
+    [[nodiscard]] static auto Verify(const std::span<const std::uint8_t> bytes) noexcept -> bool
+    {
+        if (bytes.size() < pagesOffset || std::memcmp(&bytes[magicOffset], magic.data(), magic.size()) != 0
+            || LoadLittleEndian<std::uint32_t>(bytes, versionOffset) != version) {
+            return false;
+        }
+        std::size_t storedPages = 0;
+        for (std::size_t index = 0; index < 0x100 / 8; index++) {
+            storedPages += static_cast<std::size_t>(std::popcount(bytes[pageBitmapOffset + index]));
+        }
+        return storedPages == LoadLittleEndian<std::uint16_t>(bytes, pageCountOffset)
+            && bytes.size() == pagesOffset + storedPages * SystemMemory::pageSize;
+    }
+
+public: // Data Members
+    static constexpr std::uint32_t version = 1;
+
+private: // Data Members
+    static constexpr std::array<char, 8> magic = { 'i', '8', '0', '8', '5', 's', 'a', 'v' };
+
+    static constexpr std::size_t magicOffset              = 0x00;
+    static constexpr std::size_t versionOffset            = 0x08;
+    static constexpr std::size_t pageCountOffset          = 0x0C;
+    static constexpr std::size_t cyclesOffset             = 0x10;
+    static constexpr std::size_t pcOffset                 = 0x18;
+    static constexpr std::size_t spOffset                 = 0x1A;
+    static constexpr std::size_t registersOffset          = 0x1C; // B, C, D, E, H, L, A
+    static constexpr std::size_t flagsOffset              = 0x23;
+    static constexpr std::size_t interruptMaskOffset      = 0x24;
+    static constexpr std::size_t interruptsEnabledOffset  = 0x25;
+    static constexpr std::size_t haltedOffset             = 0x26;
+    static constexpr std::size_t interruptRequestsOffset  = 0x27;
+    static constexpr std::size_t interruptsDeferredOffset = 0x28;
+    static constexpr std::size_t pageBitmapOffset         = 0x40;
+    static constexpr std::size_t portsOffset              = 0x100;
+    static constexpr std::size_t pagesOffset              = 0x200;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef INTERPRETER_8085_SPSC_RING_HPP
+#define INTERPRETER_8085_SPSC_RING_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <thread>
+
+namespace intel_8085 {
+
+// Lock-free ring of trivially copyable items between exactly one producer and one consumer thread.
+// Both indices only ever grow, their difference is the fill level. Each side keeps its own copy of the other's
+// index and only reloads it once that copy says the ring is full (producer) or empty (consumer), so the shared
+// cache lines change hands once per batch rather than once per item.
+template <typename Item, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public: // Functions/Methods
+    // Producer side, spins (yielding) while the ring is full so that nothing is ever dropped
+    auto Push(const Item &item) noexcept -> void
+    {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        while (head - producerTail_ == Capacity) {
+            producerTail_ = tail_.load(std::memory_order_acquire);
+            if (head - producerTail_ == Capacity) {
+                std::this_thread::yield();
+            }
+        }
+        items_[head & mask] = item;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Consumer side, moves up to items.size() items out and returns how many there were
+    [[nodiscard]] auto Pop(const std::span<Item> items) noexcept -> std::size_t
+    {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (consumerHead_ == tail) {
+            consumerHead_ = head_.load(std::memory_order_acquire);
+        }
+        const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(consumerHead_ - tail, items.size()));
+        for (std::size_t index = 0; index < count; index++) {
+            items[index] = items_[(tail + index) & mask];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private: // Functions/Methods
+public:  // Data Members
+private: // Data Members
+    static constexpr std::uint64_t mask     = Capacity - 1;
+    static constexpr std::size_t   lineSize = 64;
+
+    // Written by the producer
+    alignas(lineSize) std::atomic<std::uint64_t> head_ { 0 };
+    std::uint64_t producerTail_ = 0;
+
+    // Written by the consumer
+    alignas(lineSize) std::atomic<std::uint64_t> tail_ { 0 };
+    std::uint64_t consumerHead_ = 0;
+
+    alignas(lineSize) std::array<Item, Capacity> items_ {};
+};
+
+} // namespace intel_8085
+
+#endif
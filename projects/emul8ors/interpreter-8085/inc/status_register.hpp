@@ -1,45 +1,279 @@
 #ifndef INTERPRETER_8085_STATUS_REGISTER_HPP
 #define INTERPRETER_8085_STATUS_REGISTER_HPP
 
+#include <array>
+#include <bit>
 #include <cstdint>
 
 namespace intel_8085 {
 
+// Eager - every flag is computed by the instruction which affects it
+// Lazy  - arithmetic and logical instructions only record their operands and result, the flags are computed
+//         when an instruction reads them (Jcc, Ccc, Rcc, PUSH PSW, DAA, ...)
+enum class FlagEvaluation : std::uint8_t { Eager, Lazy };
+
+constexpr FlagEvaluation defaultFlagEvaluation = FlagEvaluation::Lazy;
+
 class StatusRegister {
 public: // Functions/Methods
-    [[nodiscard]] constexpr auto GetSignBit() const noexcept -> bool { return flags_ & 0x80; }
+    [[nodiscard]] constexpr auto GetFlagEvaluation() const noexcept -> FlagEvaluation { return evaluation_; }
+
+    // Switching to eager evaluation computes the pending flags right away, handy for differential checks
+    constexpr auto SetFlagEvaluation(const FlagEvaluation evaluation) noexcept -> void
+    {
+        Materialize();
+        evaluation_ = evaluation;
+    }
+
+    [[nodiscard]] constexpr auto GetFlags() const noexcept -> std::uint8_t
+    {
+        return operation_ == Operation::None ? flags_ : Evaluate();
+    }
+
+    constexpr auto SetFlags(const std::uint8_t flags) noexcept -> void
+    {
+        flags_     = flags & flagsMask;
+        operation_ = Operation::None;
+    }
+
+    // The Record*() functions take the operands and the result of the operation which sets the flags.
+    // Subtraction is performed as the addition of the complement, so lhs + rhs + carry in = sum throughout
+    // and AC is the carry out of bit 3 of that addition. Bit 8 of the sum is the carry out of bit 7.
+
+    // ADD, ADC
+    constexpr auto RecordAddition(const std::uint8_t lhs, const std::uint8_t rhs, const std::uint16_t sum) noexcept
+        -> void
+    {
+        Record(Operation::Addition, lhs, rhs, sum);
+    }
+
+    // SUB, SBB, CMP, with rhs being the complement of the subtrahend and CY set on borrow
+    constexpr auto RecordSubtraction(const std::uint8_t lhs, const std::uint8_t rhs, const std::uint16_t sum) noexcept
+        -> void
+    {
+        Record(Operation::Subtraction, lhs, rhs, sum);
+    }
+
+    // INR and DCR leave CY untouched
+    constexpr auto RecordIncrement(const std::uint8_t value, const std::uint8_t result) noexcept -> void
+    {
+        flags_ = GetCarryBit() ? carryFlag : 0;
+        Record(Operation::Increment, value, 0x01, result);
+    }
+
+    constexpr auto RecordDecrement(const std::uint8_t value, const std::uint8_t result) noexcept -> void
+    {
+        flags_ = GetCarryBit() ? carryFlag : 0;
+        Record(Operation::Decrement, value, 0xFF, result);
+    }
+
+    // ANA sets AC, XRA and ORA clear it, CY is cleared by all of them
+    constexpr auto RecordLogical(const std::uint8_t result, const bool auxCarry) noexcept -> void
+    {
+        Record(auxCarry ? Operation::And : Operation::Logical, 0x00, 0x00, result);
+    }
+
+    [[nodiscard]] constexpr auto GetSignBit() const noexcept -> bool
+    {
+        return operation_ == Operation::None ? flags_ & 0x80 : sum_ & 0x80;
+    }
+
+    constexpr auto SetSignBit() noexcept -> void
+    {
+        Materialize();
+        flags_ |= 0x80;
+    }
 
-    constexpr auto SetSignBit() noexcept -> void { flags_ |= 0x80; }
+    constexpr auto ResetSignBit() noexcept -> void
+    {
+        Materialize();
+        flags_ &= 0x7F;
+    }
 
-    constexpr auto ResetSignBit() noexcept -> void { flags_ &= 0x7F; }
+    [[nodiscard]] constexpr auto GetZeroBit() const noexcept -> bool
+    {
+        return operation_ == Operation::None ? flags_ & 0x40 : (sum_ & 0xFF) == 0;
+    }
 
-    [[nodiscard]] constexpr auto GetZeroBit() const noexcept -> bool { return flags_ & 0x40; }
+    constexpr auto SetZeroBit() noexcept -> void
+    {
+        Materialize();
+        flags_ |= 0x40;
+    }
 
-    constexpr auto SetZeroBit() noexcept -> void { flags_ |= 0x40; }
+    constexpr auto ResetZeroBit() noexcept -> void
+    {
+        Materialize();
+        flags_ &= 0xBF;
+    }
 
-    constexpr auto ResetZeroBit() noexcept -> void { flags_ &= 0xBF; }
+    [[nodiscard]] constexpr auto GetACBit() const noexcept -> bool { return GetFlags() & 0x10; }
 
-    [[nodiscard]] constexpr auto GetACBit() const noexcept -> bool { return flags_ & 0x10; }
+    constexpr auto SetACBit() noexcept -> void
+    {
+        Materialize();
+        flags_ |= 0x10;
+    }
 
-    constexpr auto SetACBit() noexcept -> void { flags_ |= 0x10; }
+    constexpr auto ResetACBit() noexcept -> void
+    {
+        Materialize();
+        flags_ &= 0xEF;
+    }
 
-    constexpr auto ResetACBit() noexcept -> void { flags_ &= 0xEF; }
+    [[nodiscard]] constexpr auto GetParityBit() const noexcept -> bool
+    {
+        return operation_ == Operation::None ? flags_ & 0x04 : zeroSignParity_[sum_ & 0xFF] & 0x04;
+    }
 
-    [[nodiscard]] constexpr auto GetParityBit() const noexcept -> bool { return flags_ & 0x04; }
+    constexpr auto SetParityBit() noexcept -> void
+    {
+        Materialize();
+        flags_ |= 0x04;
+    }
 
-    constexpr auto SetParityBit() noexcept -> void { flags_ |= 0x04; }
+    constexpr auto ResetParityBit() noexcept -> void
+    {
+        Materialize();
+        flags_ &= 0xFB;
+    }
 
-    constexpr auto ResetParityBit() noexcept -> void { flags_ &= 0xFB; }
+    [[nodiscard]] constexpr auto GetCarryBit() const noexcept -> bool
+    {
+        switch (operation_) {
+        case Operation::Addition:
+            return sum_ & 0x100;
+        case Operation::Subtraction:
+            return !(sum_ & 0x100);
+        case Operation::And:
+        case Operation::Logical:
+            return false;
+        default:
+            return flags_ & 0x01;
+        }
+    }
 
-    [[nodiscard]] constexpr auto GetCarryBit() const noexcept -> bool { return flags_ & 0x01; }
+    constexpr auto SetCarryBit() noexcept -> void
+    {
+        Materialize();
+        flags_ |= 0x01;
+    }
 
-    constexpr auto SetCarryBit() noexcept -> void { flags_ |= 0x01; }
+    constexpr auto ResetCarryBit() noexcept -> void
+    {
+        Materialize();
+        flags_ &= 0xFE;
+    }
 
-    constexpr auto ResetCarryBit() noexcept -> void { flags_ &= 0xFE; }
+    // S, Z and P of a result
+    [[nodiscard]] static constexpr auto ZeroSignParity(const std::uint8_t value) noexcept -> std::uint8_t
+    {
+        return zeroSignParity_[value];
+    }
+
+    // Returns the flags in the high byte and the adjusted accumulator in the low byte
+    [[nodiscard]] static constexpr auto DecimalAdjust(const std::uint8_t accumulator, const std::uint8_t flags) noexcept
+        -> std::uint16_t
+    {
+        return decimalAdjust_[(flags & carryFlag) << 9 | ((flags & auxCarryFlag) ? 0x100 : 0) | accumulator];
+    }
+
+    // The table DecimalAdjust() reads, indexed by CY << 9 | AC << 8 | A, for generated code
+    [[nodiscard]] static auto GetDecimalAdjustTable() noexcept -> const std::uint16_t *
+    {
+        return decimalAdjust_.data();
+    }
 
 private: // Functions/Methods
-public:  // Data Members
+    enum class Operation : std::uint8_t { None, Addition, Subtraction, Increment, Decrement, And, Logical };
+
+    constexpr auto Record(const Operation operation, const std::uint8_t lhs, const std::uint8_t rhs,
+        const std::uint16_t sum) noexcept -> void
+    {
+        operation_ = operation;
+        lhs_       = lhs;
+        rhs_       = rhs;
+        sum_       = sum;
+        if (evaluation_ == FlagEvaluation::Eager) {
+            Materialize();
+        }
+    }
+
+    [[nodiscard]] constexpr auto Evaluate() const noexcept -> std::uint8_t
+    {
+        const std::uint8_t zeroSignParity = zeroSignParity_[sum_ & 0xFF];
+        const auto         auxCarry       = static_cast<std::uint8_t>((lhs_ ^ rhs_ ^ sum_) & auxCarryFlag);
+        switch (operation_) {
+        case Operation::Addition:
+            return static_cast<std::uint8_t>(zeroSignParity | auxCarry | (sum_ >> 8 & carryFlag));
+        case Operation::Subtraction:
+            return static_cast<std::uint8_t>(zeroSignParity | auxCarry | (~sum_ >> 8 & carryFlag));
+        case Operation::Increment:
+        case Operation::Decrement:
+            return static_cast<std::uint8_t>(zeroSignParity | auxCarry | (flags_ & carryFlag));
+        case Operation::And:
+            return zeroSignParity | auxCarryFlag;
+        case Operation::Logical:
+            return zeroSignParity;
+        default:
+            return flags_;
+        }
+    }
+
+    constexpr auto Materialize() noexcept -> void
+    {
+        flags_     = GetFlags();
+        operation_ = Operation::None;
+    }
+
+    [[nodiscard]] static constexpr auto MakeZeroSignParityTable() noexcept -> std::array<std::uint8_t, 0x100>
+    {
+        std::array<std::uint8_t, 0x100> table {};
+        for (std::size_t value = 0; value < table.size(); value++) {
+            table[value] = static_cast<std::uint8_t>((value & signFlag) | (value == 0 ? zeroFlag : 0)
+                | (std::popcount(value) % 2 == 0 ? parityFlag : 0));
+        }
+        return table;
+    }
+
+    // Indexed by CY << 9 | AC << 8 | A
+    [[nodiscard]] static constexpr auto MakeDecimalAdjustTable() noexcept -> std::array<std::uint16_t, 0x400>
+    {
+        const auto zeroSignParity = MakeZeroSignParityTable();
+        std::array<std::uint16_t, 0x400> table {};
+        for (std::size_t index = 0; index < table.size(); index++) {
+            const auto   accumulator = static_cast<std::uint8_t>(index);
+            const auto   lowNibble   = static_cast<std::uint8_t>(accumulator & 0x0F);
+            std::uint8_t correction  = 0x00;
+            bool         carry       = index & 0x200;
+            if ((index & 0x100) || lowNibble > 0x09) {
+                correction = 0x06;
+            }
+            if (carry || accumulator > 0x99) {
+                correction |= 0x60;
+                carry = true;
+            }
+            const auto result = static_cast<std::uint8_t>(accumulator + correction);
+            const auto flags  = static_cast<std::uint8_t>(zeroSignParity[result] | (carry ? carryFlag : 0)
+                | (lowNibble + (correction & 0x0F) > 0x0F ? auxCarryFlag : 0));
+            table[index] = static_cast<std::uint16_t>(flags << 8 | result);
+        }
+        return table;
+    }
+
+public: // Data Members
+    static constexpr std::uint8_t signFlag     = 0x80;
+    static constexpr std::uint8_t zeroFlag     = 0x40;
+    static constexpr std::uint8_t auxCarryFlag = 0x10;
+    static constexpr std::uint8_t parityFlag   = 0x04;
+    static constexpr std::uint8_t carryFlag    = 0x01;
+    static constexpr std::uint8_t flagsMask    = signFlag | zeroFlag | auxCarryFlag | parityFlag | carryFlag;
+
 private: // Data Members
+    static const std::array<std::uint8_t, 0x100>  zeroSignParity_;
+    static const std::array<std::uint16_t, 0x400> decimalAdjust_;
+
+    // Materialized flags, only CY is meaningful while an INR/DCR is pending
     std::uint8_t flags_ = 0;
     // Bit positions of flags:
     // std::uint8_t s_  = 7; // Sign flag
@@ -47,8 +281,20 @@ private: // Data Members
     // std::uint8_t ac_ = 4; // Auxiliary Carry flag
     // std::uint8_t p_  = 2; // Parity flag
     // std::uint8_t cy_ = 0; // Carry flag
+
+    // Last operation which set the flags, pending evaluation
+    Operation      operation_  = Operation::None;
+    FlagEvaluation evaluation_ = defaultFlagEvaluation;
+    std::uint8_t   lhs_        = 0;
+    std::uint8_t   rhs_        = 0;
+    std::uint16_t  sum_        = 0;
 };
 
+inline constexpr std::array<std::uint8_t, 0x100> StatusRegister::zeroSignParity_
+    = StatusRegister::MakeZeroSignParityTable();
+inline constexpr std::array<std::uint16_t, 0x400> StatusRegister::decimalAdjust_
+    = StatusRegister::MakeDecimalAdjustTable();
+
 } // namespace intel_8085
 
 #endif
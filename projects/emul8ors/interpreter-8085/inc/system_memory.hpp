@@ -1,26 +1,393 @@
 #ifndef INTERPRETER_8085_SYSTEM_MEMORY_HPP
 #define INTERPRETER_8085_SYSTEM_MEMORY_HPP
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <bitset>
 #include <cctype>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
 #include "fmt/format.h"
 #include "spdlog/spdlog.h"
 
+#include "device_bus.hpp"
+#include "write_journal.hpp"
+
 namespace intel_8085 {
 
+// Attributes are tracked per 256 byte page, a page with no attributes set takes the plain store path
+enum class PageAttribute : std::uint8_t {
+    None    = 0x00,
+    Code    = 0x01,
+    Device  = 0x02,
+    Watch   = 0x04,
+    Journal = 0x08,
+    Shared  = 0x80
+};
+
+enum class WatchKind : std::uint8_t { Read = 0x01, Write = 0x02, Access = 0x03 };
+
+// The first watched access since the last SystemMemory::ClearWatchHit(), value being the byte read or written
+struct WatchHit {
+    std::uint16_t address = 0x0000;
+    std::uint8_t  value   = 0x00;
+    WatchKind     kind    = WatchKind::Read;
+};
+
+// 64 KiB address space made of 256 byte pages.
+// Pages are reference counted and shared copy-on-write between copies of a memory, so copying one costs a page
+// table copy and a page is duplicated on its first write after the copy. All pages start out backed by one static
+// zero page. Shared pages carry PageAttribute::Shared, which keeps writes to them off the plain store path.
+// Pages mapped to a device on an attached bus carry PageAttribute::Device, accesses to them go to the device and
+// leave the page itself alone. Pages holding a watchpoint carry PageAttribute::Watch, so that reads and writes
+// elsewhere take their usual path. Watchpoints belong to one memory and are not copied along with it.
+// While a WriteJournal is attached every page carries PageAttribute::Journal, so every write leaves the plain store
+// path to be recorded. The journal is not copied along with the memory either.
 class SystemMemory {
 public: // Functions/Methods
-    [[nodiscard]] auto operator[](const std::uint16_t index) noexcept -> std::uint8_t & { return memory_[index]; }
+    SystemMemory() noexcept
+    {
+        pages_.fill(ZeroPage().data());
+        pageAttributes_.fill(static_cast<std::uint8_t>(PageAttribute::Shared));
+    }
+
+    // Shares every page of the other memory, both memories copy a page before writing to it.
+    // Marks the pages of the source as shared. Once they are, e.g. after a first copy, several threads may copy
+    // the same memory at once.
+    SystemMemory(const SystemMemory &other) noexcept
+        : pages_(other.pages_), owners_(other.owners_), pageAttributes_(other.pageAttributes_),
+          dirtyPages_(other.dirtyPages_), codeDirty_(other.codeDirty_), bus_(other.bus_)
+    {
+        other.MarkShared();
+        MarkShared();
+        constexpr auto attached = static_cast<std::uint8_t>(
+            static_cast<std::uint8_t>(PageAttribute::Watch) | static_cast<std::uint8_t>(PageAttribute::Journal));
+        for (auto &attributes : pageAttributes_) {
+            attributes &= static_cast<std::uint8_t>(~attached);
+        }
+    }
+
+    auto operator=(const SystemMemory &other) noexcept -> SystemMemory &
+    {
+        if (this != &other) {
+            pages_          = other.pages_;
+            owners_         = other.owners_;
+            pageAttributes_ = other.pageAttributes_;
+            dirtyPages_     = other.dirtyPages_;
+            codeDirty_      = other.codeDirty_;
+            bus_            = other.bus_;
+            other.MarkShared();
+            MarkShared();
+            ClearWatchpoints();
+            AttachJournal(journal_);
+        }
+        return *this;
+    }
+
+    SystemMemory(SystemMemory &&) noexcept                     = default;
+    auto operator=(SystemMemory &&) noexcept -> SystemMemory & = default;
+    ~SystemMemory()                                            = default;
+
+    // Marks every page as shared, as copying the memory does, without making a copy. Several threads may then copy
+    // this memory at once.
+    auto Share() const noexcept -> void { MarkShared(); }
+
+    [[nodiscard]] auto operator[](const std::uint16_t index) const noexcept -> std::uint8_t { return Read(index); }
+
+    // Gives the page a private copy and marks it as written to, the reference must not outlive the next copy.
+    // Bypasses devices, the reference is to the page itself.
+    [[nodiscard]] auto operator[](const std::uint16_t index) noexcept -> std::uint8_t &
+    {
+        if (pageAttributes_[index >> 8] != 0) {
+            OnAttributedWrite(index);
+        }
+        return pages_[index >> 8][index & 0xFF];
+    }
+
+    [[nodiscard]] auto Read(const std::uint16_t address) const noexcept -> std::uint8_t
+    {
+        constexpr auto attributes
+            = static_cast<std::uint8_t>(static_cast<std::uint8_t>(PageAttribute::Device)
+                | static_cast<std::uint8_t>(PageAttribute::Watch));
+        if (pageAttributes_[address >> 8] & attributes) [[unlikely]] {
+            const std::uint8_t value = Fetch(address);
+            if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Watch)) {
+                OnWatchedAccess(address, value, WatchKind::Read);
+            }
+            return value;
+        }
+        return pages_[address >> 8][address & 0xFF];
+    }
+
+    // Instruction fetch, reads from devices like Read() but is not seen by watchpoints
+    [[nodiscard]] auto Fetch(const std::uint16_t address) const noexcept -> std::uint8_t
+    {
+        if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Device)) [[unlikely]] {
+            return bus_->Read(address);
+        }
+        return pages_[address >> 8][address & 0xFF];
+    }
+
+    // The operand bytes of the instruction of the given length at address, little endian. Only the instruction's own
+    // bytes are fetched, so that a device holding code sees no reads past it.
+    [[nodiscard]] auto FetchOperand(const std::uint16_t address, const std::uint8_t length) const noexcept
+        -> std::uint16_t
+    {
+        if (length < 2) {
+            return 0x0000;
+        }
+        const std::uint8_t low = Fetch(static_cast<std::uint16_t>(address + 1));
+        return length == 2 ? low
+                           : static_cast<std::uint16_t>(Fetch(static_cast<std::uint16_t>(address + 2)) << 8 | low);
+    }
+
+    auto Write(const std::uint16_t address, const std::uint8_t value) noexcept -> void
+    {
+        if (pageAttributes_[address >> 8] != 0) [[unlikely]] {
+            if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Watch)) {
+                OnWatchedAccess(address, value, WatchKind::Write);
+            }
+            if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Device)) {
+                bus_->Write(address, value);
+                return;
+            }
+            if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Journal)) {
+                journal_->Record(address);
+            }
+            OnAttributedWrite(address);
+        }
+        pages_[address >> 8][address & 0xFF] = value;
+    }
+
+    // Block transfers, a page at a time, wrapping around the end of memory.
+    // Reads see the pages themselves, so that dumping or saving memory has no side effects on devices, while
+    // writes reach devices byte by byte. Neither is seen by watchpoints nor recorded by the journal.
+    auto ReadBlock(std::uint16_t address, std::span<std::uint8_t> data) const noexcept -> void
+    {
+        while (!data.empty()) {
+            const std::size_t count = std::min(data.size(), pageSize - (address & 0xFF));
+            std::memcpy(data.data(), &pages_[address >> 8][address & 0xFF], count);
+            data    = data.subspan(count);
+            address = static_cast<std::uint16_t>(address + count);
+        }
+    }
+
+    auto WriteBlock(std::uint16_t address, std::span<const std::uint8_t> data) noexcept -> void
+    {
+        while (!data.empty()) {
+            const std::size_t count = std::min(data.size(), pageSize - (address & 0xFF));
+            if (pageAttributes_[address >> 8] & static_cast<std::uint8_t>(PageAttribute::Device)) {
+                for (std::size_t index = 0; index < count; index++) {
+                    bus_->Write(static_cast<std::uint16_t>(address + index), data[index]);
+                }
+            } else {
+                if (pageAttributes_[address >> 8] != 0) {
+                    OnAttributedWrite(address);
+                }
+                std::memcpy(&pages_[address >> 8][address & 0xFF], data.data(), count);
+            }
+            data    = data.subspan(count);
+            address = static_cast<std::uint16_t>(address + count);
+        }
+    }
+
+    [[nodiscard]] auto GetPageAttributes(const std::uint8_t page) const noexcept -> std::uint8_t
+    {
+        return pageAttributes_[page];
+    }
+
+    auto SetPageAttribute(const std::uint8_t page, const PageAttribute attribute) noexcept -> void
+    {
+        pageAttributes_[page] |= static_cast<std::uint8_t>(attribute);
+    }
+
+    auto ClearPageAttribute(const std::uint8_t page, const PageAttribute attribute) noexcept -> void
+    {
+        pageAttributes_[page] &= static_cast<std::uint8_t>(~static_cast<std::uint8_t>(attribute));
+    }
+
+    [[nodiscard]] auto GetPage(const std::uint8_t page) const noexcept -> std::span<const std::uint8_t, 0x100>
+    {
+        return std::span<const std::uint8_t, pageSize>(pages_[page], pageSize);
+    }
+
+    // The page table and the page attributes, for generated code which accesses pages with no attributes set in
+    // place and leaves every other page to Read() and Write()
+    [[nodiscard]] auto GetPageTable() noexcept -> std::uint8_t *const * { return pages_.data(); }
+
+    [[nodiscard]] auto GetPageAttributeTable() const noexcept -> const std::uint8_t *
+    {
+        return pageAttributes_.data();
+    }
+
+    // Backs a page by pageSize bytes owned elsewhere, e.g. by a mapped file. The page is marked shared, so the
+    // data is only written to once this memory holds the last reference to it.
+    auto MapPage(const std::uint8_t page, std::shared_ptr<std::uint8_t> data) noexcept -> void
+    {
+        pages_[page]  = data.get();
+        owners_[page] = std::move(data);
+        SetPageAttribute(page, PageAttribute::Shared);
+        if (pageAttributes_[page] & static_cast<std::uint8_t>(PageAttribute::Code)) {
+            dirtyPages_.set(page);
+            codeDirty_ = true;
+        }
+    }
 
-    [[nodiscard]] auto GetIterator(const std::uint16_t index = 0) noexcept
-        -> std::array<std::uint8_t, 0x10000>::iterator
+    // Routes the pages mapped on the bus to their devices, replacing any bus attached before, nullptr detaches.
+    // The bus is not owned and is shared by copies of this memory.
+    auto AttachBus(DeviceBus *bus) noexcept -> void
     {
-        return index < memory_.size() ? memory_.begin() + index : nullptr;
+        bus_ = bus;
+        for (std::size_t page = 0; page < pageAttributes_.size(); page++) {
+            if (bus != nullptr && bus->IsPageMapped(static_cast<std::uint8_t>(page))) {
+                SetPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Device);
+            } else {
+                ClearPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Device);
+            }
+        }
+    }
+
+    [[nodiscard]] auto GetBus() const noexcept -> DeviceBus * { return bus_; }
+
+    // Records every later Write() outside of device pages in journal, replacing any journal attached before,
+    // nullptr detaches. The journal is not owned.
+    auto AttachJournal(WriteJournal *journal) noexcept -> void
+    {
+        journal_ = journal;
+        for (std::size_t page = 0; page < pageAttributes_.size(); page++) {
+            if (journal != nullptr) {
+                SetPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Journal);
+            } else {
+                ClearPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Journal);
+            }
+        }
+    }
+
+    auto SetWatchpoint(const std::uint16_t address, const WatchKind kind) noexcept -> void
+    {
+        if (watchpoints_ == nullptr) {
+            watchpoints_ = std::make_unique<Watchpoints>();
+        }
+        Watchpoints &watchpoints = *watchpoints_;
+        if (!watchpoints.reads.test(address) && !watchpoints.writes.test(address)) {
+            watchpoints.count++;
+            watchpoints.pageCounts[address >> 8]++;
+            SetPageAttribute(static_cast<std::uint8_t>(address >> 8), PageAttribute::Watch);
+        }
+        watchpoints.reads[address]  = watchpoints.reads[address] || Includes(kind, WatchKind::Read);
+        watchpoints.writes[address] = watchpoints.writes[address] || Includes(kind, WatchKind::Write);
+    }
+
+    auto ClearWatchpoint(const std::uint16_t address, const WatchKind kind) noexcept -> void
+    {
+        if (watchpoints_ == nullptr || !(watchpoints_->reads.test(address) || watchpoints_->writes.test(address))) {
+            return;
+        }
+        Watchpoints &watchpoints = *watchpoints_;
+        watchpoints.reads[address]  = watchpoints.reads[address] && !Includes(kind, WatchKind::Read);
+        watchpoints.writes[address] = watchpoints.writes[address] && !Includes(kind, WatchKind::Write);
+        if (watchpoints.reads.test(address) || watchpoints.writes.test(address)) {
+            return;
+        }
+        if (--watchpoints.pageCounts[address >> 8] == 0) {
+            ClearPageAttribute(static_cast<std::uint8_t>(address >> 8), PageAttribute::Watch);
+        }
+        if (--watchpoints.count == 0) {
+            watchpoints_.reset();
+        }
+    }
+
+    auto ClearWatchpoints() noexcept -> void
+    {
+        for (std::size_t page = 0; page < pageAttributes_.size(); page++) {
+            ClearPageAttribute(static_cast<std::uint8_t>(page), PageAttribute::Watch);
+        }
+        watchpoints_.reset();
+        watchHit_.reset();
+    }
+
+    [[nodiscard]] auto HasWatchpoints() const noexcept -> bool { return watchpoints_ != nullptr; }
+
+    [[nodiscard]] auto HasWatchHit() const noexcept -> bool { return watchHit_.has_value(); }
+
+    [[nodiscard]] auto GetWatchHit() const noexcept -> const std::optional<WatchHit> & { return watchHit_; }
+
+    auto ClearWatchHit() noexcept -> void { watchHit_.reset(); }
+
+    // Set once a write lands in a page holding decoded code
+    [[nodiscard]] auto HasDirtyCode() const noexcept -> bool { return codeDirty_; }
+
+    // Returns the pages written to since the last call and clears the bitmap
+    [[nodiscard]] auto TakeDirtyPages() noexcept -> std::bitset<0x100>
+    {
+        const auto dirtyPages = dirtyPages_;
+        dirtyPages_.reset();
+        codeDirty_ = false;
+        return dirtyPages;
+    }
+
+    // Shares the pages of another memory, keeping this memory's page attributes.
+    // Only the pages which differ from the image are touched, and code pages whose contents change are marked
+    // dirty, so decoded blocks of unchanged code stay valid.
+    auto RestoreFrom(const SystemMemory &image) noexcept -> void
+    {
+        constexpr auto shared = static_cast<std::uint8_t>(PageAttribute::Shared);
+        for (std::size_t page = 0; page < pages_.size(); page++) {
+            if (pages_[page] == image.pages_[page]) {
+                continue;
+            }
+            if ((pageAttributes_[page] & static_cast<std::uint8_t>(PageAttribute::Code))
+                && std::memcmp(pages_[page], image.pages_[page], pageSize) != 0) {
+                dirtyPages_.set(page);
+                codeDirty_ = true;
+            }
+            pages_[page]  = image.pages_[page];
+            owners_[page] = image.owners_[page];
+            pageAttributes_[page] |= shared;
+            if (!(image.pageAttributes_[page] & shared)) {
+                image.pageAttributes_[page] |= shared;
+            }
+        }
+    }
+
+    // Number of pages not shared with any other memory, i.e. the bytes this memory owns divided by pageSize
+    [[nodiscard]] auto GetPrivatePageCount() const noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(std::count_if(pageAttributes_.begin(), pageAttributes_.end(),
+            [](const std::uint8_t attributes) {
+                return !(attributes & static_cast<std::uint8_t>(PageAttribute::Shared));
+            }));
+    }
+
+    // 64-bit hash of the whole address space, for comparing final memory states
+    [[nodiscard]] auto Digest() const noexcept -> std::uint64_t
+    {
+        constexpr std::uint64_t prime = 0x9E3779B97F4A7C15;
+        // Four independent lanes keep the multiplier busy
+        std::array<std::uint64_t, 4> lanes = { 0x243F6A8885A308D3, 0x13198A2E03707344, 0xA4093822299F31D0,
+            0x082EFA98EC4E6C89 };
+        for (const std::uint8_t *page : pages_) {
+            for (std::size_t offset = 0; offset < pageSize; offset += sizeof(std::uint64_t) * lanes.size()) {
+                for (std::size_t lane = 0; lane < lanes.size(); lane++) {
+                    std::uint64_t word = 0;
+                    std::memcpy(&word, &page[offset + lane * sizeof(word)], sizeof(word));
+                    lanes[lane] = std::rotl((lanes[lane] ^ word) * prime, 31);
+                }
+            }
+        }
+        std::uint64_t digest = 0;
+        for (const std::uint64_t lane : lanes) {
+            digest = std::rotl((digest ^ lane) * prime, 27);
+        }
+        return digest ^ (digest >> 32);
     }
 
     auto DumpMemoryContent(std::uint16_t startAddress, std::uint16_t endAddress, std::ostream &outStream) const noexcept
@@ -32,40 +399,126 @@ public: // Functions/Methods
             = "Addr:   00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F  ..ASCII Content.\n";
 
         outStream << tableHeader;
+        std::array<std::uint8_t, 0x10>  row {};
+        std::array<char, dumpRowLength> text {};
         for (std::size_t rowIndex = startAddress / 0x10; rowIndex < (endAddress + 0x10) / 0x10; rowIndex++) {
-            outStream << FormatTableRow(rowIndex * 0x10);
+            ReadBlock(static_cast<std::uint16_t>(rowIndex * 0x10), row);
+            (void)FormatDumpRow(static_cast<std::uint16_t>(rowIndex * 0x10), row, text.data());
+            outStream.write(text.data(), text.size());
         }
         outStream << "\nEnd of memory content:\n";
     }
 
+    // Writes one row of the memory dump, e.g. "0x8000: 48 49 00 ... 00  HI..............\n", the dumpRowLength
+    // characters from text on, returns the end of the row
+    [[nodiscard]] static auto FormatDumpRow(const std::uint16_t address,
+        const std::span<const std::uint8_t, 0x10> bytes, char *text) noexcept -> char *
+    {
+        constexpr std::string_view digits = "0123456789ABCDEF";
+        constexpr std::string_view lower  = "0123456789abcdef";
+        char                      *out    = text;
+
+        *out++ = '0';
+        *out++ = 'x';
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            *out++ = lower[(address >> shift) & 0x0F];
+        }
+        *out++ = ':';
+        for (const std::uint8_t byte : bytes) {
+            *out++ = ' ';
+            *out++ = digits[byte >> 4];
+            *out++ = digits[byte & 0x0F];
+        }
+        *out++ = ' ';
+        *out++ = ' ';
+        for (const std::uint8_t byte : bytes) {
+            *out++ = std::isprint(byte) ? static_cast<char>(byte) : '.';
+        }
+        *out++ = '\n';
+        return out;
+    }
+
 private: // Functions/Methods
-    [[nodiscard]] inline auto GetPrintableChar(const unsigned char c) const noexcept -> unsigned char
+    using Page = std::array<std::uint8_t, 0x100>;
+
+    // Backs every page of a freshly constructed memory without an owner, so copying those pages does not touch
+    // any reference count. Never written to, as pages without an owner are always marked shared.
+    [[nodiscard]] static auto ZeroPage() noexcept -> Page &
+    {
+        alignas(64) static Page zeroPage {};
+        return zeroPage;
+    }
+
+    // Only stores into pages not yet marked, copying an already shared memory does not write to it
+    auto MarkShared() const noexcept -> void
     {
-        return std::isprint(c) ? c : '.';
+        for (auto &attributes : pageAttributes_) {
+            if (!(attributes & static_cast<std::uint8_t>(PageAttribute::Shared))) {
+                attributes |= static_cast<std::uint8_t>(PageAttribute::Shared);
+            }
+        }
     }
 
-    [[nodiscard]] auto FormatTableRow(std::size_t rowStartingAddress) const noexcept -> std::string
+    [[nodiscard]] static constexpr auto Includes(const WatchKind kind, const WatchKind part) noexcept -> bool
     {
-        constexpr const char *tableFormat = "{:#06x}: {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} "
-                                            "{:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X}  {:16}\n";
+        return (static_cast<std::uint8_t>(kind) & static_cast<std::uint8_t>(part)) != 0;
+    }
 
-        std::stringstream ss;
-        for (std::size_t iter = 0; iter < 0x10; iter++) {
-            ss << GetPrintableChar(static_cast<unsigned char>(memory_[rowStartingAddress + iter]));
+    auto OnWatchedAccess(const std::uint16_t address, const std::uint8_t value, const WatchKind kind) const noexcept
+        -> void
+    {
+        const auto &watched = kind == WatchKind::Read ? watchpoints_->reads : watchpoints_->writes;
+        if (watched.test(address) && !watchHit_.has_value()) {
+            watchHit_ = WatchHit { address, value, kind };
         }
+    }
 
-        return fmt::format(tableFormat, rowStartingAddress, memory_[rowStartingAddress + 0x00],
-            memory_[rowStartingAddress + 0x01], memory_[rowStartingAddress + 0x02], memory_[rowStartingAddress + 0x03],
-            memory_[rowStartingAddress + 0x04], memory_[rowStartingAddress + 0x05], memory_[rowStartingAddress + 0x06],
-            memory_[rowStartingAddress + 0x07], memory_[rowStartingAddress + 0x08], memory_[rowStartingAddress + 0x09],
-            memory_[rowStartingAddress + 0x0A], memory_[rowStartingAddress + 0x0B], memory_[rowStartingAddress + 0x0C],
-            memory_[rowStartingAddress + 0x0D], memory_[rowStartingAddress + 0x0E], memory_[rowStartingAddress + 0x0F],
-            ss.str());
+    auto OnAttributedWrite(const std::uint16_t address) noexcept -> void
+    {
+        const auto page = static_cast<std::uint8_t>(address >> 8);
+        if (pageAttributes_[page] & static_cast<std::uint8_t>(PageAttribute::Shared)) {
+            // The last owner of a page may keep it, everyone else takes a private copy
+            if (owners_[page] == nullptr || owners_[page].use_count() > 1) {
+                auto          copy = std::make_shared<Page>();
+                std::uint8_t *data = copy->data();
+                std::memcpy(data, pages_[page], pageSize);
+                pages_[page]  = data;
+                owners_[page] = std::shared_ptr<std::uint8_t>(std::move(copy), data);
+            }
+            ClearPageAttribute(page, PageAttribute::Shared);
+        }
+        if (pageAttributes_[page] & static_cast<std::uint8_t>(PageAttribute::Code)) {
+            dirtyPages_.set(page);
+            codeDirty_ = true;
+        }
     }
 
-public:  // Data Members
+public: // Data Members
+    static constexpr std::size_t pageSize      = 0x100;
+    static constexpr std::size_t dumpRowLength = 74;
+
 private: // Data Members
-    std::array<std::uint8_t, 0x10000> memory_ { 0 };
+    // Page table used by reads and writes, owners_ holds the reference counts of the pages not backed by the zero page
+    std::array<std::uint8_t *, 0x100>                pages_ {};
+    std::array<std::shared_ptr<std::uint8_t>, 0x100> owners_;
+    // Mutable as copying a memory marks the pages of the source as shared
+    mutable std::array<std::uint8_t, 0x100> pageAttributes_ {};
+    std::bitset<0x100>                      dirtyPages_;
+    bool                                    codeDirty_ = false;
+    DeviceBus                              *bus_       = nullptr;
+    WriteJournal                           *journal_   = nullptr;
+
+    // Allocated while any watchpoint is set, count and pageCounts hold the number of watched addresses in all and
+    // in each page
+    struct Watchpoints {
+        std::bitset<0x10000>             reads;
+        std::bitset<0x10000>             writes;
+        std::array<std::uint16_t, 0x100> pageCounts {};
+        std::size_t                      count = 0;
+    };
+    std::unique_ptr<Watchpoints> watchpoints_;
+    // Mutable as reads record hits
+    mutable std::optional<WatchHit> watchHit_;
 };
 
 } // namespace intel_8085
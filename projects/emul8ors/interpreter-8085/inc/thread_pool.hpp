@@ -0,0 +1,150 @@
+#ifndef INTERPRETER_8085_THREAD_POOL_HPP
+#define INTERPRETER_8085_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace intel_8085 {
+
+// Fixed set of worker threads running index based batches.
+// Every worker owns a deque of job indices, it takes work from the back of its own deque and steals from
+// the front of the others once it runs dry, so uneven jobs still keep every core busy.
+class ThreadPool {
+public: // Functions/Methods
+    using Task = std::function<void(std::size_t worker, std::size_t job)>;
+
+    explicit ThreadPool(const std::size_t threadCount = std::max(1U, std::thread::hardware_concurrency()))
+    {
+        for (std::size_t index = 0; index < std::max<std::size_t>(threadCount, 1); index++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t index = 0; index < queues_.size(); index++) {
+            threads_.emplace_back([this, index] { WorkerLoop(index); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &)                     = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Calls task(worker, job) for every job in [0, jobCount) and returns once all of them are done.
+    // worker is in [0, GetThreadCount()) and identifies the thread, e.g. to pick per-thread scratch state.
+    auto ForEach(const std::size_t jobCount, Task task) -> void
+    {
+        if (jobCount == 0) {
+            return;
+        }
+        std::unique_lock lock(mutex_);
+        // The task is published before the jobs, a worker still stealing from the previous batch only sees
+        // a job through the queue mutex
+        task_    = std::move(task);
+        pending_ = jobCount;
+        // Contiguous shares keep neighbouring jobs, which tend to be alike, on the same worker
+        const std::size_t share = (jobCount + queues_.size() - 1) / queues_.size();
+        for (std::size_t worker = 0; worker < queues_.size(); worker++) {
+            std::lock_guard queueLock(queues_[worker]->mutex);
+            for (std::size_t job = worker * share; job < std::min(jobCount, (worker + 1) * share); job++) {
+                queues_[worker]->jobs.push_back(job);
+            }
+        }
+        generation_++;
+        wake_.notify_all();
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+
+    [[nodiscard]] auto GetThreadCount() const noexcept -> std::size_t { return threads_.size(); }
+
+private: // Functions/Methods
+    struct Queue {
+        std::mutex              mutex;
+        std::deque<std::size_t> jobs;
+    };
+
+    auto WorkerLoop(const std::size_t worker) -> void
+    {
+        std::uint64_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+                if (stopping_) {
+                    return;
+                }
+                seenGeneration = generation_;
+            }
+            std::size_t completed = 0;
+            while (const auto job = NextJob(worker)) {
+                task_(worker, job.value());
+                completed++;
+            }
+            if (completed > 0) {
+                std::lock_guard lock(mutex_);
+                pending_ -= completed;
+                if (pending_ == 0) {
+                    done_.notify_one();
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] auto NextJob(const std::size_t worker) -> std::optional<std::size_t>
+    {
+        {
+            Queue          &own = *queues_[worker];
+            std::lock_guard lock(own.mutex);
+            if (!own.jobs.empty()) {
+                const std::size_t job = own.jobs.back();
+                own.jobs.pop_back();
+                return job;
+            }
+        }
+        for (std::size_t offset = 1; offset < queues_.size(); offset++) {
+            Queue          &victim = *queues_[(worker + offset) % queues_.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                const std::size_t job = victim.jobs.front();
+                victim.jobs.pop_front();
+                return job;
+            }
+        }
+        return std::nullopt;
+    }
+
+public:  // Data Members
+private: // Data Members
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread>            threads_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Task                    task_;
+    std::size_t             pending_    = 0;
+    std::uint64_t           generation_ = 0;
+    bool                    stopping_   = false;
+};
+
+} // namespace intel_8085
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef INTERPRETER_8085_WRITE_JOURNAL_HPP
+#define INTERPRETER_8085_WRITE_JOURNAL_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace intel_8085 {
+
+// A memory write as recorded by the WriteJournal: the address and the T-state count at the write relative to the
+// start of the journal segment, 8 bytes in all once padded
+struct JournalEntry {
+    std::uint32_t cycleDelta;
+    std::uint16_t address;
+};
+
+// Log of the memory writes since the start of the current segment, appended to by SystemMemory::Write() while
+// attached. The cycle count is read at every write, so the writing instruction can be found again by its cycles.
+// Segments are cut by the owner, which hands the journal a spare buffer at every cut and keeps the entries of the
+// segment ended, so buffers are recycled rather than reallocated once the owner starts dropping old segments.
+class WriteJournal {
+public: // Functions/Methods
+    explicit WriteJournal(const std::uint64_t &cycles) noexcept : cycles_(cycles) { }
+
+    WriteJournal(const WriteJournal &)                     = delete;
+    auto operator=(const WriteJournal &) -> WriteJournal & = delete;
+
+    auto Record(const std::uint16_t address) noexcept -> void
+    {
+        entries_.push_back({ static_cast<std::uint32_t>(cycles_ - base_), address });
+    }
+
+    // Starts a new segment at the current cycle count in spare, returns the entries of the segment it ends
+    [[nodiscard]] auto Cut(std::vector<JournalEntry> spare) noexcept -> std::vector<JournalEntry>
+    {
+        spare.clear();
+        std::swap(entries_, spare);
+        base_ = cycles_;
+        return spare;
+    }
+
+    [[nodiscard]] auto GetEntries() const noexcept -> const std::vector<JournalEntry> & { return entries_; }
+
+    // Cycle count the current segment started at
+    [[nodiscard]] auto GetBase() const noexcept -> std::uint64_t { return base_; }
+
+public:  // Data Members
+private: // Data Members
+    const std::uint64_t      &cycles_;
+    std::uint64_t             base_ = 0;
+    std::vector<JournalEntry> entries_;
+};
+
+} // namespace intel_8085
+
+#endif
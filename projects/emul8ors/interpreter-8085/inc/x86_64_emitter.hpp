@@ -0,0 +1,480 @@
+#ifndef INTERPRETER_8085_X86_64_EMITTER_HPP
+#define INTERPRETER_8085_X86_64_EMITTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace intel_8085::x86_64 {
+
+// Host general purpose registers, numbered as in the ModRM/REX encoding
+enum class Reg : std::uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// 8 bit ALU operations, numbered as the /digit of opcode 0x80 (and the base opcode / 8 of the register forms)
+enum class AluOp : std::uint8_t { ADD, OR, ADC, SBB, AND, SUB, XOR, CMP };
+
+// x86 condition codes for Jcc
+enum class Condition : std::uint8_t { B = 0x2, Z = 0x4, NZ = 0x5 };
+
+// Minimal x86-64 encoder covering what the JitCompiler emits.
+// 8 bit operands are always encoded with a REX prefix, which makes registers 4-7 (SPL-DIL) addressable
+// instead of AH-BH, so only AL-DL and R8B-R15B may be used as byte registers.
+class Emitter {
+public: // Functions/Methods
+    using Label = std::size_t;
+
+    [[nodiscard]] auto GetCode() const noexcept -> const std::vector<std::uint8_t> & { return code_; }
+
+    [[nodiscard]] auto Here() const noexcept -> Label { return code_.size(); }
+
+    auto Clear() noexcept -> void { code_.clear(); }
+
+    // push r64 / pop r64
+    auto Push(const Reg reg) noexcept -> void
+    {
+        Rex(false, Reg::RAX, reg, false);
+        Byte(static_cast<std::uint8_t>(0x50 | Low(reg)));
+    }
+
+    auto Pop(const Reg reg) noexcept -> void
+    {
+        Rex(false, Reg::RAX, reg, false);
+        Byte(static_cast<std::uint8_t>(0x58 | Low(reg)));
+    }
+
+    auto Ret() noexcept -> void { Byte(0xC3); }
+
+    // mov r8, [base + disp8] / mov [base + disp8], r8
+    auto LoadByte(const Reg dst, const Reg base, const std::uint8_t disp) noexcept -> void
+    {
+        Rex(false, dst, base, true);
+        Byte(0x8A);
+        ModRmDisp8(dst, base, disp);
+    }
+
+    auto StoreByte(const Reg base, const std::uint8_t disp, const Reg src) noexcept -> void
+    {
+        Rex(false, src, base, true);
+        Byte(0x88);
+        ModRmDisp8(src, base, disp);
+    }
+
+    // mov word [base + disp8], imm16
+    auto StoreWordImmediate(const Reg base, const std::uint8_t disp, const std::uint16_t value) noexcept -> void
+    {
+        Byte(0x66);
+        Rex(false, Reg::RAX, base, false);
+        Byte(0xC7);
+        ModRmDisp8(Reg::RAX, base, disp);
+        Word(value);
+    }
+
+    // mov r8, [base + index] / mov [base + index], r8
+    auto LoadByteIndexed(const Reg dst, const Reg base, const Reg index) noexcept -> void
+    {
+        RexIndexed(false, dst, index, base, true);
+        Byte(0x8A);
+        ModRmSib(Low(dst), base, index, 0);
+    }
+
+    auto StoreByteIndexed(const Reg base, const Reg index, const Reg src) noexcept -> void
+    {
+        RexIndexed(false, src, index, base, true);
+        Byte(0x88);
+        ModRmSib(Low(src), base, index, 0);
+    }
+
+    // test byte [base + index], imm8
+    auto TestByteIndexed(const Reg base, const Reg index, const std::uint8_t value) noexcept -> void
+    {
+        RexIndexed(false, Reg::RAX, index, base, false);
+        Byte(0xF6);
+        ModRmSib(0, base, index, 0);
+        Byte(value);
+    }
+
+    // movzx r32, word [base + index * 2]
+    auto ZeroExtendWordIndexed(const Reg dst, const Reg base, const Reg index) noexcept -> void
+    {
+        RexIndexed(false, dst, index, base, false);
+        Byte(0x0F);
+        Byte(0xB7);
+        ModRmSib(Low(dst), base, index, 1);
+    }
+
+    // mov r64, [base + index * 8]
+    auto LoadQwordIndexed(const Reg dst, const Reg base, const Reg index) noexcept -> void
+    {
+        RexIndexed(true, dst, index, base, false);
+        Byte(0x8B);
+        ModRmSib(Low(dst), base, index, 3);
+    }
+
+    // add dword/qword [base + disp8], imm32
+    auto AddMemoryImmediate(
+        const Reg base, const std::uint8_t disp, const std::uint32_t value, const bool wide) noexcept -> void
+    {
+        Rex(wide, Reg::RAX, base, false);
+        Byte(0x81);
+        ModRmDisp8(Reg::RAX, base, disp);
+        Dword(value);
+    }
+
+    // mov r64, [base + disp8] / cmp r64, [base + disp8]
+    auto LoadQword(const Reg dst, const Reg base, const std::uint8_t disp) noexcept -> void
+    {
+        Rex(true, dst, base, false);
+        Byte(0x8B);
+        ModRmDisp8(dst, base, disp);
+    }
+
+    auto CompareQword(const Reg lhs, const Reg base, const std::uint8_t disp) noexcept -> void
+    {
+        Rex(true, lhs, base, false);
+        Byte(0x3B);
+        ModRmDisp8(lhs, base, disp);
+    }
+
+    // add r64, imm32
+    auto AddImmediate64(const Reg dst, const std::uint32_t value) noexcept -> void
+    {
+        Rex(true, Reg::RAX, dst, false);
+        Byte(0x81);
+        ModRm(Reg::RAX, dst);
+        Dword(value);
+    }
+
+    // mov r32, imm32 / mov r64, imm64
+    auto MovImmediate32(const Reg dst, const std::uint32_t value) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, false);
+        Byte(static_cast<std::uint8_t>(0xB8 | Low(dst)));
+        Dword(value);
+    }
+
+    auto MovImmediate64(const Reg dst, const std::uint64_t value) noexcept -> void
+    {
+        Rex(true, Reg::RAX, dst, false);
+        Byte(static_cast<std::uint8_t>(0xB8 | Low(dst)));
+        Dword(static_cast<std::uint32_t>(value));
+        Dword(static_cast<std::uint32_t>(value >> 32));
+    }
+
+    // call r64
+    auto CallRegister(const Reg target) noexcept -> void
+    {
+        Rex(false, Reg::RAX, target, false);
+        Byte(0xFF);
+        ModRm(2, target);
+    }
+
+    // 8 bit register forms
+    auto Mov8(const Reg dst, const Reg src) noexcept -> void { RegReg8(0x88, dst, src); }
+
+    auto MovImmediate8(const Reg dst, const std::uint8_t value) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, true);
+        Byte(static_cast<std::uint8_t>(0xB0 | Low(dst)));
+        Byte(value);
+    }
+
+    auto Alu8(const AluOp op, const Reg dst, const Reg src) noexcept -> void
+    {
+        RegReg8(static_cast<std::uint8_t>(static_cast<std::uint8_t>(op) << 3), dst, src);
+    }
+
+    auto AluImmediate8(const AluOp op, const Reg dst, const std::uint8_t value) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, true);
+        Byte(0x80);
+        ModRm(static_cast<std::uint8_t>(op), dst);
+        Byte(value);
+    }
+
+    auto Xchg8(const Reg lhs, const Reg rhs) noexcept -> void { RegReg8(0x86, lhs, rhs); }
+
+    auto Increment8(const Reg dst) noexcept -> void { Group8(0xFE, 0, dst); }
+
+    auto Decrement8(const Reg dst) noexcept -> void { Group8(0xFE, 1, dst); }
+
+    auto Not8(const Reg dst) noexcept -> void { Group8(0xF6, 2, dst); }
+
+    auto TestImmediate8(const Reg dst, const std::uint8_t value) noexcept -> void
+    {
+        Group8(0xF6, 0, dst);
+        Byte(value);
+    }
+
+    // Rotate by one: 0 - ROL, 1 - ROR, 2 - RCL, 3 - RCR
+    auto Rotate8(const std::uint8_t kind, const Reg dst) noexcept -> void { Group8(0xD0, kind, dst); }
+
+    // setc r8
+    auto SetCarry8(const Reg dst) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, true);
+        Byte(0x0F);
+        Byte(0x92);
+        ModRm(0, dst);
+    }
+
+    // bt r32, imm8 (copies a bit into CF)
+    auto BitTest32(const Reg reg, const std::uint8_t bit) noexcept -> void
+    {
+        Rex(false, Reg::RAX, reg, false);
+        Byte(0x0F);
+        Byte(0xBA);
+        ModRm(4, reg);
+        Byte(bit);
+    }
+
+    // lahf; movzx eax, ah (SF:ZF:0:AF:0:PF:1:CF into eax)
+    auto LoadFlagsToEax() noexcept -> void
+    {
+        Byte(0x9F);
+        Byte(0x0F);
+        Byte(0xB6);
+        Byte(0xC4);
+    }
+
+    // movzx r32, r8
+    auto ZeroExtend8(const Reg dst, const Reg src) noexcept -> void
+    {
+        Rex(false, dst, src, true);
+        Byte(0x0F);
+        Byte(0xB6);
+        ModRm(dst, src);
+    }
+
+    // 32 bit register forms
+    auto Mov32(const Reg dst, const Reg src) noexcept -> void { RegReg32(0x89, dst, src); }
+
+    auto Or32(const Reg dst, const Reg src) noexcept -> void { RegReg32(0x09, dst, src); }
+
+    auto AluImmediate32(const AluOp op, const Reg dst, const std::uint32_t value) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, false);
+        Byte(0x81);
+        ModRm(static_cast<std::uint8_t>(op), dst);
+        Dword(value);
+    }
+
+    // shl/shr r32, imm8
+    auto ShiftLeft32(const Reg dst, const std::uint8_t count) noexcept -> void { Shift32(4, dst, count); }
+
+    auto ShiftRight32(const Reg dst, const std::uint8_t count) noexcept -> void { Shift32(5, dst, count); }
+
+    // 16 bit register forms
+    auto Increment16(const Reg dst) noexcept -> void { Group16(0xFF, 0, dst); }
+
+    auto Decrement16(const Reg dst) noexcept -> void { Group16(0xFF, 1, dst); }
+
+    auto Add16(const Reg dst, const Reg src) noexcept -> void
+    {
+        Byte(0x66);
+        RegReg32(0x01, dst, src);
+    }
+
+    // Branches with a 32 bit displacement, returning the location to Patch() once the target is known
+    [[nodiscard]] auto Jump() noexcept -> Label
+    {
+        Byte(0xE9);
+        return Displacement();
+    }
+
+    [[nodiscard]] auto JumpIf(const Condition condition) noexcept -> Label
+    {
+        Byte(0x0F);
+        Byte(static_cast<std::uint8_t>(0x80 | static_cast<std::uint8_t>(condition)));
+        return Displacement();
+    }
+
+    auto JumpIfTo(const Condition condition, const Label target) noexcept -> void
+    {
+        Patch(JumpIf(condition), target);
+    }
+
+    auto Patch(const Label displacement, const Label target) noexcept -> void
+    {
+        const auto relative = static_cast<std::int32_t>(static_cast<std::int64_t>(target)
+            - static_cast<std::int64_t>(displacement + sizeof(std::int32_t)));
+        std::memcpy(code_.data() + displacement, &relative, sizeof(relative));
+    }
+
+private: // Functions/Methods
+    [[nodiscard]] static constexpr auto Low(const Reg reg) noexcept -> std::uint8_t
+    {
+        return static_cast<std::uint8_t>(reg) & 0x07;
+    }
+
+    [[nodiscard]] static constexpr auto High(const Reg reg) noexcept -> std::uint8_t
+    {
+        return static_cast<std::uint8_t>(reg) >> 3;
+    }
+
+    auto Byte(const std::uint8_t value) noexcept -> void { code_.push_back(value); }
+
+    auto Word(const std::uint16_t value) noexcept -> void
+    {
+        Byte(static_cast<std::uint8_t>(value));
+        Byte(static_cast<std::uint8_t>(value >> 8));
+    }
+
+    auto Dword(const std::uint32_t value) noexcept -> void
+    {
+        Word(static_cast<std::uint16_t>(value));
+        Word(static_cast<std::uint16_t>(value >> 16));
+    }
+
+    [[nodiscard]] auto Displacement() noexcept -> Label
+    {
+        const Label label = Here();
+        Dword(0);
+        return label;
+    }
+
+    // REX.W, REX.R (extends ModRM.reg) and REX.B (extends ModRM.rm), always emitted for byte registers
+    auto Rex(const bool wide, const Reg reg, const Reg rm, const bool byteRegisters) noexcept -> void
+    {
+        const auto rex = static_cast<std::uint8_t>(0x40 | (wide ? 0x08 : 0x00) | High(reg) << 2 | High(rm));
+        if (rex != 0x40 || byteRegisters) {
+            Byte(rex);
+        }
+    }
+
+    // REX.X extends SIB.index
+    auto RexIndexed(const bool wide, const Reg reg, const Reg index, const Reg base, const bool byteRegisters) noexcept
+        -> void
+    {
+        const auto rex = static_cast<std::uint8_t>(
+            0x40 | (wide ? 0x08 : 0x00) | High(reg) << 2 | High(index) << 1 | High(base));
+        if (rex != 0x40 || byteRegisters) {
+            Byte(rex);
+        }
+    }
+
+    auto ModRm(const Reg reg, const Reg rm) noexcept -> void { ModRm(Low(reg), rm); }
+
+    auto ModRm(const std::uint8_t digit, const Reg rm) noexcept -> void
+    {
+        Byte(static_cast<std::uint8_t>(0xC0 | (digit & 0x07) << 3 | Low(rm)));
+    }
+
+    auto ModRmDisp8(const Reg reg, const Reg base, const std::uint8_t disp) noexcept -> void
+    {
+        Byte(static_cast<std::uint8_t>(0x40 | Low(reg) << 3 | Low(base)));
+        Byte(disp);
+    }
+
+    // [base + index << scale], base may not be RBP or R13 (encoding a displacement instead) nor index RSP
+    auto ModRmSib(const std::uint8_t reg, const Reg base, const Reg index, const std::uint8_t scale) noexcept -> void
+    {
+        Byte(static_cast<std::uint8_t>((reg & 0x07) << 3 | 0x04));
+        Byte(static_cast<std::uint8_t>(scale << 6 | Low(index) << 3 | Low(base)));
+    }
+
+    auto RegReg8(const std::uint8_t opcode, const Reg dst, const Reg src) noexcept -> void
+    {
+        Rex(false, src, dst, true);
+        Byte(opcode);
+        ModRm(src, dst);
+    }
+
+    auto RegReg32(const std::uint8_t opcode, const Reg dst, const Reg src) noexcept -> void
+    {
+        Rex(false, src, dst, false);
+        Byte(opcode);
+        ModRm(src, dst);
+    }
+
+    auto Group8(const std::uint8_t opcode, const std::uint8_t digit, const Reg dst) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, true);
+        Byte(opcode);
+        ModRm(digit, dst);
+    }
+
+    auto Group16(const std::uint8_t opcode, const std::uint8_t digit, const Reg dst) noexcept -> void
+    {
+        Byte(0x66);
+        Rex(false, Reg::RAX, dst, false);
+        Byte(opcode);
+        ModRm(digit, dst);
+    }
+
+    auto Shift32(const std::uint8_t digit, const Reg dst, const std::uint8_t count) noexcept -> void
+    {
+        Rex(false, Reg::RAX, dst, false);
+        Byte(0xC1);
+        ModRm(digit, dst);
+        Byte(count);
+    }
+
+public:  // Data Members
+private: // Data Members
+    std::vector<std::uint8_t> code_;
+};
+
+// Bump allocated region of host memory for generated code.
+// The region is kept writable while code is being copied in and executable otherwise (W^X).
+class ExecutableArena {
+public: // Functions/Methods
+    explicit ExecutableArena(const std::size_t capacity = 0x100000) noexcept : capacity_(capacity) {}
+
+    ExecutableArena(const ExecutableArena &) = delete;
+
+    auto operator=(const ExecutableArena &) -> ExecutableArena & = delete;
+
+    ~ExecutableArena()
+    {
+        if (base_ != nullptr) {
+            munmap(base_, capacity_);
+        }
+    }
+
+    // Copies the code in and returns its executable address, nullptr if the arena is full or unavailable
+    [[nodiscard]] auto Commit(const std::vector<std::uint8_t> &code) noexcept -> const void *
+    {
+        if (base_ == nullptr && !Map()) {
+            return nullptr;
+        }
+        if (code.size() > capacity_ - used_ || mprotect(base_, capacity_, PROT_READ | PROT_WRITE) != 0) {
+            return nullptr;
+        }
+        auto *const destination = static_cast<std::uint8_t *>(base_) + used_;
+        std::memcpy(destination, code.data(), code.size());
+        used_ += (code.size() + 0x0F) & ~std::size_t { 0x0F };
+        if (mprotect(base_, capacity_, PROT_READ | PROT_EXEC) != 0) {
+            return nullptr;
+        }
+        return destination;
+    }
+
+    // Discards all code, callers must drop every pointer handed out before
+    auto Reset() noexcept -> void { used_ = 0; }
+
+    [[nodiscard]] auto GetUsed() const noexcept -> std::size_t { return used_; }
+
+private: // Functions/Methods
+    [[nodiscard]] auto Map() noexcept -> bool
+    {
+        void *const base = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        base_ = base;
+        return true;
+    }
+
+public:  // Data Members
+private: // Data Members
+    void       *base_ = nullptr;
+    std::size_t capacity_;
+    std::size_t used_ = 0;
+};
+
+} // namespace intel_8085::x86_64
+
+#endif
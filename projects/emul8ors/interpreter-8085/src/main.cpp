@@ -1,18 +1,492 @@
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "spdlog/spdlog.h"
 
+#include "batch_runner.hpp"
+#include "bulk_assembler.hpp"
+#include "control_flow_graph.hpp"
 #include "instruction_set.hpp"
+#include "memory_inspector.hpp"
+#include "peripherals.hpp"
 #include "processor.hpp"
+#include "program_image.hpp"
+#include "program_loader.hpp"
+#include "snapshot.hpp"
+
+namespace {
+
+auto ParseDispatchModeArgument(const char *argument, intel_8085::DispatchMode &dispatchMode) -> bool
+{
+    const auto parsed = intel_8085::ParseDispatchMode(argument);
+    if (!parsed.has_value()) {
+        spdlog::error("Unknown dispatch mode {}, expected one of table, switch, threaded, cached or jit", argument);
+        return false;
+    }
+    dispatchMode = parsed.value();
+    return true;
+}
+
+auto ParseNumberArgument(const std::string_view argument, std::uint64_t &value) -> bool
+{
+    const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+    if (error != std::errc {} || end != argument.data() + argument.size()) {
+        spdlog::error("Expected a number and received {}", argument);
+        return false;
+    }
+    return true;
+}
+
+// Loads a program or continues from a save state, telling them apart by the save state magic
+template <typename Processor>
+auto LoadProgramOrSnapshot(Processor &processor, const std::string &filename) -> bool
+{
+    if (intel_8085::Snapshot::IsSnapshot(filename)) {
+        return processor.LoadSnapshot(filename);
+    }
+    return processor.LoadProgram(filename);
+}
+
+// i8085 compile <program> <image>
+// Assembles a .program file into a program image, or into Intel HEX when the output ends with .hex
+auto RunCompile(const int argc, char **argv) -> int
+{
+    if (argc != 4) {
+        spdlog::error("Usage: {} compile <program> <image or .hex file>", argv[0]);
+        return 1;
+    }
+    const auto program = intel_8085::ProgramLoader::Parse(argv[2]);
+    if (!program.has_value() || !intel_8085::ProgramLoader::VerifyProgram(program.value())) {
+        spdlog::error("Invalid program, could not compile {}", argv[2]);
+        return 1;
+    }
+    const std::string output = argv[3];
+    const bool        written = intel_8085::ProgramImage::IsIntelHex(output)
+        ? intel_8085::ProgramImage::WriteIntelHex(program.value(), output)
+        : intel_8085::ProgramImage::WriteImage(program.value(), output);
+    return written ? 0 : 1;
+}
+
+// i8085 assemble <source directory> <output directory> [threads] [image or hex]
+// Assembles every .program file in the source tree into the output tree and writes manifest.csv next to them,
+// printing the errors of the programs that failed once all of them are done
+auto RunAssemble(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 6) {
+        spdlog::error("Usage: {} assemble <source directory> <output directory> [threads] [image or hex]", argv[0]);
+        return 1;
+    }
+    std::uint64_t threads = 0;
+    if (argc > 4 && !ParseNumberArgument(argv[4], threads)) {
+        return 1;
+    }
+    auto format = intel_8085::ImageFormat::Image;
+    if (argc > 5 && std::string_view(argv[5]) == "hex") {
+        format = intel_8085::ImageFormat::IntelHex;
+    } else if (argc > 5 && std::string_view(argv[5]) != "image") {
+        spdlog::error("Unknown image format {}, expected image or hex", argv[5]);
+        return 1;
+    }
+
+    intel_8085::ThreadPool    pool(threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads);
+    intel_8085::BulkAssembler assembler(pool, format);
+    const auto                start   = std::chrono::steady_clock::now();
+    const auto                results = assembler.Run(argv[2], argv[3]);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::size_t failed = 0;
+    for (const auto &result : results) {
+        if (!result.success) {
+            failed++;
+            fmt::print("{}:\n", result.source.string());
+            for (const auto &error : result.errors) {
+                fmt::print("    {}\n", error);
+            }
+        }
+    }
+    spdlog::info("Assembled {} of {} programs on {} threads in {:.6f}s", results.size() - failed, results.size(),
+        pool.GetThreadCount(), elapsed.count());
+    return failed == 0 ? 0 : 1;
+}
+
+// i8085 profile <program or save state> [top count] [folded stacks] [cycle budget]
+// Runs the program with profiling and prints the hottest addresses, opcodes and subroutines. The folded call stacks
+// are written for flamegraph.pl when a file is given for them.
+auto RunProfile(const int argc, char **argv) -> int
+{
+    if (argc < 3 || argc > 6) {
+        spdlog::error("Usage: {} profile <program or save state> [top count] [folded stacks] [cycle budget]", argv[0]);
+        return 1;
+    }
+    std::uint64_t topCount    = 20;
+    std::uint64_t cycleBudget = std::numeric_limits<std::uint64_t>::max();
+    if ((argc > 3 && !ParseNumberArgument(argv[3], topCount))
+        || (argc > 5 && !ParseNumberArgument(argv[5], cycleBudget))) {
+        return 1;
+    }
+
+    intel_8085::ProfilingProcessor processor;
+    if (!LoadProgramOrSnapshot(processor, argv[2])) {
+        return 1;
+    }
+    const std::uint64_t instructions = processor.Run(cycleBudget);
+    spdlog::info("Executed {} instructions ({} T-states)", instructions, processor.GetCycles());
+    processor.GetProfiler().WriteReport(std::cout, topCount);
+    if (argc > 4) {
+        std::ofstream folded(argv[4], std::ios::trunc);
+        processor.GetProfiler().WriteFoldedStacks(folded);
+        if (!folded) {
+            spdlog::error("Could not write the folded stacks to {}", argv[4]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// i8085 trace <program or save state> <trace file> [cycle budget]
+// Runs the program recording every instruction executed, with the registers it left behind, into a trace file
+auto RunTrace(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 5) {
+        spdlog::error("Usage: {} trace <program or save state> <trace file> [cycle budget]", argv[0]);
+        return 1;
+    }
+    std::uint64_t cycleBudget = std::numeric_limits<std::uint64_t>::max();
+    if (argc > 4 && !ParseNumberArgument(argv[4], cycleBudget)) {
+        return 1;
+    }
+
+    intel_8085::TracingProcessor processor;
+    if (!LoadProgramOrSnapshot(processor, argv[2]) || !processor.GetProfiler().Open(argv[3])) {
+        return 1;
+    }
+    const auto                          start        = std::chrono::steady_clock::now();
+    const std::uint64_t                 instructions = processor.Run(cycleBudget);
+    const bool                          written      = processor.GetProfiler().Close();
+    const std::chrono::duration<double> elapsed      = std::chrono::steady_clock::now() - start;
+    spdlog::info("Traced {} instructions ({} T-states) in {:.6f}s", instructions, processor.GetCycles(),
+        elapsed.count());
+    return written ? 0 : 1;
+}
+
+// i8085 decode-trace <trace file> [first record] [record count]
+// Prints the records of a trace file as text, one instruction per line
+auto RunDecodeTrace(const int argc, char **argv) -> int
+{
+    if (argc < 3 || argc > 5) {
+        spdlog::error("Usage: {} decode-trace <trace file> [first record] [record count]", argv[0]);
+        return 1;
+    }
+    std::uint64_t first = 0;
+    std::uint64_t count = std::numeric_limits<std::uint64_t>::max();
+    if ((argc > 3 && !ParseNumberArgument(argv[3], first)) || (argc > 4 && !ParseNumberArgument(argv[4], count))) {
+        return 1;
+    }
+
+    intel_8085::TraceReader reader;
+    if (!reader.Open(argv[2])) {
+        return 1;
+    }
+    const std::uint64_t     end = first + std::min(count, std::numeric_limits<std::uint64_t>::max() - first);
+    intel_8085::TraceRecord record;
+    std::uint64_t           index = 0;
+    for (; index < end && reader.Next(record); index++) {
+        if (index >= first) {
+            fmt::print("{}\n", intel_8085::TraceReader::Format(record));
+        }
+    }
+    if (index < end && index < reader.GetRecordCount()) {
+        spdlog::error("The trace ends after {} of {} records", index, reader.GetRecordCount());
+        return 1;
+    }
+    return 0;
+}
+
+// i8085 disassemble <program or save state> <listing> [graph file]
+// Disassembles the code reachable from the entry point and the interrupt vectors without running it, and writes the
+// listing along with the control-flow graph in Graphviz DOT when a file is given for it
+auto RunDisassemble(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 5) {
+        spdlog::error("Usage: {} disassemble <program or save state> <listing> [graph file]", argv[0]);
+        return 1;
+    }
+
+    intel_8085::Processor processor;
+    if (!LoadProgramOrSnapshot(processor, argv[2])) {
+        return 1;
+    }
+    const intel_8085::SystemMemory &memory      = processor.GetMemory();
+    const std::uint16_t             entry       = processor.GetState().registers.GetPc();
+    const auto                      entryPoints = intel_8085::ControlFlowGraph::DefaultEntryPoints(memory, entry);
+    const auto                      graph       = intel_8085::ControlFlowGraph::Build(memory, entryPoints);
+
+    std::ofstream listing(argv[3], std::ios::trunc);
+    graph.WriteListing(listing, memory);
+    if (!listing) {
+        spdlog::error("Could not write the listing to {}", argv[3]);
+        return 1;
+    }
+    if (argc > 4) {
+        std::ofstream dot(argv[4], std::ios::trunc);
+        graph.WriteGraph(dot, memory);
+        if (!dot) {
+            spdlog::error("Could not write the graph to {}", argv[4]);
+            return 1;
+        }
+    }
+    std::size_t codeBytes = 0;
+    for (std::uint32_t address = 0; address < 0x10000; address++) {
+        codeBytes += graph.GetByteKind(static_cast<std::uint16_t>(address)) != intel_8085::ByteKind::Data ? 1U : 0U;
+    }
+    spdlog::info("Found {} blocks in {} bytes of code from {} entry points", graph.GetBlocks().size(), codeBytes,
+        entryPoints.size());
+    return 0;
+}
+
+// i8085 diff <program or save state> <program or save state> [output] [hex, raw or ihex]
+// Compares the memory of two programs or save states, e.g. a final state against a golden one, printing the ranges
+// which differ. The bytes of the second which differ are written to the output when one is given. Like cmp, exits
+// with 0 if the memories are equal, 1 if they differ and 2 on trouble.
+auto RunDiff(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 6) {
+        spdlog::error("Usage: {} diff <program or save state> <program or save state> [output] [hex, raw or ihex]",
+            argv[0]);
+        return 2;
+    }
+    auto format = intel_8085::ExportFormat::Hex;
+    if (argc > 5 && std::string_view(argv[5]) == "raw") {
+        format = intel_8085::ExportFormat::Raw;
+    } else if (argc > 5 && std::string_view(argv[5]) == "ihex") {
+        format = intel_8085::ExportFormat::IntelHex;
+    } else if (argc > 5 && std::string_view(argv[5]) != "hex") {
+        spdlog::error("Unknown export format {}, expected hex, raw or ihex", argv[5]);
+        return 2;
+    }
+
+    intel_8085::Processor left;
+    intel_8085::Processor right;
+    if (!LoadProgramOrSnapshot(left, argv[2]) || !LoadProgramOrSnapshot(right, argv[3])) {
+        return 2;
+    }
+    std::vector<intel_8085::MemoryRange> ranges;
+    intel_8085::MemoryInspector::Diff(left.GetMemory(), right.GetMemory(), ranges);
+    std::size_t changed = 0;
+    for (const intel_8085::MemoryRange &range : ranges) {
+        const std::size_t length = range.endAddress - range.startAddress + 1U;
+        fmt::print("{:04X} - {:04X}  {} bytes\n", range.startAddress, range.endAddress, length);
+        changed += length;
+    }
+    spdlog::info("{} bytes differ in {} ranges", changed, ranges.size());
+
+    if (argc > 4) {
+        std::ofstream              output(argv[4], std::ios::binary | std::ios::trunc);
+        intel_8085::MemoryExporter exporter;
+        if (!exporter.Write(output, right.GetMemory(), ranges, format)) {
+            spdlog::error("Could not write the differences to {}", argv[4]);
+            return 2;
+        }
+    }
+    return ranges.empty() ? 0 : 1;
+}
+
+// i8085 snapshot <program or save state> <save state> [cycle budget] [dispatch mode]
+// Runs for up to the cycle budget and writes the final machine state, a save state given as input is continued from
+auto RunSnapshot(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 6) {
+        spdlog::error("Usage: {} snapshot <program or save state> <save state> [cycle budget] [dispatch mode]",
+            argv[0]);
+        return 1;
+    }
+    std::uint64_t            cycleBudget  = std::numeric_limits<std::uint64_t>::max();
+    intel_8085::DispatchMode dispatchMode = intel_8085::defaultDispatchMode;
+    if ((argc > 4 && !ParseNumberArgument(argv[4], cycleBudget))
+        || (argc > 5 && !ParseDispatchModeArgument(argv[5], dispatchMode))) {
+        return 1;
+    }
+
+    intel_8085::Processor processor;
+    processor.SetDispatchMode(dispatchMode);
+    if (!LoadProgramOrSnapshot(processor, argv[2])) {
+        return 1;
+    }
+    const std::uint64_t startCycles  = processor.GetState().cycles;
+    const std::uint64_t instructions = processor.Run(cycleBudget);
+    spdlog::info("Executed {} instructions ({} T-states), now at {} T-states", instructions,
+        processor.GetState().cycles - startCycles, processor.GetState().cycles);
+    return processor.SaveSnapshot(argv[3]) ? 0 : 1;
+}
+
+// i8085 console <program or save state> [UART input] [UART output] [dispatch mode]
+// Runs the program with a UART at ports 0x00 - 0x01, a timer at ports 0x10 - 0x12 raising RST 7.5 and a 40x25
+// character display mapped from 0xE000, then prints the display. The UART input and output are host files or named
+// pipes, - for none.
+auto RunConsole(const int argc, char **argv) -> int
+{
+    if (argc < 3 || argc > 6) {
+        spdlog::error("Usage: {} console <program or save state> [UART input] [UART output] [dispatch mode]", argv[0]);
+        return 1;
+    }
+    const auto pathArgument = [&](const int index) {
+        return argc > index && std::string_view(argv[index]) != "-" ? std::string(argv[index]) : std::string();
+    };
+    intel_8085::DispatchMode dispatchMode = intel_8085::defaultDispatchMode;
+    if (argc > 5 && !ParseDispatchModeArgument(argv[5], dispatchMode)) {
+        return 1;
+    }
+
+    intel_8085::UartDevice    uart;
+    intel_8085::TimerDevice   timer;
+    intel_8085::DisplayBuffer display;
+    intel_8085::DeviceBus     bus;
+    if (!uart.Open(pathArgument(3), pathArgument(4)) || !bus.MapPorts(uart, 0x00, 2) || !bus.MapPorts(timer, 0x10, 3)
+        || !bus.MapRegion(display, 0xE0, display.GetPageCount())) {
+        return 1;
+    }
+
+    intel_8085::Processor processor;
+    processor.SetDispatchMode(dispatchMode);
+    processor.AttachBus(&bus);
+    timer.Connect(processor.GetScheduler(), processor.GetInterruptController(), intel_8085::InterruptLine::Rst75);
+    if (!LoadProgramOrSnapshot(processor, argv[2])) {
+        return 1;
+    }
+    const std::uint64_t instructions = processor.Run();
+    spdlog::info("Executed {} instructions ({} T-states)", instructions, processor.GetCycles());
+    display.Render(std::cout);
+    return 0;
+}
+
+// i8085 batch <program or save state> <inputs> [threads] [dispatch mode] [cycle budget]
+// Runs the program once per data section in the inputs file, printing one line per job
+auto RunBatch(const int argc, char **argv) -> int
+{
+    if (argc < 4 || argc > 7) {
+        spdlog::error("Usage: {} batch <program or save state> <inputs> [threads] [dispatch mode] [cycle budget]",
+            argv[0]);
+        return 1;
+    }
+    std::uint64_t            threads      = 0;
+    intel_8085::DispatchMode dispatchMode = intel_8085::defaultDispatchMode;
+    std::uint64_t            cycleBudget  = std::numeric_limits<std::uint64_t>::max();
+    if ((argc > 4 && !ParseNumberArgument(argv[4], threads))
+        || (argc > 5 && !ParseDispatchModeArgument(argv[5], dispatchMode))
+        || (argc > 6 && !ParseNumberArgument(argv[6], cycleBudget))) {
+        return 1;
+    }
+
+    // Whatever the program comes as, every job starts from the state it loads into
+    intel_8085::Processor loader;
+    if (!LoadProgramOrSnapshot(loader, argv[2])) {
+        return 1;
+    }
+    const auto state  = std::make_shared<const intel_8085::ProcessorState>(loader.GetState());
+    const auto inputs = intel_8085::ProgramLoader::ParseDataSections(argv[3]);
+    if (!inputs.has_value()) {
+        return 1;
+    }
+
+    std::vector<intel_8085::BatchJob> jobs;
+    jobs.reserve(inputs->size());
+    for (const auto &input : inputs.value()) {
+        jobs.push_back({ nullptr, state, input, cycleBudget });
+    }
+
+    intel_8085::BatchRunner runner(threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads,
+        dispatchMode);
+    const auto                          start   = std::chrono::steady_clock::now();
+    const auto                          results = runner.Run(jobs);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    fmt::print("job,loaded,halted,a,b,c,d,e,h,l,flags,pc,sp,cycles,instructions,digest\n");
+    for (std::size_t job = 0; job < results.size(); job++) {
+        const auto &result = results[job];
+        const auto &r      = result.registers;
+        fmt::print("{},{:d},{:d},{:02x},{:02x},{:02x},{:02x},{:02x},{:02x},{:02x},{:02x},{:04x},{:04x},{},{},{:016x}\n",
+            job, result.loaded, result.halted, r[6], r[0], r[1], r[2], r[3], r[4], r[5], result.flags, result.pc,
+            result.sp, result.cycles, result.instructions, result.memoryDigest);
+    }
+    spdlog::info("Ran {} jobs on {} threads in {:.6f}s: {:.0f} jobs/s", results.size(), runner.GetThreadCount(),
+        elapsed.count(), static_cast<double>(results.size()) / elapsed.count());
+    return 0;
+}
+
+} // namespace
 
 auto main(int argc, char **argv) -> int
 {
+    if (argc >= 2 && std::string_view(argv[1]) == "batch") {
+        return RunBatch(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "assemble") {
+        return RunAssemble(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "compile") {
+        return RunCompile(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "profile") {
+        return RunProfile(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "snapshot") {
+        return RunSnapshot(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "console") {
+        return RunConsole(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "trace") {
+        return RunTrace(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "decode-trace") {
+        return RunDecodeTrace(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "disassemble") {
+        return RunDisassemble(argc, argv);
+    }
+    if (argc >= 2 && std::string_view(argv[1]) == "diff") {
+        return RunDiff(argc, argv);
+    }
+
+    // i8085 <program or save state> [dispatch mode] [clock frequency in Hz]
+    // A clock frequency paces the run in real time, e.g. 3072000 for a stock 8085 system
     intel_8085::Processor processor;
-    if (argc == 2) {
-        bool success = processor.LoadProgram(argv[1]);
+    if (argc >= 2 && argc <= 4) {
+        if (argc >= 3) {
+            intel_8085::DispatchMode dispatchMode = intel_8085::defaultDispatchMode;
+            if (!ParseDispatchModeArgument(argv[2], dispatchMode)) {
+                return 1;
+            }
+            processor.SetDispatchMode(dispatchMode);
+        }
+        if (argc == 4) {
+            std::uint64_t clockFrequency = 0;
+            if (!ParseNumberArgument(argv[3], clockFrequency) || clockFrequency == 0) {
+                spdlog::error("Expected a clock frequency in Hz and received {}", argv[3]);
+                return 1;
+            }
+            processor.SetPacing(intel_8085::Pacing::RealTime, static_cast<double>(clockFrequency));
+        }
+        bool success = LoadProgramOrSnapshot(processor, argv[1]);
         spdlog::info("Success parsing program {}: {}", argv[1], success);
+        if (success) {
+            const auto          start        = std::chrono::steady_clock::now();
+            const std::uint64_t instructions = processor.Run();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            spdlog::info("Executed {} instructions ({} T-states) in {:.6f}s: {:.2f} emulated MIPS", instructions,
+                processor.GetCycles(), elapsed.count(),
+                static_cast<double>(instructions) / elapsed.count() / 1e6);
+        }
         processor.DumpInfo(0x1000, 0x100F);
         processor.DumpInfo(0x8000, 0x800F);
     } else {
-        spdlog::error("Expected exactly 2 arguments and received {:d}", argc);
+        spdlog::error("Expected 2 to 4 arguments and received {:d}", argc);
     }
     return 0;
 }
@@ -0,0 +1,548 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "block_cache.hpp"
+#include "device_bus.hpp"
+#include "execution_unit.hpp"
+#include "instruction_set.hpp"
+#include "jit_compiler.hpp"
+#include "interrupt_controller.hpp"
+#include "memory_inspector.hpp"
+#include "processor.hpp"
+#include "processor_state.hpp"
+#include "status_register.hpp"
+#include "system_memory.hpp"
+
+// Regression checks, run by ctest. Each check logs what it found wrong and the run fails if any of them did.
+//
+// i8085_test
+
+namespace {
+
+[[nodiscard]] auto Expect(const bool condition, const std::string_view what) -> bool
+{
+    if (!condition) {
+        spdlog::error("Expected {}", what);
+    }
+    return condition;
+}
+
+// The block the BlockCache decodes from code placed at address 0x0000, without superinstructions
+[[nodiscard]] auto DecodeBlock(intel_8085::SystemMemory &memory, const std::span<const std::uint8_t> code)
+    -> intel_8085::DecodedBlock
+{
+    memory.WriteBlock(0x0000, code);
+    intel_8085::BlockCache::HandlerTable handlers {};
+    for (std::size_t opcode = 0; opcode < handlers.size(); opcode++) {
+        handlers[opcode] = intel_8085::ExecutionUnit::GetHandler(static_cast<std::uint8_t>(opcode));
+    }
+    intel_8085::BlockCache cache;
+    return cache.Lookup(memory, 0x0000, handlers, {});
+}
+
+#if INTERPRETER_8085_HAS_JIT
+// XCHG is in the opcode group of the ALU immediates, which the JIT used to turn down before getting to it
+[[nodiscard]] auto JitTranslatesXchg() -> bool
+{
+    constexpr std::array<std::uint8_t, 2> code = { 0xEB, 0x76 }; // XCHG; HLT
+    intel_8085::SystemMemory               memory;
+    intel_8085::JitCompiler                jit;
+    const intel_8085::NativeBlock          native = jit.Compile(DecodeBlock(memory, code));
+    if (!Expect(native != nullptr, "XCHG to be translated")) {
+        return false;
+    }
+    intel_8085::JitContext context;
+    context.registers = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x00 }; // B, C, D, E, H, L, A, flags
+    context.endCycle  = 0x100;
+    native(&context);
+    return Expect(context.executed == 1 && context.pc == 0x0001, "the native code to retire XCHG alone")
+        && Expect(context.registers[2] == 0x05 && context.registers[3] == 0x06 && context.registers[4] == 0x03
+                && context.registers[5] == 0x04,
+            "XCHG to swap DE and HL");
+}
+
+// Loads and stores in place and through SystemMemory, the store to the block's own code page leaving it early
+[[nodiscard]] auto JitTranslatesMemoryOperands() -> bool
+{
+    constexpr std::array<std::uint8_t, 24> code = {
+        0x21, 0x00, 0x10, // LXI H, 1000H
+        0x36, 0x42,       // MVI M, 42H
+        0x7E,             // MOV A, M
+        0x34,             // INR M
+        0x32, 0x00, 0x20, // STA 2000H
+        0x01, 0x00, 0x20, // LXI B, 2000H
+        0x0A,             // LDAX B
+        0x86,             // ADD M
+        0x77,             // MOV M, A
+        0x21, 0xFF, 0x00, // LXI H, 00FFH
+        0x36, 0x99,       // MVI M, 99H
+        0x3E, 0x11,       // MVI A, 11H
+        0x76,             // HLT
+    };
+    intel_8085::ProcessorState    state;
+    intel_8085::JitCompiler       jit;
+    const intel_8085::NativeBlock native = jit.Compile(DecodeBlock(state.memory, code));
+    if (!Expect(native != nullptr, "the memory operands to be translated")) {
+        return false;
+    }
+    intel_8085::JitContext context;
+    context.Load(state, 0x1000);
+    native(&context);
+    context.Store(state);
+    return Expect(context.executed == 11 && state.registers.GetPc() == 0x0015 && state.cycles == 101,
+               "the native code to stop right after the store to code")
+        && Expect(state.memory.HasDirtyCode() && state.memory.Read(0x00FF) == 0x99, "the store to code to dirty it")
+        && Expect(state.registers.GetAccumulator() == 0x85 && state.memory.Read(0x1000) == 0x85
+                && state.memory.Read(0x2000) == 0x42,
+            "the loads and stores to see each other");
+}
+#endif
+
+// Opcodes the random programs are made of. Control flow is laid out by the generator, the stack, I/O and interrupt
+// control are left out, as is everything writing C, the loop counter, or moving B, D or H far, which keeps memory
+// operands in the upper half of memory and clear of the code.
+[[nodiscard]] constexpr auto IsRandomizable(const std::uint8_t opcode) -> bool
+{
+    using intel_8085::opcodes;
+    if (!intel_8085::IsValidOpcode(opcode) || intel_8085::EndsBasicBlock(opcode)) {
+        return false;
+    }
+    const std::uint8_t high3      = intel_8085::DestinationField(opcode);
+    const std::uint8_t low3       = intel_8085::SourceField(opcode);
+    const std::uint8_t pair       = intel_8085::RegisterPairField(opcode);
+    const bool         keepsHigh3 = high3 != 0b000 && high3 != 0b001 && high3 != 0b010 && high3 != 0b100;
+    switch (intel_8085::OpcodeGroup(opcode)) {
+    case 0b01: // MOV
+        return keepsHigh3;
+    case 0b10: // ALU r
+        return true;
+    case 0b11: // ALU immediate
+        return low3 == 0b110 || opcode == static_cast<std::uint8_t>(opcodes::XCHG);
+    default:
+        break;
+    }
+    switch (low3) {
+    case 0b000:
+        return opcode == static_cast<std::uint8_t>(opcodes::NOP);
+    case 0b001: // LXI, not DAD
+        return (opcode & 0x08) == 0 && pair != 0b00;
+    case 0b010:
+        return opcode != static_cast<std::uint8_t>(opcodes::LHLD);
+    case 0b011: // INX, DCX
+        return pair != 0b00;
+    case 0b111:
+        return true;
+    default: // INR, DCR, MVI
+        return keepsHigh3;
+    }
+}
+
+// Loops of up to 8 random instructions and forward conditional jumps, each run by DCR C; JNZ, then HLT. Registers,
+// flags and the upper half of memory start out random.
+[[nodiscard]] auto MakeRandomProgram(const std::uint32_t seed) -> intel_8085::ProcessorState
+{
+    using intel_8085::opcodes;
+    constexpr std::uint16_t codeStart = 0x0100;
+    constexpr std::size_t   loops     = 16;
+
+    std::mt19937               generator(seed);
+    intel_8085::ProcessorState program;
+    intel_8085::SystemMemory  &memory = program.memory;
+    const auto                 random = [&generator] { return static_cast<std::uint8_t>(generator()); };
+    for (std::uint32_t address = 0x8000; address <= 0xFFFF; address++) {
+        memory.Write(static_cast<std::uint16_t>(address), random());
+    }
+
+    std::uint16_t address = codeStart;
+    const auto    emit    = [&memory, &address](const std::uint8_t value) {
+        memory.Write(address, value);
+        address++;
+    };
+    for (std::size_t loop = 0; loop < loops; loop++) {
+        const std::uint16_t start = address;
+        for (std::uint32_t count = generator() % 8 + 1; count > 0; count--) {
+            if (generator() % 4 == 0) {
+                // Jcc to the next instruction, both ways ending up in the same place
+                const auto next = static_cast<std::uint16_t>(address + 3);
+                emit(static_cast<std::uint8_t>(static_cast<std::uint8_t>(opcodes::JNZ) | (generator() % 8) << 3));
+                emit(static_cast<std::uint8_t>(next));
+                emit(static_cast<std::uint8_t>(next >> 8));
+                continue;
+            }
+            std::uint8_t opcode = random();
+            while (!IsRandomizable(opcode)) {
+                opcode = random();
+            }
+            emit(opcode);
+            if (intel_8085::instructionLength[opcode] == 2) {
+                emit(random());
+            } else if (intel_8085::instructionLength[opcode] == 3) {
+                emit(random());
+                emit(static_cast<std::uint8_t>(random() | 0x80));
+            }
+        }
+        emit(static_cast<std::uint8_t>(opcodes::DCR_C));
+        emit(static_cast<std::uint8_t>(opcodes::JNZ));
+        emit(static_cast<std::uint8_t>(start));
+        emit(static_cast<std::uint8_t>(start >> 8));
+    }
+    emit(static_cast<std::uint8_t>(opcodes::HLT));
+
+    for (std::uint8_t code = intel_8085::RegisterFile::b; code <= intel_8085::RegisterFile::l; code++) {
+        program.registers.Set(code, random());
+    }
+    for (const std::uint8_t code : { intel_8085::RegisterFile::b, intel_8085::RegisterFile::d,
+             intel_8085::RegisterFile::h }) {
+        program.registers.Set(code, static_cast<std::uint8_t>(program.registers.Get(code) | 0x80));
+    }
+    program.registers.SetAccumulator(random());
+    program.registers.SetPc(codeStart);
+    program.registers.SetSp(0x8000);
+    program.status.SetFlags(static_cast<std::uint8_t>(random() & intel_8085::StatusRegister::flagsMask));
+    return program;
+}
+
+// Runs in budgets of pseudo random length, the same for every run of a seed, until HLT or maxCycles. Returns the
+// number of instructions executed.
+auto RunSliced(intel_8085::ProcessorState &state, const intel_8085::DispatchMode mode,
+    const intel_8085::FlagEvaluation evaluation, const std::uint32_t seed) -> std::uint64_t
+{
+    constexpr std::uint64_t maxCycles = 4000000;
+    constexpr std::uint32_t maxSlice  = 5000;
+
+    const auto unit = std::make_unique<intel_8085::ExecutionUnit>();
+    unit->SetDispatchMode(mode);
+    state.status.SetFlagEvaluation(evaluation);
+    std::mt19937  slices(seed);
+    std::uint64_t executed = 0;
+    while (!state.halted && state.cycles < maxCycles) {
+        executed += unit->Run(state, slices() % maxSlice + 1);
+    }
+    return executed;
+}
+
+[[nodiscard]] auto IsSameState(const intel_8085::ProcessorState &left, const intel_8085::ProcessorState &right)
+    -> bool
+{
+    for (std::uint8_t code = intel_8085::RegisterFile::b; code <= intel_8085::RegisterFile::l; code++) {
+        if (left.registers.Get(code) != right.registers.Get(code)) {
+            return false;
+        }
+    }
+    return left.registers.GetAccumulator() == right.registers.GetAccumulator()
+        && left.registers.GetPc() == right.registers.GetPc() && left.registers.GetSp() == right.registers.GetSp()
+        && left.status.GetFlags() == right.status.GetFlags() && left.cycles == right.cycles
+        && left.halted == right.halted && intel_8085::MemoryInspector::IsEqual(left.memory, right.memory);
+}
+
+// Every dispatch mode with either flag evaluation ends random programs in the state the table dispatch with eager
+// flags does
+[[nodiscard]] auto DispatchModesAgree() -> bool
+{
+    using intel_8085::DispatchMode;
+    using intel_8085::FlagEvaluation;
+    constexpr std::array<DispatchMode, 5> modes = {
+        DispatchMode::Table,
+        DispatchMode::Switch,
+        DispatchMode::Threaded,
+        DispatchMode::Cached,
+        DispatchMode::Jit,
+    };
+    constexpr std::array<FlagEvaluation, 2> evaluations = { FlagEvaluation::Eager, FlagEvaluation::Lazy };
+    constexpr std::uint32_t                 programs    = 64;
+
+    bool agree = true;
+    for (std::uint32_t seed = 1; seed <= programs; seed++) {
+        const intel_8085::ProcessorState program          = MakeRandomProgram(seed);
+        intel_8085::ProcessorState       expected         = program;
+        const std::uint64_t              expectedExecuted = RunSliced(expected, modes[0], evaluations[0], seed);
+        for (const DispatchMode mode : modes) {
+            for (const FlagEvaluation evaluation : evaluations) {
+                intel_8085::ProcessorState state    = program;
+                const std::uint64_t        executed = RunSliced(state, mode, evaluation, seed);
+                if (executed != expectedExecuted || !IsSameState(state, expected)) {
+                    spdlog::error("Program {} ends differently with dispatch mode {} and {} flags", seed,
+                        static_cast<int>(mode), evaluation == FlagEvaluation::Eager ? "eager" : "lazy");
+                    agree = false;
+                }
+            }
+        }
+    }
+    return Expect(agree, "every dispatch mode and flag evaluation to agree");
+}
+
+// Stepping back from the end of a run in Table, Cached and Jit dispatch lands on the state the table dispatch steps
+// forward to at that cycle, going back past several checkpoints
+[[nodiscard]] auto StepBackMatchesSteppingForward() -> bool
+{
+    using intel_8085::DispatchMode;
+    constexpr std::array<DispatchMode, 3> modes     = { DispatchMode::Table, DispatchMode::Cached, DispatchMode::Jit };
+    constexpr std::uint32_t               programs  = 4;
+    constexpr std::uint64_t               runCycles = 20000;
+    constexpr std::size_t                 stepsBack = 400;
+
+    bool agree = true;
+    for (std::uint32_t seed = 1; seed <= programs; seed++) {
+        const intel_8085::ProcessorState        program = MakeRandomProgram(seed);
+        const auto                              forward = std::make_unique<intel_8085::Processor>(program);
+        std::vector<intel_8085::ProcessorState> steps   = { forward->GetState() };
+        forward->SetDispatchMode(DispatchMode::Table);
+        while (!forward->GetState().halted && forward->GetState().cycles < runCycles && forward->Step() != 0) {
+            steps.push_back(forward->GetState());
+        }
+
+        for (const DispatchMode mode : modes) {
+            const auto processor = std::make_unique<intel_8085::Processor>(program);
+            processor->SetDispatchMode(mode);
+            processor->EnableHistory(1000, 64);
+            processor->Run(runCycles);
+            const intel_8085::ProcessorState &state = processor->GetState();
+            auto                              step  = std::find_if(steps.begin(), steps.end(),
+                [&state](const intel_8085::ProcessorState &forwardState) {
+                    return forwardState.cycles == state.cycles;
+                });
+            for (std::size_t count = 0;; count++) {
+                if (step == steps.end() || !IsSameState(state, *step)) {
+                    spdlog::error("Program {} steps back to a different state at {} T-states with dispatch mode {}",
+                        seed, state.cycles, static_cast<int>(mode));
+                    agree = false;
+                    break;
+                }
+                if (count == stepsBack) {
+                    break;
+                }
+                if (step == steps.begin() || !processor->StepBack()) {
+                    spdlog::error("Program {} could not step back from {} T-states with dispatch mode {}", seed,
+                        state.cycles, static_cast<int>(mode));
+                    agree = false;
+                    break;
+                }
+                --step;
+            }
+        }
+    }
+    return Expect(agree, "stepping back to agree with stepping forward in every dispatch mode");
+}
+
+// A TRAP raised by a scheduled event wakes a processor halted with interrupts disabled
+[[nodiscard]] auto TrapWakesHaltWithInterruptsDisabled() -> bool
+{
+    constexpr std::array<std::uint8_t, 2> code = { 0xF3, 0x76 };       // DI; HLT
+    constexpr std::array<std::uint8_t, 3> trap = { 0x3E, 0x55, 0x76 }; // MVI A, 55H; HLT
+    intel_8085::ProcessorState            state;
+    state.memory.WriteBlock(0x0000, code);
+    state.memory.WriteBlock(0x0024, trap);
+    state.registers.SetSp(0x8000);
+
+    const auto processor = std::make_unique<intel_8085::Processor>(state);
+    processor->GetScheduler().Schedule(1000, [&processor](std::uint64_t) {
+        processor->GetInterruptController().Raise(intel_8085::InterruptLine::Trap);
+    });
+    processor->Run();
+    const intel_8085::ProcessorState &end = processor->GetState();
+    return Expect(end.registers.GetAccumulator() == 0x55 && end.registers.GetPc() == 0x0027,
+               "the TRAP service routine to run")
+        && Expect(end.cycles == 1000 + intel_8085::InterruptController::acceptCycles + 7 + 5,
+            "the TRAP to be accepted at the event's cycle")
+        && Expect(end.memory.Read(0x7FFE) == 0x02 && end.memory.Read(0x7FFF) == 0x00,
+            "the TRAP to return past the HLT");
+}
+
+// An interrupt pending at EI is accepted after the instruction following it, not before
+[[nodiscard]] auto InterruptWaitsOneInstructionAfterEi() -> bool
+{
+    constexpr std::array<std::uint8_t, 7> code = {
+        0x3E, 0x08, // MVI A, 08H
+        0x30,       // SIM, unmasking RST 7.5
+        0xFB,       // EI
+        0x06, 0x01, // MVI B, 01H
+        0x76,       // HLT
+    };
+    constexpr std::array<std::uint8_t, 2> rst75 = { 0x48, 0x76 }; // MOV C, B; HLT
+    intel_8085::ProcessorState            state;
+    state.memory.WriteBlock(0x0000, code);
+    state.memory.WriteBlock(0x003C, rst75);
+    state.registers.SetSp(0x8000);
+
+    const auto processor = std::make_unique<intel_8085::Processor>(state);
+    processor->GetInterruptController().Raise(intel_8085::InterruptLine::Rst75);
+    processor->Run();
+    const intel_8085::ProcessorState &end = processor->GetState();
+    return Expect(end.registers.Get(intel_8085::RegisterFile::c) == 0x01, "MVI B to run ahead of RST 7.5")
+        && Expect(end.memory.Read(0x7FFE) == 0x06 && end.registers.GetPc() == 0x003E,
+            "RST 7.5 to return to the HLT after MVI B");
+}
+
+// Saves the state of processor, loads it into a new processor and runs both to the end, which they should reach in
+// the same state
+[[nodiscard]] auto ResumesFromSnapshot(intel_8085::Processor &processor) -> bool
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "i8085_test.snapshot").string();
+    const auto        resumed  = std::make_unique<intel_8085::Processor>();
+    const bool        loaded   = processor.SaveSnapshot(filename) && resumed->LoadSnapshot(filename);
+    std::filesystem::remove(filename);
+    if (!Expect(loaded, "the snapshot to be saved and loaded")) {
+        return false;
+    }
+    processor.Run();
+    resumed->Run();
+    return IsSameState(resumed->GetState(), processor.GetState())
+        && resumed->GetState().interruptMask == processor.GetState().interruptMask
+        && resumed->GetState().interruptsEnabled == processor.GetState().interruptsEnabled
+        && resumed->GetState().interruptRequests == processor.GetState().interruptRequests;
+}
+
+// A run resumed from a snapshot, of a random program midway or of one saved right after EI with an interrupt
+// pending, ends where the run it was saved from does
+[[nodiscard]] auto SnapshotRoundTrips() -> bool
+{
+    constexpr std::uint32_t programs = 4;
+
+    bool agree = true;
+    for (std::uint32_t seed = 1; seed <= programs; seed++) {
+        const auto processor = std::make_unique<intel_8085::Processor>(MakeRandomProgram(seed));
+        processor->Run(5000);
+        if (!ResumesFromSnapshot(*processor)) {
+            spdlog::error("Program {} ends differently resumed from a snapshot", seed);
+            agree = false;
+        }
+    }
+
+    constexpr std::array<std::uint8_t, 7> code = {
+        0x3E, 0x08, // MVI A, 08H
+        0x30,       // SIM, unmasking RST 7.5
+        0xFB,       // EI
+        0x06, 0x01, // MVI B, 01H
+        0x76,       // HLT
+    };
+    constexpr std::array<std::uint8_t, 2> rst75 = { 0x48, 0x76 }; // MOV C, B; HLT
+    intel_8085::ProcessorState            state;
+    state.memory.WriteBlock(0x0000, code);
+    state.memory.WriteBlock(0x003C, rst75);
+    state.registers.SetSp(0x8000);
+
+    const auto processor = std::make_unique<intel_8085::Processor>(state);
+    processor->GetInterruptController().Raise(intel_8085::InterruptLine::Rst75);
+    for (int step = 0; step < 3; step++) {
+        processor->Step();
+    }
+    if (!Expect(processor->GetState().interruptsDeferred && processor->GetState().interruptRequests != 0,
+            "RST 7.5 to be pending and deferred right after EI")) {
+        return false;
+    }
+    const bool resumed = ResumesFromSnapshot(*processor);
+    return Expect(agree, "runs resumed from snapshots to end like the runs they were saved from")
+        && Expect(resumed && processor->GetState().registers.Get(intel_8085::RegisterFile::c) == 0x01,
+            "a run resumed right after EI to accept RST 7.5 after MVI B");
+}
+
+// Raises RST 7.5 on the given write to its page
+class RaisingDevice final : public intel_8085::Device {
+public: // Functions/Methods
+    RaisingDevice(intel_8085::InterruptController &interrupts, const std::uint32_t raiseAt) noexcept
+        : interrupts_(interrupts), raiseAt_(raiseAt)
+    {
+    }
+
+    auto Write(std::uint16_t /*offset*/, std::uint8_t /*value*/) noexcept -> void override
+    {
+        if (++writes_ == raiseAt_) {
+            interrupts_.Raise(intel_8085::InterruptLine::Rst75);
+        }
+    }
+
+private: // Data Members
+    intel_8085::InterruptController &interrupts_;
+    std::uint32_t                    raiseAt_;
+    std::uint32_t                    writes_ = 0;
+};
+
+// An interrupt raised by a store to a memory mapped device is accepted right after the store in every dispatch mode,
+// by then the loop storing is hot enough to be translated
+[[nodiscard]] auto DeviceWriteStopsEveryDispatchMode() -> bool
+{
+    using intel_8085::DispatchMode;
+    constexpr std::array<std::uint8_t, 19> code = {
+        0x31, 0x00, 0x80, // LXI SP, 8000H
+        0x3E, 0x08,       // MVI A, 08H
+        0x30,             // SIM, unmasking RST 7.5
+        0xFB,             // EI
+        0x06, 0x40,       // MVI B, 40H
+        0x32, 0x00, 0x40, // loop: STA 4000H
+        0x0C,             // INR C
+        0x05,             // DCR B
+        0xC2, 0x09, 0x00, // JNZ loop
+        0x76,             // HLT
+    };
+    constexpr std::array<std::uint8_t, 2> rst75 = { 0x79, 0x76 }; // MOV A, C; HLT
+    intel_8085::ProcessorState            state;
+    state.memory.WriteBlock(0x0000, code);
+    state.memory.WriteBlock(0x003C, rst75);
+
+    constexpr std::array<DispatchMode, 5> modes = {
+        DispatchMode::Table,
+        DispatchMode::Switch,
+        DispatchMode::Threaded,
+        DispatchMode::Cached,
+        DispatchMode::Jit,
+    };
+    bool agree = true;
+    for (const DispatchMode mode : modes) {
+        const auto          processor = std::make_unique<intel_8085::Processor>(state);
+        RaisingDevice       device(processor->GetInterruptController(), 48);
+        intel_8085::DeviceBus bus;
+        if (!bus.MapRegion(device, 0x40, 1)) {
+            return false;
+        }
+        processor->AttachBus(&bus);
+        processor->SetDispatchMode(mode);
+        processor->Run();
+        const intel_8085::ProcessorState &end = processor->GetState();
+        // 32 T-states up to the loop, 47 iterations of 31, the 48th STA, accepting, MOV and HLT
+        if (end.registers.GetAccumulator() != 47 || end.memory.Read(0x7FFE) != 0x0C
+            || end.cycles != 32 + 47 * 31 + 13 + intel_8085::InterruptController::acceptCycles + 4 + 5) {
+            spdlog::error("Dispatch mode {} accepted RST 7.5 after {} stores at {:#06x}, {} T-states",
+                static_cast<int>(mode), end.registers.GetAccumulator(), end.memory.Read(0x7FFE), end.cycles);
+            agree = false;
+        }
+        processor->AttachBus(nullptr);
+    }
+    return Expect(agree, "every dispatch mode to accept the interrupt right after the store raising it");
+}
+
+} // namespace
+
+auto main() -> int
+{
+    const std::vector<std::pair<std::string_view, bool (*)()>> checks = {
+#if INTERPRETER_8085_HAS_JIT
+        { "jit_translates_xchg", JitTranslatesXchg },
+        { "jit_translates_memory_operands", JitTranslatesMemoryOperands },
+#endif
+        { "dispatch_modes_agree", DispatchModesAgree },
+        { "step_back_matches_stepping_forward", StepBackMatchesSteppingForward },
+        { "trap_wakes_halt_with_interrupts_disabled", TrapWakesHaltWithInterruptsDisabled },
+        { "interrupt_waits_one_instruction_after_ei", InterruptWaitsOneInstructionAfterEi },
+        { "snapshot_round_trips", SnapshotRoundTrips },
+        { "device_write_stops_every_dispatch_mode", DeviceWriteStopsEveryDispatchMode },
+    };
+
+    int failed = 0;
+    for (const auto &[name, check] : checks) {
+        const bool passed = check();
+        spdlog::info("{} {}", passed ? "Passed" : "Failed", name);
+        failed += passed ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}